@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "AllocationTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	/** Allocations of the current thread. Trivial, so it never has to be constructed by the allocating thread. */
+	thread_local AllocationCounters threadCounters;
+}
+
+AllocationCounters AllocationCounters::operator-(const AllocationCounters& rhs) const
+{
+	return { allocations - rhs.allocations, bytes - rhs.bytes };
+}
+
+AllocationCounters& AllocationCounters::operator+=(const AllocationCounters& rhs)
+{
+	allocations += rhs.allocations;
+	bytes += rhs.bytes;
+	return *this;
+}
+
+AllocationCounters AllocationTracker::counters()
+{
+	return threadCounters;
+}
+
+void AllocationTracker::recordAllocation(std::size_t bytes)
+{
+	++threadCounters.allocations;
+	threadCounters.bytes += bytes;
+}
+
+void AllocationTracker::setStrict(bool isStrict)
+{
+	sIsStrict = isStrict;
+}
+
+bool AllocationTracker::isStrict()
+{
+	return sIsStrict;
+}
+
+std::uint64_t AllocationTracker::violations()
+{
+	return sViolations;
+}
+
+NoAllocationsScope::NoAllocationsScope() :
+	mAllocationsAtStart(AllocationTracker::counters().allocations)
+{
+}
+
+NoAllocationsScope::~NoAllocationsScope()
+{
+	if (AllocationTracker::counters().allocations == mAllocationsAtStart)
+	{
+		return;
+	}
+
+	++AllocationTracker::sViolations;
+	assert(!AllocationTracker::isStrict() && "Memory was allocated where no allocations were expected");
+}
+
+#ifdef FLAPANN_ALLOCATION_TRACKING
+
+// Replacements of the global allocation functions. Every other form of the operator new
+// and the operator delete falls back to one of these, so they are enough to count everything.
+
+namespace
+{
+	void* allocate(std::size_t bytes)
+	{
+		AllocationTracker::recordAllocation(bytes);
+		return std::malloc(bytes == 0 ? 1 : bytes);
+	}
+
+	void* allocateAligned(std::size_t bytes, std::align_val_t alignment)
+	{
+		AllocationTracker::recordAllocation(bytes);
+		const auto alignmentInBytes = static_cast<std::size_t>(alignment);
+		const auto alignedBytes = (bytes + alignmentInBytes - 1) / alignmentInBytes * alignmentInBytes;
+#ifdef _WIN32
+		return _aligned_malloc(alignedBytes == 0 ? alignmentInBytes : alignedBytes, alignmentInBytes);
+#else
+		return std::aligned_alloc(alignmentInBytes, alignedBytes == 0 ? alignmentInBytes : alignedBytes);
+#endif
+	}
+
+	void deallocateAligned(void* memory)
+	{
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+void* operator new(std::size_t bytes)
+{
+	if (auto* memory = allocate(bytes))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept
+{
+	return allocate(bytes);
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment)
+{
+	if (auto* memory = allocateAligned(bytes, alignment))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(bytes, alignment);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	deallocateAligned(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	deallocateAligned(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+	deallocateAligned(memory);
+}
+
+#endif
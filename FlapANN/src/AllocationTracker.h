@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(FLAPANN_ALLOCATION_TRACKING) && !defined(FLAPANN_PROFILING)
+	#error "Allocations are counted per profiled phase, so FLAPANN_ALLOCATION_TRACKING requires FLAPANN_PROFILING"
+#endif
+
+/**
+ * \brief Number of the heap allocations and of the allocated bytes
+ */
+struct AllocationCounters
+{
+	std::uint64_t allocations = 0;
+	std::uint64_t bytes = 0;
+
+	AllocationCounters operator-(const AllocationCounters& rhs) const;
+	AllocationCounters& operator+=(const AllocationCounters& rhs);
+};
+
+/**
+ * \brief Counts every heap allocation made by the game.
+ *
+ * When the game is built with FLAPANN_ALLOCATION_TRACKING defined (premake5 --track-allocations),
+ * the global operator new is replaced with the one that counts the allocations of the calling
+ * thread. The profiled phases then report how many allocations they make, and the simulation
+ * tick checks that it does not allocate at all. Otherwise nothing is counted and all
+ * the counters stay at zero.
+ */
+class AllocationTracker
+{
+public:
+	/**
+	 * \brief Checks if the game was built with the allocation tracking enabled
+	 * \return True if the allocations are counted, false otherwise
+	 */
+	static constexpr bool isEnabled();
+
+	/**
+	 * \brief Returns the allocations made so far by the calling thread
+	 * \return Number of allocations and bytes since the thread started
+	 */
+	static AllocationCounters counters();
+
+	/**
+	 * \brief Counts the allocation made by the calling thread. Called only by the operator new.
+	 * \param bytes Size of the allocated memory
+	 */
+	static void recordAllocation(std::size_t bytes);
+
+	/**
+	 * \brief Turns the strict mode on or off
+	 * \param isStrict True if the scopes expecting no allocations should assert, false if they should only count them
+	 */
+	static void setStrict(bool isStrict);
+
+	/**
+	 * \brief Checks if the scopes expecting no allocations assert
+	 * \return True if the strict mode is on
+	 */
+	static bool isStrict();
+
+	/**
+	 * \brief Returns the number of scopes that allocated despite expecting no allocations
+	 * \return Number of the violating scopes
+	 */
+	static std::uint64_t violations();
+
+private:
+	friend class NoAllocationsScope;
+
+	/** Set if the scopes expecting no allocations should assert */
+	static inline bool sIsStrict = false;
+
+	/** Number of scopes that allocated despite expecting no allocations */
+	static inline std::uint64_t sViolations = 0;
+};
+
+/**
+ * \brief Checks that no memory is allocated by the calling thread from its creation to its destruction
+ */
+class NoAllocationsScope
+{
+public:
+	NoAllocationsScope();
+
+	/**
+	 * \brief Counts the violation if anything was allocated, and asserts in the strict mode
+	 */
+	~NoAllocationsScope();
+
+	NoAllocationsScope(const NoAllocationsScope&) = delete;
+	NoAllocationsScope& operator=(const NoAllocationsScope&) = delete;
+
+private:
+	/** Number of allocations made by the thread before the scope was entered */
+	std::uint64_t mAllocationsAtStart;
+};
+
+#ifdef FLAPANN_ALLOCATION_TRACKING
+	/** Checks that the rest of the enclosing scope allocates no memory */
+	#define EXPECT_NO_ALLOCATIONS() const NoAllocationsScope noAllocationsScope
+#else
+	#define EXPECT_NO_ALLOCATIONS() ((void)0)
+#endif
+
+
+// ---------- Inline ------------ //
+
+constexpr bool AllocationTracker::isEnabled()
+{
+#ifdef FLAPANN_ALLOCATION_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,402 @@
+#include "pch.h"
+#include "ChampionExporter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <imgui/imgui.h>
+
+#include "NetworkTiming.h"
+
+namespace
+{
+	/** Sums at which the stepwise sigmoids of FANN change their slope, followed by their values there */
+	constexpr const char* SIGMOID_STEPWISE_CONSTANTS =
+		"\t\t\tconstexpr float sums[6] = { static_cast<float>(-2.64665246009826660156e+00), static_cast<float>(-1.47221946716308593750e+00),\n"
+		"\t\t\t                            static_cast<float>(-5.49306154251098632812e-01), static_cast<float>(5.49306154251098632812e-01),\n"
+		"\t\t\t                            static_cast<float>(1.47221934795379638672e+00), static_cast<float>(2.64665293693542480469e+00) };\n"
+		"\t\t\tconstexpr float values[6] = { static_cast<float>(4.99999988824129104614e-03), static_cast<float>(5.00000007450580596924e-02),\n"
+		"\t\t\t                              static_cast<float>(2.50000000000000000000e-01), static_cast<float>(7.50000000000000000000e-01),\n"
+		"\t\t\t                              static_cast<float>(9.49999988079071044922e-01), static_cast<float>(9.95000004768371582031e-01) };\n";
+	constexpr const char* SIGMOID_SYMMETRIC_STEPWISE_CONSTANTS =
+		"\t\t\tconstexpr float sums[6] = { static_cast<float>(-2.64665293693542480469e+00), static_cast<float>(-1.47221934795379638672e+00),\n"
+		"\t\t\t                            static_cast<float>(-5.49306154251098632812e-01), static_cast<float>(5.49306154251098632812e-01),\n"
+		"\t\t\t                            static_cast<float>(1.47221934795379638672e+00), static_cast<float>(2.64665293693542480469e+00) };\n"
+		"\t\t\tconstexpr float values[6] = { static_cast<float>(-9.90000009536743164062e-01), static_cast<float>(-8.99999976158142089844e-01),\n"
+		"\t\t\t                              static_cast<float>(-5.00000000000000000000e-01), static_cast<float>(5.00000000000000000000e-01),\n"
+		"\t\t\t                              static_cast<float>(8.99999976158142089844e-01), static_cast<float>(9.90000009536743164062e-01) };\n";
+
+	/**
+	 * \brief Generated function computing a single activation function of FANN
+	 */
+	struct Activation
+	{
+		const char* name;
+		std::string body;
+	};
+
+	/**
+	 * \brief Writes the activation function the same way as fann_activation_switch does
+	 * \param function Activation function of FANN
+	 * \return Name and body of the generated function
+	 */
+	Activation activationOf(fann_activationfunc_enum function)
+	{
+		switch (function)
+		{
+		case FANN_LINEAR:
+			return { "linear", "\t\t\treturn sum;\n" };
+		case FANN_LINEAR_PIECE:
+			return { "linearPiece", "\t\t\treturn sum < 0 ? 0.0f : sum > 1 ? 1.0f : sum;\n" };
+		case FANN_LINEAR_PIECE_SYMMETRIC:
+			return { "linearPieceSymmetric", "\t\t\treturn sum < -1 ? -1.0f : sum > 1 ? 1.0f : sum;\n" };
+		case FANN_SIGMOID:
+			return { "sigmoid", "\t\t\treturn 1.0f / (1.0f + std::exp(-2.0f * sum));\n" };
+		case FANN_SIGMOID_SYMMETRIC:
+			return { "sigmoidSymmetric", "\t\t\treturn 2.0f / (1.0f + std::exp(-2.0f * sum)) - 1.0f;\n" };
+		case FANN_SIGMOID_STEPWISE:
+			return { "sigmoidStepwise", std::string(SIGMOID_STEPWISE_CONSTANTS) + "\t\t\treturn stepwise(sums, values, 0.0f, 1.0f, sum);\n" };
+		case FANN_SIGMOID_SYMMETRIC_STEPWISE:
+			return { "sigmoidSymmetricStepwise", std::string(SIGMOID_SYMMETRIC_STEPWISE_CONSTANTS) + "\t\t\treturn stepwise(sums, values, -1.0f, 1.0f, sum);\n" };
+		case FANN_THRESHOLD:
+			return { "threshold", "\t\t\treturn sum < 0 ? 0.0f : 1.0f;\n" };
+		case FANN_THRESHOLD_SYMMETRIC:
+			return { "thresholdSymmetric", "\t\t\treturn sum < 0 ? -1.0f : 1.0f;\n" };
+		case FANN_GAUSSIAN:
+			return { "gaussian", "\t\t\treturn std::exp(-sum * sum);\n" };
+		case FANN_GAUSSIAN_SYMMETRIC:
+			return { "gaussianSymmetric", "\t\t\treturn std::exp(-sum * sum) * 2.0f - 1.0f;\n" };
+		case FANN_ELLIOT:
+			return { "elliot", "\t\t\treturn (sum / 2.0f) / (1.0f + (sum > 0 ? sum : -sum)) + 0.5f;\n" };
+		case FANN_ELLIOT_SYMMETRIC:
+			return { "elliotSymmetric", "\t\t\treturn sum / (1.0f + (sum > 0 ? sum : -sum));\n" };
+		case FANN_SIN_SYMMETRIC:
+			return { "sinSymmetric", "\t\t\treturn std::sin(sum);\n" };
+		case FANN_COS_SYMMETRIC:
+			return { "cosSymmetric", "\t\t\treturn std::cos(sum);\n" };
+		case FANN_SIN:
+			return { "sine", "\t\t\treturn std::sin(sum) / 2.0f + 0.5f;\n" };
+		case FANN_COS:
+			return { "cosine", "\t\t\treturn std::cos(sum) / 2.0f + 0.5f;\n" };
+		default:
+			// FANN computes nothing for the stepwise gaussian
+			return { "gaussianStepwise", "\t\t\treturn 0.0f;\n" };
+		}
+	}
+
+	/**
+	 * \brief Writes the float so it is read back exactly
+	 */
+	std::string literalOf(fann_type value)
+	{
+		char literal[32];
+		std::snprintf(literal, sizeof(literal), "%.9ef", static_cast<double>(value));
+		return literal;
+	}
+
+	/**
+	 * \brief Checks if the network is a fully connected layered one, where every layer ends with its bias
+	 * neuron and every other neuron is connected to all the neurons of the previous layer in their order
+	 */
+	bool isExportable(const fann* ann)
+	{
+		if (ann->network_type != FANN_NETTYPE_LAYER || ann->connection_rate < 1)
+		{
+			return false;
+		}
+
+		for (auto* layer = ann->first_layer + 1; layer != ann->last_layer; ++layer)
+		{
+			const auto* previousLayer = layer - 1;
+			const auto numberOfConnections = static_cast<unsigned>(previousLayer->last_neuron - previousLayer->first_neuron);
+			for (auto* neuron = layer->first_neuron; neuron != layer->last_neuron; ++neuron)
+			{
+				const auto isBias = neuron == layer->last_neuron - 1;
+				if (isBias != (neuron->first_con == neuron->last_con))
+				{
+					return false;
+				}
+				if (isBias)
+				{
+					continue;
+				}
+				if (neuron->last_con - neuron->first_con != numberOfConnections || !std::isfinite(neuron->activation_steepness))
+				{
+					return false;
+				}
+				for (auto connection = 0u; connection < numberOfConnections; ++connection)
+				{
+					if (ann->connections[neuron->first_con + connection] != previousLayer->first_neuron + connection ||
+					    !std::isfinite(ann->weights[neuron->first_con + connection]))
+					{
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
+
+std::optional<std::string> ChampionExporter::generateHeader(const fann* ann, const std::string& name)
+{
+	if (!isExportable(ann))
+	{
+		return std::nullopt;
+	}
+
+	const auto numberOfLayers = static_cast<int>(ann->last_layer - ann->first_layer);
+	const auto sizeOf = [ann](int layer) { return static_cast<int>(ann->first_layer[layer].last_neuron - ann->first_layer[layer].first_neuron); };
+
+	std::ostringstream description;
+	for (auto layer = 0; layer < numberOfLayers; ++layer)
+	{
+		description << (layer == 0 ? "" : "-") << sizeOf(layer) - 1;
+	}
+
+	std::ostringstream source;
+	source << "// Generated by FlapANN from the champion network " << description.str() << ", do not edit.\n"
+	       << "//\n"
+	       << "// Runs the network exactly like fann_run of FANN with float weights, summing the connections in the\n"
+	       << "// same order, so the outputs match bit for bit when compiled without contracting the multiplications\n"
+	       << "// and additions into fused ones (the default of MSVC, -ffp-contract=off for GCC and Clang). The\n"
+	       << "// exponential and trigonometric activation functions match as long as the same math library is used.\n"
+	       << "#pragma once\n\n"
+	       << "#include <cmath>\n\n"
+	       << "namespace " << name << "\n{\n"
+	       << "\tconstexpr int kInputs = " << ann->num_input << ";\n"
+	       << "\tconstexpr int kOutputs = " << ann->num_output << ";\n\n"
+	       << "\tnamespace detail\n\t{\n";
+
+	// The same unrolling as in fann_run: the remainder of the connections from the last one of them
+	// back, then the rest in groups of four
+	source << "\t\ttemplate <int Connections>\n"
+	       << "\t\tinline float sumOf(const float* weights, const float* values) noexcept\n\t\t{\n"
+	       << "\t\t\tconstexpr int remainder = Connections & 3;\n"
+	       << "\t\t\tfloat sum = 0.0f;\n"
+	       << "\t\t\tif constexpr (remainder == 3)\n\t\t\t{\n\t\t\t\tsum += weights[2] * values[2];\n\t\t\t}\n"
+	       << "\t\t\tif constexpr (remainder >= 2)\n\t\t\t{\n\t\t\t\tsum += weights[1] * values[1];\n\t\t\t}\n"
+	       << "\t\t\tif constexpr (remainder >= 1)\n\t\t\t{\n\t\t\t\tsum += weights[0] * values[0];\n\t\t\t}\n"
+	       << "\t\t\tfor (int i = remainder; i != Connections; i += 4)\n\t\t\t{\n"
+	       << "\t\t\t\tsum += weights[i] * values[i] + weights[i + 1] * values[i + 1] + weights[i + 2] * values[i + 2] + weights[i + 3] * values[i + 3];\n"
+	       << "\t\t\t}\n\t\t\treturn sum;\n\t\t}\n\n";
+
+	source << "\t\tinline float limited(float sum, float steepness) noexcept\n\t\t{\n"
+	       << "\t\t\tsum = steepness * sum;\n"
+	       << "\t\t\tconst float maximum = 150 / steepness;\n"
+	       << "\t\t\treturn sum > maximum ? maximum : sum < -maximum ? -maximum : sum;\n\t\t}\n\n";
+
+	source << "\t\tinline float stepwise(const float (&sums)[6], const float (&values)[6], float minimum, float maximum, float sum) noexcept\n\t\t{\n"
+	       << "\t\t\tconst auto linear = [sum](float sum1, float value1, float sum2, float value2) { return ((value2 - value1) * (sum - sum1)) / (sum2 - sum1) + value1; };\n"
+	       << "\t\t\tif (sum < sums[4])\n\t\t\t{\n"
+	       << "\t\t\t\tif (sum < sums[2])\n\t\t\t\t{\n"
+	       << "\t\t\t\t\tif (sum < sums[1])\n\t\t\t\t\t{\n"
+	       << "\t\t\t\t\t\treturn sum < sums[0] ? minimum : linear(sums[0], values[0], sums[1], values[1]);\n\t\t\t\t\t}\n"
+	       << "\t\t\t\t\treturn linear(sums[1], values[1], sums[2], values[2]);\n\t\t\t\t}\n"
+	       << "\t\t\t\treturn sum < sums[3] ? linear(sums[2], values[2], sums[3], values[3]) : linear(sums[3], values[3], sums[4], values[4]);\n\t\t\t}\n"
+	       << "\t\t\treturn sum < sums[5] ? linear(sums[4], values[4], sums[5], values[5]) : maximum;\n\t\t}\n";
+
+	// Only the activation functions the network uses are written
+	std::vector<fann_activationfunc_enum> activationFunctions;
+	for (auto* neuron = ann->first_layer[1].first_neuron; neuron != (ann->last_layer - 1)->last_neuron; ++neuron)
+	{
+		if (neuron->first_con != neuron->last_con &&
+		    std::find(activationFunctions.cbegin(), activationFunctions.cend(), neuron->activation_function) == activationFunctions.cend())
+		{
+			activationFunctions.push_back(neuron->activation_function);
+		}
+	}
+	for (const auto function : activationFunctions)
+	{
+		const auto activation = activationOf(function);
+		source << "\n\t\tinline float " << activation.name << "(float sum) noexcept\n\t\t{\n" << activation.body << "\t\t}\n";
+	}
+
+	for (auto layer = 1; layer < numberOfLayers; ++layer)
+	{
+		source << "\n\t\tconstexpr float kWeights" << layer << "[" << sizeOf(layer) - 1 << "][" << sizeOf(layer - 1) << "] = {\n";
+		for (auto* neuron = ann->first_layer[layer].first_neuron; neuron != ann->first_layer[layer].last_neuron - 1; ++neuron)
+		{
+			source << "\t\t\t{ ";
+			for (auto connection = neuron->first_con; connection != neuron->last_con; ++connection)
+			{
+				source << (connection == neuron->first_con ? "" : ", ") << literalOf(ann->weights[connection]);
+			}
+			source << " },\n";
+		}
+		source << "\t\t};\n";
+	}
+	source << "\t}\n\n";
+
+	// Every neuron is unrolled with its steepness and activation function, the values of a layer
+	// ending with the one of its bias neuron
+	source << "\t/**\n\t * \\brief Runs the network\n"
+	       << "\t * \\param input Values of the " << ann->num_input << " input neurons\n"
+	       << "\t * \\param output Receives the values of the " << ann->num_output << " output neurons\n\t */\n"
+	       << "\tinline void run(const float* input, float* output) noexcept\n\t{\n"
+	       << "\t\tconst float layer0[" << sizeOf(0) << "] = { ";
+	for (auto input = 0u; input < ann->num_input; ++input)
+	{
+		source << "input[" << input << "], ";
+	}
+	source << "1.0f };\n";
+	for (auto layer = 1; layer < numberOfLayers; ++layer)
+	{
+		const auto isOutput = layer == numberOfLayers - 1;
+		if (!isOutput)
+		{
+			source << "\t\tfloat layer" << layer << "[" << sizeOf(layer) << "];\n";
+		}
+		for (auto neuron = 0; neuron < sizeOf(layer) - 1; ++neuron)
+		{
+			const auto& computedNeuron = ann->first_layer[layer].first_neuron[neuron];
+			source << "\t\t" << (isOutput ? "output[" : "layer" + std::to_string(layer) + "[") << neuron << "] = detail::"
+			       << activationOf(computedNeuron.activation_function).name << "(detail::limited(detail::sumOf<" << sizeOf(layer - 1)
+			       << ">(detail::kWeights" << layer << "[" << neuron << "], layer" << layer - 1 << "), "
+			       << literalOf(computedNeuron.activation_steepness) << "));\n";
+		}
+		if (!isOutput)
+		{
+			source << "\t\tlayer" << layer << "[" << sizeOf(layer) - 1 << "] = 1.0f;\n";
+		}
+	}
+	source << "\t}\n}\n";
+	return source.str();
+}
+
+bool ChampionExporter::exportChampion(GeneticAlgorithm::Unit champion)
+{
+	mReport = Report{ false, {}, champion.ann->total_connections, 0, 0.f };
+	const auto header = generateHeader(champion.ann, mSettings.name);
+	if (!header)
+	{
+		mReport->error = "The champion is not a fully connected layered network with finite weights";
+		return false;
+	}
+	for (auto* layer = champion.ann->first_layer + 1; layer != champion.ann->last_layer; ++layer)
+	{
+		mReport->computedNeurons += static_cast<std::size_t>(layer->last_neuron - layer->first_neuron) - 1;
+	}
+
+	// The reference outputs come from fann_run itself, so the check compares against FANN and not against this exporter
+	const auto numberOfInputs = champion.ann->num_input;
+	const auto numberOfOutputs = champion.ann->num_output;
+	std::mt19937 generator(mSettings.seed);
+	std::uniform_real_distribution<fann_type> inputDistribution(-2.f, 2.f);
+	std::vector<fann_type> inputs(static_cast<std::size_t>(mSettings.referenceStates) * numberOfInputs);
+	std::generate(inputs.begin(), inputs.end(), [&] { return inputDistribution(generator); });
+	std::vector<fann_type> outputs;
+	for (auto state = 0; state < mSettings.referenceStates; ++state)
+	{
+		const auto* output = fann_run(champion.ann, inputs.data() + state * numberOfInputs);
+		outputs.insert(outputs.end(), output, output + numberOfOutputs);
+	}
+
+	mReport->fannNanoseconds = nanosecondsPerRun(inputs, numberOfInputs, mSettings.timedPasses, [&champion](const fann_type* input)
+	{
+		return fann_run(champion.ann, const_cast<fann_type*>(input))[0];
+	});
+
+	std::ostringstream check;
+	check << "// Generated by FlapANN next to " << std::filesystem::path(mSettings.headerPath).filename().string() << ", do not edit.\n"
+	      << "//\n"
+	      << "// Checks that the generated network matches fann_run bit for bit on the states FlapANN ran through it\n"
+	      << "// when exporting, and measures the latency of the generated code. Build it with optimizations, e.g.\n"
+	      << "// c++ -std=c++17 -O2 -ffp-contract=off " << std::filesystem::path(mSettings.checkPath).filename().string() << "\n"
+	      << "#include \"" << std::filesystem::path(mSettings.headerPath).filename().string() << "\"\n\n"
+	      << "#include <chrono>\n#include <cstdint>\n#include <cstdio>\n#include <cstring>\n\n"
+	      << "namespace\n{\n"
+	      << "\tconstexpr int kStates = " << mSettings.referenceStates << ";\n"
+	      << "\tconstexpr int kTimedPasses = " << mSettings.timedPasses << ";\n\n"
+	      << "\t/** Nanoseconds of a single fann_run of the network, measured by FlapANN when exporting */\n"
+	      << "\tconstexpr double kFannNanoseconds = " << mReport->fannNanoseconds << ";\n\n"
+	      << "\tconstexpr float kInputs[kStates][" << mSettings.name << "::kInputs] = {\n";
+	for (auto state = 0; state < mSettings.referenceStates; ++state)
+	{
+		check << "\t\t{ ";
+		for (auto input = 0u; input < numberOfInputs; ++input)
+		{
+			check << (input == 0 ? "" : ", ") << literalOf(inputs[state * numberOfInputs + input]);
+		}
+		check << " },\n";
+	}
+	check << "\t};\n\n"
+	      << "\t/** Bits of the outputs of fann_run */\n"
+	      << "\tconstexpr std::uint32_t kOutputs[kStates][" << mSettings.name << "::kOutputs] = {\n";
+	for (auto state = 0; state < mSettings.referenceStates; ++state)
+	{
+		check << "\t\t{ ";
+		for (auto output = 0u; output < numberOfOutputs; ++output)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &outputs[state * numberOfOutputs + output], sizeof(bits));
+			char literal[16];
+			std::snprintf(literal, sizeof(literal), "0x%08xu", bits);
+			check << (output == 0 ? "" : ", ") << literal;
+		}
+		check << " },\n";
+	}
+	check << "\t};\n}\n\n"
+	      << "int main()\n{\n"
+	      << "\tint mismatches = 0;\n"
+	      << "\tfor (int state = 0; state < kStates; ++state)\n\t{\n"
+	      << "\t\tfloat output[" << mSettings.name << "::kOutputs];\n"
+	      << "\t\t" << mSettings.name << "::run(kInputs[state], output);\n"
+	      << "\t\tfor (int neuron = 0; neuron < " << mSettings.name << "::kOutputs; ++neuron)\n\t\t{\n"
+	      << "\t\t\tstd::uint32_t bits;\n"
+	      << "\t\t\tstd::memcpy(&bits, &output[neuron], sizeof(bits));\n"
+	      << "\t\t\tif (bits != kOutputs[state][neuron] && mismatches++ == 0)\n\t\t\t{\n"
+	      << "\t\t\t\tstd::printf(\"First mismatch in state %d, output %d: 0x%08x instead of 0x%08x\\n\", state, neuron,\n"
+	      << "\t\t\t\t            static_cast<unsigned>(bits), static_cast<unsigned>(kOutputs[state][neuron]));\n"
+	      << "\t\t\t}\n\t\t}\n\t}\n"
+	      << "\tstd::printf(\"Outputs matching fann_run bit for bit: %d of %d\\n\", kStates * " << mSettings.name << "::kOutputs - mismatches, kStates * "
+	      << mSettings.name << "::kOutputs);\n\n"
+	      << "\tfloat sink = 0.0f;\n"
+	      << "\tconst auto start = std::chrono::steady_clock::now();\n"
+	      << "\tfor (int pass = 0; pass < kTimedPasses; ++pass)\n\t{\n"
+	      << "\t\tfor (int state = 0; state < kStates; ++state)\n\t\t{\n"
+	      << "\t\t\tfloat output[" << mSettings.name << "::kOutputs];\n"
+	      << "\t\t\t" << mSettings.name << "::run(kInputs[state], output);\n"
+	      << "\t\t\tsink += output[0];\n"
+	      << "\t\t}\n\t}\n"
+	      << "\tconst std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;\n"
+	      << "\tvolatile float usedSink = sink;\n"
+	      << "\tstatic_cast<void>(usedSink);\n"
+	      << "\tconst double nanoseconds = time.count() / (static_cast<double>(kStates) * kTimedPasses);\n"
+	      << "\tstd::printf(\"Generated: %.1f ns, fann_run: %.1f ns, speedup: %.2fx\\n\", nanoseconds, kFannNanoseconds,\n"
+	      << "\t            nanoseconds > 0 ? kFannNanoseconds / nanoseconds : 0.0);\n"
+	      << "\treturn mismatches == 0 ? 0 : 1;\n}\n";
+
+	std::ofstream headerFile(mSettings.headerPath, std::ios::trunc);
+	headerFile << *header;
+	std::ofstream checkFile(mSettings.checkPath, std::ios::trunc);
+	checkFile << check.str();
+	if (!headerFile || !checkFile)
+	{
+		mReport->error = "Could not write " + mSettings.headerPath + " or " + mSettings.checkPath;
+		return false;
+	}
+	mReport->isExported = true;
+	return true;
+}
+
+void ChampionExporter::updateImGui() const
+{
+	if (!mReport)
+	{
+		return;
+	}
+
+	if (!mReport->isExported)
+	{
+		ImGui::Text("Export failed: %s", mReport->error.c_str());
+		return;
+	}
+	ImGui::Text("Exported to %s: %zu connections, %zu computed neurons", mSettings.headerPath.c_str(), mReport->connections, mReport->computedNeurons);
+	ImGui::Text("fann_run: %.1f ns. Build %s to check the bits and time the generated code.", mReport->fannNanoseconds, mSettings.checkPath.c_str());
+}
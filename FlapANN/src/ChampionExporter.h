@@ -0,0 +1,84 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "GeneticAlgorithm.h"
+
+/**
+ * \brief Exports the champion network as a standalone C++ header, so the trained controller
+ * can be embedded elsewhere without FANN.
+ *
+ * The generated header holds the weights as constexpr arrays and a single function running
+ * the network without any allocation, every neuron unrolled with its steepness and activation
+ * function inlined. The sums are accumulated in the same order as in fann_run, so the outputs
+ * match it bit for bit. A small program is generated next to the header, which checks that
+ * on the states run through fann_run during the export and measures the latency of the
+ * generated code against the one of fann_run.
+ */
+class ChampionExporter
+{
+public:
+	/**
+	 * \brief Options of the export
+	 */
+	struct Settings
+	{
+		/** Namespace of the generated code. Has to be a valid C++ identifier. */
+		std::string name = "champion";
+
+		/** Path of the generated header */
+		std::string headerPath = "champion_network.h";
+
+		/** Path of the generated program checking the header */
+		std::string checkPath = "champion_network_check.cpp";
+
+		/** Number of the random states run through fann_run as the reference of the check */
+		int referenceStates = 256;
+
+		/** Number of times every reference state is run when fann_run is timed */
+		int timedPasses = 200;
+
+		/** Seed of the random reference states */
+		std::uint32_t seed = 2024;
+	};
+
+	/**
+	 * \brief Outcome of the last export
+	 */
+	struct Report
+	{
+		bool isExported;
+		std::string error;
+		std::size_t connections;
+		std::size_t computedNeurons;
+		float fannNanoseconds;
+	};
+
+	/**
+	 * \brief Generates the header running the network
+	 * \param ann Fully connected layered network to export
+	 * \param name Namespace of the generated code
+	 * \return Source of the header, or nothing if the network has another structure or non-finite parameters
+	 */
+	static std::optional<std::string> generateHeader(const fann* ann, const std::string& name);
+
+	/**
+	 * \brief Writes the header of the champion and the program checking it
+	 * \param champion Unit whose network is exported
+	 * \return True if both files were written
+	 */
+	bool exportChampion(GeneticAlgorithm::Unit champion);
+
+	/**
+	 * \brief Shows the report of the last export
+	 */
+	void updateImGui() const;
+
+private:
+	/** Options of the export */
+	Settings mSettings;
+
+	/** Outcome of the last export */
+	std::optional<Report> mReport;
+};
@@ -0,0 +1,194 @@
+#include "pch.h"
+#include "ChampionPruner.h"
+
+#include <chrono>
+#include <cmath>
+
+#include <imgui/imgui.h>
+
+#include "NetworkTiming.h"
+
+namespace
+{
+	/** Shares of the weights that are tried to be pruned, in steps of this size */
+	constexpr float PRUNED_SHARE_STEP = 0.05f;
+
+	/** Largest difference between the outputs of fann_run and of the sparse network keeping every connection */
+	constexpr float UNPRUNED_TOLERANCE = 1e-6f;
+
+	/**
+	 * \brief Plays every validation course on its own thread
+	 * \param numberOfCourses Number of the courses
+	 * \param courseSettings Settings of the first course. The following ones get the next seeds.
+	 * \param play Plays the course with the given settings and returns the fitness
+	 * \return Mean fitness over the courses
+	 */
+	template <typename Play>
+	float playCourses(int numberOfCourses, const PipeCourse::Settings& courseSettings, Play&& play)
+	{
+		std::vector<std::future<float>> courses;
+		for (auto course = 0; course < numberOfCourses; ++course)
+		{
+			auto seededCourseSettings = courseSettings;
+			seededCourseSettings.seed += static_cast<std::uint32_t>(course);
+			courses.push_back(std::async(std::launch::async, play, course, seededCourseSettings));
+		}
+
+		auto fitness = 0.f;
+		for (auto& course : courses)
+		{
+			fitness += course.get() / static_cast<float>(numberOfCourses);
+		}
+		return fitness;
+	}
+}
+
+void ChampionPruner::start(const GeneticAlgorithm::Unit& champion, const HeadlessGeometry& geometry, const PipeCourse::Settings& courseSettings)
+{
+	if (isRunning())
+	{
+		return;
+	}
+
+	mRunningPruning = std::async(std::launch::async, [champion, evaluator = FitnessEvaluator(geometry), courseSettings, settings = mSettings]()
+	{
+		return run(champion, evaluator, courseSettings, settings);
+	});
+}
+
+bool ChampionPruner::isRunning() const
+{
+	return mRunningPruning.valid();
+}
+
+void ChampionPruner::updateImGui()
+{
+	if (isRunning() && mRunningPruning.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		mReport = mRunningPruning.get();
+	}
+
+	if (isRunning())
+	{
+		ImGui::TextUnformatted("Pruning the champion...");
+	}
+	else
+	{
+		ImGui::SliderInt("Validation courses", &mSettings.validationCourses, 1, 16);
+		ImGui::SliderFloat("Required agreement", &mSettings.requiredAgreement, 0.9f, 1.f, "%.3f");
+	}
+
+	if (mReport)
+	{
+		ImGui::Text("Pruned: %.0f%% of the connections, weights below %.4f", mReport->prunedShare * 100.f, mReport->threshold);
+		ImGui::Text("Connections: %zu of %zu, computed neurons: %zu",
+		            mReport->keptConnections, mReport->denseConnections, mReport->computedNeurons);
+		ImGui::Text("Decision agreement: %.2f%% of %zu states", mReport->decisionAgreement * 100.f, mReport->validationStates);
+		ImGui::Text("Unpruned sparse network %s fann_run, largest difference: %.2e",
+		            mReport->unprunedDifference <= UNPRUNED_TOLERANCE ? "matches" : "differs from", mReport->unprunedDifference);
+		ImGui::Text("Dense: %.1f ns, sparse: %.1f ns, speedup: %.2fx", mReport->denseNanoseconds, mReport->sparseNanoseconds,
+		            mReport->sparseNanoseconds > 0.f ? mReport->denseNanoseconds / mReport->sparseNanoseconds : 0.f);
+		ImGui::Text("Fitness dense: %.2f, sparse: %.2f", mReport->denseFitness, mReport->sparseFitness);
+	}
+}
+
+ChampionPruner::Report ChampionPruner::run(const GeneticAlgorithm::Unit& champion, const FitnessEvaluator& evaluator,
+                                           const PipeCourse::Settings& courseSettings, const Settings& settings)
+{
+	assert(fann_get_num_input(champion.ann) == FitnessEvaluator::NUMBER_OF_INPUTS && fann_get_num_output(champion.ann) == 1);
+
+	// Every state the dense champion sees on its own runs is recorded. Running the network
+	// writes into it, so every thread flies its own copy.
+	std::vector<std::vector<fann_type>> courseStates(settings.validationCourses);
+	Report report{};
+	report.denseFitness = playCourses(settings.validationCourses, courseSettings,
+	                                  [&](int course, const PipeCourse::Settings& seededCourseSettings)
+	{
+		auto unit = champion;
+		auto& states = courseStates[course];
+		const auto fitness = evaluator.play(1, PipeCourse(seededCourseSettings), settings.evaluation, [&](std::size_t, const fann_type* input)
+		{
+			states.insert(states.end(), input, input + FitnessEvaluator::NUMBER_OF_INPUTS);
+			return fann_run(unit.ann, const_cast<fann_type*>(input))[0] > 0.5f;
+		});
+		return fitness.front();
+	});
+
+	std::vector<fann_type> states;
+	for (const auto& course : courseStates)
+	{
+		states.insert(states.end(), course.cbegin(), course.cend());
+	}
+	const auto numberOfStates = states.size() / FitnessEvaluator::NUMBER_OF_INPUTS;
+	report.validationStates = numberOfStates;
+
+	// Keeping every connection, the sparse kernel has to give the outputs of fann_run
+	auto dense = champion;
+	SparseNetwork unpruned(dense.ann, 0);
+	std::vector<bool> denseDecisions(numberOfStates);
+	report.unprunedDifference = 0.f;
+	for (std::size_t state = 0; state < numberOfStates; ++state)
+	{
+		auto* input = states.data() + state * FitnessEvaluator::NUMBER_OF_INPUTS;
+		const auto output = fann_run(dense.ann, input)[0];
+		denseDecisions[state] = output > 0.5f;
+		report.unprunedDifference = std::max(report.unprunedDifference, std::abs(output - unpruned.run(input)[0]));
+	}
+
+	// The largest share of the smallest weights after which the decisions stay the same wins
+	std::vector<fann_type> magnitudes(dense.ann->weights, dense.ann->weights + dense.ann->total_connections);
+	for (auto& magnitude : magnitudes)
+	{
+		magnitude = std::abs(magnitude);
+	}
+	std::sort(magnitudes.begin(), magnitudes.end());
+	const auto numberOfSteps = static_cast<int>(std::round(1.f / PRUNED_SHARE_STEP));
+	std::optional<SparseNetwork> pruned;
+	for (auto step = 0; step < numberOfSteps; ++step)
+	{
+		const auto prunedWeights = static_cast<std::size_t>(step * PRUNED_SHARE_STEP * magnitudes.size());
+		const auto threshold = prunedWeights == 0 ? fann_type(0) : magnitudes[prunedWeights];
+		SparseNetwork sparse(dense.ann, threshold);
+
+		std::size_t agreeingDecisions = 0;
+		for (std::size_t state = 0; state < numberOfStates; ++state)
+		{
+			const auto flaps = sparse.run(states.data() + state * FitnessEvaluator::NUMBER_OF_INPUTS)[0] > 0.5f;
+			agreeingDecisions += flaps == denseDecisions[state] ? 1 : 0;
+		}
+		const auto agreement = numberOfStates == 0 ? 1.f : static_cast<float>(agreeingDecisions) / numberOfStates;
+		if (!pruned || agreement >= settings.requiredAgreement)
+		{
+			report.prunedShare = 1.f - static_cast<float>(sparse.numberOfConnections()) / sparse.numberOfDenseConnections();
+			report.threshold = threshold;
+			report.decisionAgreement = agreement;
+			pruned = std::move(sparse);
+		}
+	}
+
+	auto& sparse = *pruned;
+	report.keptConnections = sparse.numberOfConnections();
+	report.denseConnections = sparse.numberOfDenseConnections();
+	report.computedNeurons = sparse.numberOfComputedNeurons();
+	report.denseNanoseconds = nanosecondsPerRun(states, FitnessEvaluator::NUMBER_OF_INPUTS, settings.timedPasses, [&dense](const fann_type* input)
+	{
+		return fann_run(dense.ann, const_cast<fann_type*>(input))[0];
+	});
+	report.sparseNanoseconds = nanosecondsPerRun(states, FitnessEvaluator::NUMBER_OF_INPUTS, settings.timedPasses, [&sparse](const fann_type* input)
+	{
+		return sparse.run(input)[0];
+	});
+
+	// The sparse champion flies the same courses, which shows if the few changed decisions matter
+	report.sparseFitness = playCourses(settings.validationCourses, courseSettings,
+	                                   [&](int, const PipeCourse::Settings& seededCourseSettings)
+	{
+		auto network = sparse;
+		const auto fitness = evaluator.play(1, PipeCourse(seededCourseSettings), settings.evaluation, [&network](std::size_t, const fann_type* input)
+		{
+			return network.run(input)[0] > 0.5f;
+		});
+		return fitness.front();
+	});
+	return report;
+}
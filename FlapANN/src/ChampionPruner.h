@@ -0,0 +1,101 @@
+#pragma once
+
+#include <future>
+#include <optional>
+
+#include "FitnessEvaluator.h"
+#include "GeneticAlgorithm.h"
+#include "SparseNetwork.h"
+
+/**
+ * \brief Prunes the near-zero weights of the champion network and measures how much cheaper it runs.
+ *
+ * The champion flies a few seeded courses in the headless game and every state it sees is recorded
+ * as the validation set. The smallest weights are then dropped, a growing share at a time, and
+ * the largest share after which the sparse network still makes the same decisions on the recorded
+ * states is kept. Both networks are timed on the same states, and the sparse one flies the courses
+ * once more to confirm it scores what the dense one did. Before any pruning, the sparse network
+ * keeping every connection is compared with fann_run on the recorded states, which checks that
+ * the sparse kernel computes what FANN does. Everything runs on a background thread.
+ */
+class ChampionPruner
+{
+public:
+	/**
+	 * \brief Options of the pruning and of its validation
+	 */
+	struct Settings
+	{
+		/** Number of courses on which the validation states are recorded */
+		int validationCourses = 4;
+
+		/** Smallest share of the validation states on which the decision has to stay unchanged */
+		float requiredAgreement = 1.f;
+
+		/** Number of times every validation state is run when the networks are timed */
+		int timedPasses = 20;
+
+		/** Options of the runs on the validation courses */
+		FitnessEvaluator::Settings evaluation{ 1, FitnessEvaluator::Aggregation::Mean, 0.25f, 60 * 60 };
+	};
+
+	/**
+	 * \brief Outcome of the last pruning
+	 */
+	struct Report
+	{
+		float prunedShare;
+		fann_type threshold;
+		std::size_t keptConnections;
+		std::size_t denseConnections;
+		std::size_t computedNeurons;
+		std::size_t validationStates;
+		float decisionAgreement;
+		float unprunedDifference;
+		float denseNanoseconds;
+		float sparseNanoseconds;
+		float denseFitness;
+		float sparseFitness;
+	};
+
+	/**
+	 * \brief Starts pruning the champion on a background thread, unless a pruning is running already
+	 * \param champion Unit whose network is pruned
+	 * \param geometry Sizes and forces of the game
+	 * \param courseSettings Settings of the first validation course. The following ones get the next seeds.
+	 */
+	void start(const GeneticAlgorithm::Unit& champion, const HeadlessGeometry& geometry, const PipeCourse::Settings& courseSettings);
+
+	/**
+	 * \brief Checks if the champion is still being pruned
+	 * \return True if the pruning was started and its result was not taken yet
+	 */
+	bool isRunning() const;
+
+	/**
+	 * \brief Takes the result of the finished pruning and updates its report
+	 */
+	void updateImGui();
+
+private:
+	/**
+	 * \brief Prunes the champion, on the calling thread
+	 * \param champion Unit whose network is pruned
+	 * \param evaluator Evaluator playing the courses
+	 * \param courseSettings Settings of the first validation course
+	 * \param settings Options of the pruning and of its validation
+	 * \return Report of the pruning
+	 */
+	static Report run(const GeneticAlgorithm::Unit& champion, const FitnessEvaluator& evaluator,
+	                  const PipeCourse::Settings& courseSettings, const Settings& settings);
+
+private:
+	/** Options of the pruning and of its validation */
+	Settings mSettings;
+
+	/** Pruning running in the background. Not valid if nothing is running. */
+	std::future<Report> mRunningPruning;
+
+	/** Outcome of the last pruning */
+	std::optional<Report> mReport;
+};
@@ -0,0 +1,267 @@
+#include "pch.h"
+#include "CmaEsOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+CmaEsOptimizer::CmaEsOptimizer(Genome initialMean, float initialStepSize) :
+	mDimension(initialMean.size()),
+	mMean(initialMean.cbegin(), initialMean.cend()),
+	mStepSize(initialStepSize),
+	mCovariance(mDimension * mDimension, 0.),
+	mEigenvectors(mDimension * mDimension, 0.),
+	mScales(mDimension, 1.),
+	mCovariancePath(mDimension, 0.),
+	mStepSizePath(mDimension, 0.),
+	mGeneration(0),
+	mRandomGenerator(std::random_device{}())
+{
+	for (std::size_t i = 0; i < mDimension; ++i)
+	{
+		at(mCovariance, i, i) = 1.;
+		at(mEigenvectors, i, i) = 1.;
+	}
+}
+
+std::vector<Optimizer::Genome> CmaEsOptimizer::ask(std::size_t numberOfCandidates)
+{
+	std::vector<Genome> candidates(numberOfCandidates, Genome(mDimension));
+	std::normal_distribution<double> normal;
+	std::vector<double> scaled(mDimension);
+	for (auto& genome : candidates)
+	{
+		for (std::size_t i = 0; i < mDimension; ++i)
+		{
+			scaled[i] = normal(mRandomGenerator) * mScales[i];
+		}
+
+		// x = m + sigma * B * D * z
+		for (std::size_t i = 0; i < mDimension; ++i)
+		{
+			auto offset = 0.;
+			for (std::size_t j = 0; j < mDimension; ++j)
+			{
+				offset += at(mEigenvectors, i, j) * scaled[j];
+			}
+			genome[i] = static_cast<fann_type>(mMean[i] + mStepSize * offset);
+		}
+	}
+	return candidates;
+}
+
+void CmaEsOptimizer::tell(const std::vector<Genome>& candidates, const std::vector<float>& fitness)
+{
+	assert(candidates.size() == fitness.size());
+	const auto numberOfCandidates = candidates.size();
+	if (numberOfCandidates < 2)
+	{
+		return;
+	}
+
+	std::vector<std::size_t> ranking(numberOfCandidates);
+	std::iota(ranking.begin(), ranking.end(), 0);
+	std::sort(ranking.begin(), ranking.end(), [&fitness](std::size_t a, std::size_t b) { return fitness[a] > fitness[b]; });
+
+	// Parameters of the strategy follow from the number of the candidates, which can change between generations
+	const auto n = static_cast<double>(mDimension);
+	const auto parents = numberOfCandidates / 2;
+	std::vector<double> weights(parents);
+	for (std::size_t i = 0; i < parents; ++i)
+	{
+		weights[i] = std::log(parents + 0.5) - std::log(i + 1.);
+	}
+	const auto sumOfWeights = std::accumulate(weights.cbegin(), weights.cend(), 0.);
+	auto sumOfSquaredWeights = 0.;
+	for (auto& weight : weights)
+	{
+		weight /= sumOfWeights;
+		sumOfSquaredWeights += weight * weight;
+	}
+	const auto effectiveParents = 1. / sumOfSquaredWeights;
+	const auto covariancePathRate = (4. + effectiveParents / n) / (n + 4. + 2. * effectiveParents / n);
+	const auto stepSizePathRate = (effectiveParents + 2.) / (n + effectiveParents + 5.);
+	const auto rankOneRate = 2. / ((n + 1.3) * (n + 1.3) + effectiveParents);
+	const auto rankParentsRate = std::min(1. - rankOneRate,
+	                                      2. * (effectiveParents - 2. + 1. / effectiveParents) / ((n + 2.) * (n + 2.) + effectiveParents));
+	const auto damping = 1. + 2. * std::max(0., std::sqrt((effectiveParents - 1.) / (n + 1.)) - 1.) + stepSizePathRate;
+	const auto expectedNormalLength = std::sqrt(n) * (1. - 1. / (4. * n) + 1. / (21. * n * n));
+
+	const auto oldMean = mMean;
+	std::fill(mMean.begin(), mMean.end(), 0.);
+	for (std::size_t i = 0; i < parents; ++i)
+	{
+		const auto& genome = candidates[ranking[i]];
+		assert(genome.size() == mDimension);
+		for (std::size_t gene = 0; gene < mDimension; ++gene)
+		{
+			mMean[gene] += weights[i] * genome[gene];
+		}
+	}
+
+	// Candidates that were not drawn by this strategy, like the very first population,
+	// only place the mean. Learning the shape from them would throw the step size far off.
+	if (mGeneration++ == 0)
+	{
+		return;
+	}
+
+	std::vector<double> meanShift(mDimension);
+	for (std::size_t gene = 0; gene < mDimension; ++gene)
+	{
+		meanShift[gene] = (mMean[gene] - oldMean[gene]) / mStepSize;
+	}
+
+	// C^(-1/2) * shift = B * D^(-1) * B^T * shift
+	std::vector<double> rotatedShift(mDimension, 0.);
+	for (std::size_t j = 0; j < mDimension; ++j)
+	{
+		for (std::size_t i = 0; i < mDimension; ++i)
+		{
+			rotatedShift[j] += at(mEigenvectors, i, j) * meanShift[i];
+		}
+		rotatedShift[j] /= mScales[j];
+	}
+	const auto stepSizePathFactor = std::sqrt(stepSizePathRate * (2. - stepSizePathRate) * effectiveParents);
+	auto stepSizePathLength = 0.;
+	for (std::size_t i = 0; i < mDimension; ++i)
+	{
+		auto whitenedShift = 0.;
+		for (std::size_t j = 0; j < mDimension; ++j)
+		{
+			whitenedShift += at(mEigenvectors, i, j) * rotatedShift[j];
+		}
+		mStepSizePath[i] = (1. - stepSizePathRate) * mStepSizePath[i] + stepSizePathFactor * whitenedShift;
+		stepSizePathLength += mStepSizePath[i] * mStepSizePath[i];
+	}
+	stepSizePathLength = std::sqrt(stepSizePathLength);
+
+	// The covariance path stalls while the step size path is too long, so the covariance does not grow too fast
+	const auto pathNormalization = std::sqrt(1. - std::pow(1. - stepSizePathRate, 2. * mGeneration));
+	const auto isPathShort = stepSizePathLength / pathNormalization / expectedNormalLength < 1.4 + 2. / (n + 1.);
+	const auto covariancePathFactor = isPathShort ? std::sqrt(covariancePathRate * (2. - covariancePathRate) * effectiveParents) : 0.;
+	for (std::size_t i = 0; i < mDimension; ++i)
+	{
+		mCovariancePath[i] = (1. - covariancePathRate) * mCovariancePath[i] + covariancePathFactor * meanShift[i];
+	}
+
+	std::vector<std::vector<double>> parentSteps(parents, std::vector<double>(mDimension));
+	for (std::size_t i = 0; i < parents; ++i)
+	{
+		const auto& genome = candidates[ranking[i]];
+		for (std::size_t gene = 0; gene < mDimension; ++gene)
+		{
+			parentSteps[i][gene] = (genome[gene] - oldMean[gene]) / mStepSize;
+		}
+	}
+
+	// Rank-one and rank-parents update, every row of the matrix on its own
+	const auto stalledPathCorrection = isPathShort ? 0. : covariancePathRate * (2. - covariancePathRate);
+	const auto keptCovariance = 1. - rankOneRate - rankParentsRate;
+	for (std::size_t row = 0; row < mDimension; ++row)
+	{
+		for (std::size_t column = 0; column < mDimension; ++column)
+		{
+			auto rankParents = 0.;
+			for (std::size_t i = 0; i < parents; ++i)
+			{
+				rankParents += weights[i] * parentSteps[i][row] * parentSteps[i][column];
+			}
+			auto& covariance = at(mCovariance, row, column);
+			covariance = keptCovariance * covariance
+			           + rankOneRate * (mCovariancePath[row] * mCovariancePath[column] + stalledPathCorrection * covariance)
+			           + rankParentsRate * rankParents;
+		}
+	}
+
+	mStepSize *= std::exp(stepSizePathRate / damping * (stepSizePathLength / expectedNormalLength - 1.));
+	mStepSize = std::clamp(mStepSize, 1e-8, 1e4);
+	decomposeCovariance();
+}
+
+const char* CmaEsOptimizer::name() const
+{
+	return "CMA-ES";
+}
+
+void CmaEsOptimizer::decomposeCovariance()
+{
+	// Cyclic Jacobi rotations. The matrix is small and symmetric, so they converge in a few sweeps.
+	auto matrix = mCovariance;
+	auto& vectors = mEigenvectors;
+	std::fill(vectors.begin(), vectors.end(), 0.);
+	for (std::size_t i = 0; i < mDimension; ++i)
+	{
+		at(vectors, i, i) = 1.;
+	}
+
+	constexpr auto maximumSweeps = 50;
+	for (auto sweep = 0; sweep < maximumSweeps; ++sweep)
+	{
+		auto offDiagonal = 0.;
+		for (std::size_t p = 0; p < mDimension; ++p)
+		{
+			for (std::size_t q = p + 1; q < mDimension; ++q)
+			{
+				offDiagonal += at(matrix, p, q) * at(matrix, p, q);
+			}
+		}
+		if (offDiagonal < 1e-22)
+		{
+			break;
+		}
+
+		for (std::size_t p = 0; p < mDimension; ++p)
+		{
+			for (std::size_t q = p + 1; q < mDimension; ++q)
+			{
+				const auto apq = at(matrix, p, q);
+				if (std::abs(apq) < 1e-30)
+				{
+					continue;
+				}
+
+				const auto theta = (at(matrix, q, q) - at(matrix, p, p)) / (2. * apq);
+				const auto t = (theta >= 0. ? 1. : -1.) / (std::abs(theta) + std::sqrt(theta * theta + 1.));
+				const auto c = 1. / std::sqrt(t * t + 1.);
+				const auto s = t * c;
+				for (std::size_t k = 0; k < mDimension; ++k)
+				{
+					const auto akp = at(matrix, k, p);
+					const auto akq = at(matrix, k, q);
+					at(matrix, k, p) = c * akp - s * akq;
+					at(matrix, k, q) = s * akp + c * akq;
+				}
+				for (std::size_t k = 0; k < mDimension; ++k)
+				{
+					const auto apk = at(matrix, p, k);
+					const auto aqk = at(matrix, q, k);
+					at(matrix, p, k) = c * apk - s * aqk;
+					at(matrix, q, k) = s * apk + c * aqk;
+				}
+				for (std::size_t k = 0; k < mDimension; ++k)
+				{
+					const auto vkp = at(vectors, k, p);
+					const auto vkq = at(vectors, k, q);
+					at(vectors, k, p) = c * vkp - s * vkq;
+					at(vectors, k, q) = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	for (std::size_t i = 0; i < mDimension; ++i)
+	{
+		mScales[i] = std::sqrt(std::max(at(matrix, i, i), 1e-20));
+	}
+}
+
+double& CmaEsOptimizer::at(std::vector<double>& matrix, std::size_t row, std::size_t column) const
+{
+	return matrix[row * mDimension + column];
+}
+
+double CmaEsOptimizer::at(const std::vector<double>& matrix, std::size_t row, std::size_t column) const
+{
+	return matrix[row * mDimension + column];
+}
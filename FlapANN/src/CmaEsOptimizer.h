@@ -0,0 +1,77 @@
+#pragma once
+
+#include <random>
+
+#include "Optimizer.h"
+
+/**
+ * \brief Covariance matrix adaptation evolution strategy (CMA-ES).
+ *
+ * Candidates are drawn from the multivariate normal distribution around the mean genome.
+ * After every generation the mean moves towards the best candidates, and the covariance
+ * matrix and the step size learn the directions and the distances in which the fitness
+ * improves. With a few dozens of genes it usually needs far fewer evaluations than the
+ * genetic algorithm. With so few genes, the candidates are sampled and the covariance matrix
+ * is updated on the breeding thread alone, as splitting the work would cost more than it saves.
+ */
+class CmaEsOptimizer final : public Optimizer
+{
+public:
+	/**
+	 * \brief Creates the strategy
+	 * \param initialMean Genome around which the first candidates are drawn
+	 * \param initialStepSize Standard deviation of the genes of the first candidates
+	 */
+	CmaEsOptimizer(Genome initialMean, float initialStepSize);
+
+	std::vector<Genome> ask(std::size_t numberOfCandidates) override;
+	void tell(const std::vector<Genome>& candidates, const std::vector<float>& fitness) override;
+	const char* name() const override;
+
+private:
+	/**
+	 * \brief Computes the eigenvectors and eigenvalues of the covariance matrix, so it can be sampled
+	 */
+	void decomposeCovariance();
+
+	/**
+	 * \brief Returns the element of the square matrix of the size of the genome
+	 * \param matrix Matrix stored row by row
+	 * \param row Row of the element
+	 * \param column Column of the element
+	 * \return Reference to the element
+	 */
+	double& at(std::vector<double>& matrix, std::size_t row, std::size_t column) const;
+	double at(const std::vector<double>& matrix, std::size_t row, std::size_t column) const;
+
+private:
+	/** Number of the genes */
+	std::size_t mDimension;
+
+	/** Center of the distribution of the candidates */
+	std::vector<double> mMean;
+
+	/** Overall standard deviation of the candidates */
+	double mStepSize;
+
+	/** Covariance matrix of the distribution, row by row */
+	std::vector<double> mCovariance;
+
+	/** Eigenvectors of the covariance matrix in the columns, row by row */
+	std::vector<double> mEigenvectors;
+
+	/** Square roots of the eigenvalues of the covariance matrix */
+	std::vector<double> mScales;
+
+	/** Evolution path of the covariance matrix */
+	std::vector<double> mCovariancePath;
+
+	/** Evolution path of the step size */
+	std::vector<double> mStepSizePath;
+
+	/** Number of updates made so far */
+	int mGeneration;
+
+	/** Draws the candidates */
+	std::mt19937 mRandomGenerator;
+};
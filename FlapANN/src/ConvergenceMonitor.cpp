@@ -0,0 +1,168 @@
+#include "pch.h"
+#include "ConvergenceMonitor.h"
+
+#include <cfloat>
+#include <imgui/imgui.h>
+
+ConvergenceMonitor::ConvergenceMonitor(const GeneticAlgorithm::Mutation& mutation, int populationSize) :
+	mAdaptation{ mutation, populationSize },
+	mInitialAdaptation{ mutation, populationSize },
+	mBestFitness(-FLT_MAX),
+	mGenerationsWithoutProgress(0),
+	mDiversity(0.f),
+	mPhase(Phase::Searching),
+	mGenerations(0),
+	mTrainingStart(std::chrono::steady_clock::now())
+{
+}
+
+ConvergenceMonitor::Adaptation ConvergenceMonitor::update(const std::vector<float>& fitness, float diversity)
+{
+	mDiversity = diversity;
+	if (fitness.empty())
+	{
+		return mAdaptation;
+	}
+
+	const auto bestFitness = *std::max_element(fitness.cbegin(), fitness.cend());
+	++mGenerations;
+	if (!mTimeToTarget && bestFitness >= mSettings.targetFitness)
+	{
+		const std::chrono::duration<float> time = std::chrono::steady_clock::now() - mTrainingStart;
+		mTimeToTarget = TimeToTarget{ mGenerations, time.count(), mSettings.adaptMutation, mSettings.adaptPopulation };
+	}
+
+	if (bestFitness >= mBestFitness + mSettings.minimumImprovement)
+	{
+		mBestFitness = bestFitness;
+		mGenerationsWithoutProgress = 0;
+		mPhase = Phase::Progressing;
+	}
+	else
+	{
+		mBestFitness = std::max(mBestFitness, bestFitness);
+		++mGenerationsWithoutProgress;
+		const auto isOnPlateau = mGenerationsWithoutProgress >= mSettings.plateauGenerations;
+		const auto hasCollapsed = diversity < mSettings.minimumDiversity;
+		mPhase = isOnPlateau || hasCollapsed ? Phase::Stagnating : Phase::Searching;
+	}
+
+	// Progress is refined with smaller changes, a plateau is left with larger ones.
+	// In between, the evolution is left as it is.
+	auto& mutation = mAdaptation.mutation;
+	auto& populationSize = mAdaptation.populationSize;
+	if (mPhase == Phase::Progressing)
+	{
+		if (mSettings.adaptMutation)
+		{
+			mutation.rate /= mSettings.mutationStep;
+			mutation.strength /= mSettings.mutationStep;
+		}
+		if (mSettings.adaptPopulation)
+		{
+			populationSize -= mSettings.populationStep;
+		}
+	}
+	else if (mPhase == Phase::Stagnating)
+	{
+		if (mSettings.adaptMutation)
+		{
+			mutation.rate *= mSettings.mutationStep;
+			mutation.strength *= mSettings.mutationStep;
+		}
+		if (mSettings.adaptPopulation)
+		{
+			populationSize += mSettings.populationStep;
+		}
+	}
+
+	mutation.rate = std::clamp(mutation.rate, mSettings.minimumRate, mSettings.maximumRate);
+	mutation.strength = std::clamp(mutation.strength, mSettings.minimumStrength, mSettings.maximumStrength);
+	populationSize = std::clamp(populationSize, mSettings.minimumPopulation, mSettings.maximumPopulation);
+	return mAdaptation;
+}
+
+ConvergenceMonitor::Adaptation ConvergenceMonitor::reset()
+{
+	if (mTimeToTarget)
+	{
+		mPreviousTimesToTarget.push_back(*mTimeToTarget);
+	}
+	mTimeToTarget.reset();
+	mGenerations = 0;
+	mTrainingStart = std::chrono::steady_clock::now();
+
+	mAdaptation = mInitialAdaptation;
+	mBestFitness = -FLT_MAX;
+	mGenerationsWithoutProgress = 0;
+	mPhase = Phase::Searching;
+	return mAdaptation;
+}
+
+void ConvergenceMonitor::updateImGui()
+{
+	if (!ImGui::CollapsingHeader("Convergence"))
+	{
+		return;
+	}
+
+	ImGui::Checkbox("Adapt mutation", &mSettings.adaptMutation);
+	ImGui::Checkbox("Adapt population size", &mSettings.adaptPopulation);
+	ImGui::SliderInt("Plateau [generations]", &mSettings.plateauGenerations, 1, 50);
+	ImGui::SliderFloat("Minimum improvement", &mSettings.minimumImprovement, 0.f, 5.f, "%.2f");
+	ImGui::SliderFloat("Minimum diversity", &mSettings.minimumDiversity, 0.f, 1.f, "%.3f");
+	if (ImGui::DragIntRange2("Population bounds", &mSettings.minimumPopulation, &mSettings.maximumPopulation, 1.f, 10, 1000))
+	{
+		mSettings.minimumPopulation = std::max(mSettings.minimumPopulation, 10);
+	}
+
+	ImGui::Text("Phase: %s", nameOf(mPhase));
+	ImGui::Text("Generations without progress: %d", mGenerationsWithoutProgress);
+	ImGui::Text("Diversity: %.3f", mDiversity);
+	ImGui::Text("Mutation rate: %.3f, strength: %.2f", mAdaptation.mutation.rate, mAdaptation.mutation.strength);
+	ImGui::Text("Population size: %d", mAdaptation.populationSize);
+
+	ImGui::InputFloat("Target fitness", &mSettings.targetFitness, 1.f, 10.f, "%.1f");
+	if (mTimeToTarget)
+	{
+		ImGui::Text("Target reached in %d generations, %.1f s", mTimeToTarget->generations, mTimeToTarget->seconds);
+	}
+	else
+	{
+		ImGui::Text("Target not reached yet, %d generations so far", mGenerations);
+	}
+
+	constexpr auto tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+	if (!mPreviousTimesToTarget.empty() && ImGui::BeginTable("Times to target", 4, tableFlags))
+	{
+		ImGui::TableSetupColumn("Mutation");
+		ImGui::TableSetupColumn("Population");
+		ImGui::TableSetupColumn("Generations");
+		ImGui::TableSetupColumn("Seconds");
+		ImGui::TableHeadersRow();
+		for (const auto& timeToTarget : mPreviousTimesToTarget)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(timeToTarget.adaptedMutation ? "adapted" : "fixed");
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(timeToTarget.adaptedPopulation ? "adapted" : "fixed");
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", timeToTarget.generations);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", timeToTarget.seconds);
+		}
+		ImGui::EndTable();
+	}
+}
+
+const char* ConvergenceMonitor::nameOf(Phase phase)
+{
+	switch (phase)
+	{
+		case Phase::Progressing: return "progressing";
+		case Phase::Searching: return "searching";
+		case Phase::Stagnating: return "stagnating";
+	}
+	return "unknown";
+}
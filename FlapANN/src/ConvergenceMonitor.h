@@ -0,0 +1,160 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#include "GeneticAlgorithm.h"
+
+/**
+ * \brief Watches the progress of the training and adapts the evolution to it.
+ *
+ * After every generation the best fitness is compared with the best one so far, and the
+ * diversity of the bred population is measured. While the training makes progress, the
+ * mutation calms down, so the good networks are refined instead of being thrown around,
+ * and the population may shrink to save time. Once the best fitness stops improving for
+ * a number of generations, or the gene pool collapses, the mutation gets stronger and
+ * the population may grow, so the search can leave the plateau.
+ */
+class ConvergenceMonitor
+{
+public:
+	/**
+	 * \brief State of the training as seen by the monitor
+	 */
+	enum class Phase
+	{
+		Progressing,
+		Searching,
+		Stagnating,
+	};
+
+	/**
+	 * \brief Bounds and speed of the adaptation
+	 */
+	struct Settings
+	{
+		/** Set if the mutation rate and strength are adapted */
+		bool adaptMutation = true;
+
+		/** Set if the size of the population is adapted */
+		bool adaptPopulation = false;
+
+		/** Smallest improvement of the best fitness that counts as progress */
+		float minimumImprovement = 0.1f;
+
+		/** Number of generations without progress after which the training stagnates */
+		int plateauGenerations = 8;
+
+		/** Diversity under which the gene pool is considered collapsed */
+		float minimumDiversity = 0.05f;
+
+		/** Factor by which the mutation changes in each generation */
+		float mutationStep = 1.2f;
+
+		/** Bounds of the mutation rate */
+		float minimumRate = 0.05f;
+		float maximumRate = 0.5f;
+
+		/** Bounds of the mutation strength */
+		float minimumStrength = 0.25f;
+		float maximumStrength = 3.f;
+
+		/** Number of units by which the population grows or shrinks in each generation */
+		int populationStep = 10;
+
+		/** Bounds of the size of the population */
+		int minimumPopulation = 50;
+		int maximumPopulation = 300;
+
+		/** Best fitness at which the training is timed as having reached its target */
+		float targetFitness = 60.f;
+	};
+
+	/**
+	 * \brief What the evolution should use for the next population
+	 */
+	struct Adaptation
+	{
+		GeneticAlgorithm::Mutation mutation;
+		int populationSize;
+	};
+
+	/**
+	 * \brief How long a training took to reach the target fitness, counted from the last reset
+	 */
+	struct TimeToTarget
+	{
+		int generations;
+		float seconds;
+		bool adaptedMutation;
+		bool adaptedPopulation;
+	};
+
+	/**
+	 * \brief Creates the monitor starting from the current settings of the evolution
+	 * \param mutation Mutation used so far
+	 * \param populationSize Size of the population used so far
+	 */
+	ConvergenceMonitor(const GeneticAlgorithm::Mutation& mutation, int populationSize);
+
+	/**
+	 * \brief Takes the results of the finished generation into account
+	 * \param fitness Final fitness of every unit of the finished generation
+	 * \param diversity Diversity of the population bred from it
+	 * \return Mutation and size of the population for the next one
+	 */
+	Adaptation update(const std::vector<float>& fitness, float diversity);
+
+	/**
+	 * \brief Forgets the progress and brings back the mutation and the size of the population
+	 * the monitor was created with, so nothing adapted carries over into the next training
+	 * \return Mutation and size of the population the next training starts with
+	 */
+	Adaptation reset();
+
+	/**
+	 * \brief Updates the settings of the adaptation and shows the state of the training
+	 */
+	void updateImGui();
+
+private:
+	/**
+	 * \brief Returns the name of the phase displayed to the user
+	 * \param phase Phase to name
+	 * \return Name of the phase
+	 */
+	static const char* nameOf(Phase phase);
+
+private:
+	/** Bounds and speed of the adaptation */
+	Settings mSettings;
+
+	/** What the evolution uses currently */
+	Adaptation mAdaptation;
+
+	/** What the evolution used when the monitor was created, brought back by every reset */
+	Adaptation mInitialAdaptation;
+
+	/** The best fitness reached so far */
+	float mBestFitness;
+
+	/** Number of generations since the best fitness last improved */
+	int mGenerationsWithoutProgress;
+
+	/** Diversity of the last bred population */
+	float mDiversity;
+
+	/** State of the training after the last generation */
+	Phase mPhase;
+
+	/** Number of generations and the moment at which the current training started */
+	int mGenerations;
+	std::chrono::steady_clock::time_point mTrainingStart;
+
+	/** How long the current training took to reach the target, if it did */
+	std::optional<TimeToTarget> mTimeToTarget;
+
+	/** Times to the target of the finished trainings, so the runs with and without the adaptation can be compared */
+	std::vector<TimeToTarget> mPreviousTimesToTarget;
+};
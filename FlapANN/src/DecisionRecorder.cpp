@@ -0,0 +1,309 @@
+#include "pch.h"
+#include "DecisionRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+
+namespace
+{
+	constexpr char LOG_MAGIC[8] = { 'F', 'L', 'A', 'P', 'R', 'E', 'C', '1' };
+
+	template <typename T>
+	void writeValue(std::vector<char>& bytes, const T& value)
+	{
+		const auto* valueBytes = reinterpret_cast<const char*>(&value);
+		bytes.insert(bytes.end(), valueBytes, valueBytes + sizeof(T));
+	}
+
+	template <typename T>
+	bool readValue(const char*& cursor, const char* end, T& value)
+	{
+		if (static_cast<std::size_t>(end - cursor) < sizeof(T))
+			return false;
+		std::memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+
+	bool readRun(const char* cursor, const char* end, RecordedRun& run)
+	{
+		auto& course = run.courseSettings;
+		std::uint8_t pattern;
+		float patternSpeed, patternRange;
+		if (!readValue(cursor, end, run.generation) || !readValue(cursor, end, course.seed) ||
+			!readValue(cursor, end, course.minXOffset) || !readValue(cursor, end, course.maxXOffset) ||
+			!readValue(cursor, end, course.minGapCenter) || !readValue(cursor, end, course.maxGapCenter) ||
+			!readValue(cursor, end, course.gapSize) || !readValue(cursor, end, pattern) ||
+			!readValue(cursor, end, patternSpeed) || !readValue(cursor, end, patternRange))
+			return false;
+		if (pattern >= static_cast<std::uint8_t>(MovePattern::Pattern::Last))
+			return false;
+		course.movePattern.applyPattern(static_cast<MovePattern::Pattern>(pattern));
+		course.movePattern.patternSpeed(patternSpeed);
+		course.movePattern.patternRange(patternRange);
+
+		std::uint32_t numberOfTimeSteps;
+		if (!readValue(cursor, end, numberOfTimeSteps))
+			return false;
+		for (std::uint32_t index = 0; index < numberOfTimeSteps; ++index)
+		{
+			RecordedRun::TimeStep timeStep;
+			if (!readValue(cursor, end, timeStep.firstTick) || !readValue(cursor, end, timeStep.seconds))
+				return false;
+			run.timeSteps.push_back(timeStep);
+		}
+
+		std::uint32_t numberOfBirds;
+		if (!readValue(cursor, end, numberOfBirds))
+			return false;
+		for (std::uint32_t index = 0; index < numberOfBirds; ++index)
+		{
+			RecordedBird bird;
+			if (!readValue(cursor, end, bird.index) || !readValue(cursor, end, bird.fitness) ||
+				!readValue(cursor, end, bird.numberOfTicks))
+				return false;
+			const auto numberOfBytes = (static_cast<std::size_t>(bird.numberOfTicks) + 7) / 8;
+			if (static_cast<std::size_t>(end - cursor) < numberOfBytes)
+				return false;
+			bird.flaps.assign(cursor, cursor + numberOfBytes);
+			cursor += numberOfBytes;
+			run.birds.push_back(std::move(bird));
+		}
+		return cursor == end;
+	}
+}
+
+bool RecordedBird::hasFlapped(std::uint32_t tick) const
+{
+	return tick < numberOfTicks && ((flaps[tick / 8] >> (tick % 8)) & 1u) != 0;
+}
+
+sf::Time RecordedRun::timeStepAt(std::uint32_t tick) const
+{
+	assert(!timeSteps.empty());
+
+	// Time steps are sorted by their first tick, so the last one starting before the tick is searched
+	auto foundTimeStep = std::upper_bound(timeSteps.cbegin(), timeSteps.cend(), tick,
+		[](std::uint32_t tick, const TimeStep& timeStep) { return tick < timeStep.firstTick; });
+	return sf::seconds(std::prev(foundTimeStep)->seconds);
+}
+
+DecisionRecorder::DecisionRecorder(std::string path_to_log, std::size_t birdsToKeep) :
+	mLogPath(std::move(path_to_log)),
+	mBirdsToKeep(birdsToKeep),
+	mRun(),
+	mTick(0),
+	mIsStopping(false),
+	mWriter(&DecisionRecorder::writeRuns, this)
+{
+}
+
+DecisionRecorder::~DecisionRecorder()
+{
+	{
+		std::lock_guard lock(mMutex);
+		mIsStopping = true;
+	}
+	mRunsPending.notify_one();
+	mWriter.join();
+}
+
+void DecisionRecorder::beginRun(std::uint32_t generation, std::shared_ptr<const PipeCourse> course, std::size_t numberOfBirds)
+{
+	assert(course);
+
+	mRun = RecordedRun();
+	mRun.generation = generation;
+	mRun.courseSettings = course->settings();
+	mRun.birds.resize(numberOfBirds);
+	for (std::size_t index = 0; index < numberOfBirds; ++index)
+	{
+		mRun.birds[index] = { static_cast<std::uint32_t>(index), 0.f, 0, {} };
+	}
+	mCourse = std::move(course);
+	mTick = 0;
+}
+
+void DecisionRecorder::recordTick(const sf::Time& deltaTime)
+{
+	const auto seconds = deltaTime.asSeconds();
+	if (mRun.timeSteps.empty() || mRun.timeSteps.back().seconds != seconds)
+	{
+		mRun.timeSteps.push_back({ mTick, seconds });
+	}
+	++mTick;
+}
+
+void DecisionRecorder::recordDecision(std::size_t birdIndex, bool flapped)
+{
+	auto& bird = mRun.birds[birdIndex];
+
+	// The bird is alive from the very beginning until its death, so the
+	// decisions never have gaps and the tick is just their number
+	assert(bird.numberOfTicks + 1 == mTick);
+
+	if (bird.numberOfTicks % 8 == 0)
+	{
+		bird.flaps.push_back(0);
+	}
+	if (flapped)
+	{
+		bird.flaps.back() |= static_cast<std::uint8_t>(1u << (bird.numberOfTicks % 8));
+	}
+	++bird.numberOfTicks;
+}
+
+void DecisionRecorder::rewindTo(std::uint32_t tick)
+{
+	assert(tick <= mTick);
+
+	while (!mRun.timeSteps.empty() && mRun.timeSteps.back().firstTick >= tick)
+	{
+		mRun.timeSteps.pop_back();
+	}
+	for (auto& bird : mRun.birds)
+	{
+		if (bird.numberOfTicks <= tick)
+		{
+			continue;
+		}
+		bird.numberOfTicks = tick;
+		bird.flaps.resize((static_cast<std::size_t>(tick) + 7) / 8);
+		if (tick % 8 != 0)
+		{
+			// Bits of the forgotten ticks are cleared, as the new decisions are added to them
+			bird.flaps.back() &= static_cast<std::uint8_t>((1u << (tick % 8)) - 1);
+		}
+	}
+	mTick = tick;
+}
+
+void DecisionRecorder::finishRun(const std::shared_ptr<const PipeCourse>& course, const std::vector<float>& fitness)
+{
+	assert(fitness.size() == mRun.birds.size());
+
+	if (course != mCourse || mRun.birds.empty())
+	{
+		return;
+	}
+
+	std::vector<std::size_t> ranking(mRun.birds.size());
+	std::iota(ranking.begin(), ranking.end(), 0);
+	const auto birdsToKeep = std::min(mBirdsToKeep, ranking.size());
+	std::partial_sort(ranking.begin(), ranking.begin() + birdsToKeep, ranking.end(),
+		[&fitness](std::size_t a, std::size_t b) { return fitness[a] > fitness[b]; });
+
+	std::vector<RecordedBird> bestBirds;
+	for (std::size_t place = 0; place < birdsToKeep; ++place)
+	{
+		bestBirds.push_back(std::move(mRun.birds[ranking[place]]));
+		bestBirds.back().fitness = fitness[ranking[place]];
+	}
+	mRun.birds = std::move(bestBirds);
+
+	auto bytes = serialize(mRun);
+	{
+		std::lock_guard lock(mMutex);
+		mPendingRuns.push_back(std::move(bytes));
+	}
+	mRunsPending.notify_one();
+
+	mRun.birds.clear();
+	mCourse.reset();
+}
+
+std::vector<RecordedRun> DecisionRecorder::readRuns(const std::string& path_to_log)
+{
+	std::ifstream log(path_to_log, std::ios::binary);
+	const std::vector<char> bytes((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+
+	std::vector<RecordedRun> runs;
+	const char* cursor = bytes.data();
+	const char* end = bytes.data() + bytes.size();
+
+	char magic[sizeof(LOG_MAGIC)];
+	if (!readValue(cursor, end, magic) || std::memcmp(magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0)
+		return runs;
+
+	// The last run might be still being written, so only the complete ones are read
+	std::uint32_t runSize;
+	while (readValue(cursor, end, runSize) && static_cast<std::size_t>(end - cursor) >= runSize)
+	{
+		RecordedRun run;
+		if (readRun(cursor, cursor + runSize, run))
+			runs.push_back(std::move(run));
+		cursor += runSize;
+	}
+	return runs;
+}
+
+const std::string& DecisionRecorder::logPath() const
+{
+	return mLogPath;
+}
+
+void DecisionRecorder::writeRuns()
+{
+	std::unique_lock lock(mMutex);
+	while (true)
+	{
+		mRunsPending.wait(lock, [this]() { return mIsStopping || !mPendingRuns.empty(); });
+		if (mPendingRuns.empty())
+			return;
+
+		auto runs = std::move(mPendingRuns);
+		mPendingRuns.clear();
+		lock.unlock();
+
+		// The file is opened only for the time of writing, so it can be read by the game at any time
+		std::ofstream log(mLogPath, std::ios::binary | std::ios::app | std::ios::ate);
+		if (log.tellp() == 0)
+			log.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+		for (const auto& run : runs)
+			log.write(run.data(), run.size());
+		log.close();
+
+		lock.lock();
+	}
+}
+
+std::vector<char> DecisionRecorder::serialize(const RecordedRun& run)
+{
+	const auto& course = run.courseSettings;
+
+	std::vector<char> bytes;
+	writeValue(bytes, std::uint32_t{ 0 }); // Size of the run, filled at the end
+	writeValue(bytes, run.generation);
+	writeValue(bytes, course.seed);
+	writeValue(bytes, course.minXOffset);
+	writeValue(bytes, course.maxXOffset);
+	writeValue(bytes, course.minGapCenter);
+	writeValue(bytes, course.maxGapCenter);
+	writeValue(bytes, course.gapSize);
+	writeValue(bytes, static_cast<std::uint8_t>(course.movePattern.pattern()));
+	writeValue(bytes, course.movePattern.patternSpeed());
+	writeValue(bytes, course.movePattern.patternRange());
+
+	writeValue(bytes, static_cast<std::uint32_t>(run.timeSteps.size()));
+	for (const auto& timeStep : run.timeSteps)
+	{
+		writeValue(bytes, timeStep.firstTick);
+		writeValue(bytes, timeStep.seconds);
+	}
+
+	writeValue(bytes, static_cast<std::uint32_t>(run.birds.size()));
+	for (const auto& bird : run.birds)
+	{
+		writeValue(bytes, bird.index);
+		writeValue(bytes, bird.fitness);
+		writeValue(bytes, bird.numberOfTicks);
+		bytes.insert(bytes.end(), bird.flaps.cbegin(), bird.flaps.cend());
+	}
+
+	const auto runSize = static_cast<std::uint32_t>(bytes.size() - sizeof(std::uint32_t));
+	std::memcpy(bytes.data(), &runSize, sizeof(runSize));
+	return bytes;
+}
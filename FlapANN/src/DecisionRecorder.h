@@ -0,0 +1,193 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "nodes/objects/pipe/PipeCourse.h"
+
+/**
+ * \brief Decisions taken by a single bird during the whole run
+ */
+struct RecordedBird
+{
+	/** Index of the bird (and its genome) inside the population */
+	std::uint32_t index;
+
+	/** Fitness score the bird achieved */
+	float fitness;
+
+	/** Number of ticks the bird was alive, one decision per each of them */
+	std::uint32_t numberOfTicks;
+
+	/** One bit per tick, set if the bird flapped at that tick */
+	std::vector<std::uint8_t> flaps;
+
+	/**
+	 * \brief Checks if the bird flapped at the given tick
+	 * \param tick Tick counting from the start of the run
+	 * \return True if the bird flapped, false otherwise (or if it was already dead)
+	 */
+	bool hasFlapped(std::uint32_t tick) const;
+};
+
+/**
+ * \brief Everything needed to play the run of the generation again
+ *
+ * The game is fully determined by the course, the length of successive ticks
+ * and the decisions of the birds, so nothing else has to be stored.
+ */
+struct RecordedRun
+{
+	/**
+	 * \brief Length of the ticks starting from the given one
+	 */
+	struct TimeStep
+	{
+		std::uint32_t firstTick;
+		float seconds;
+	};
+
+	/**
+	 * \brief Returns the length of the given tick
+	 * \param tick Tick counting from the start of the run
+	 * \return The time that has passed in the given tick
+	 */
+	sf::Time timeStepAt(std::uint32_t tick) const;
+
+	/** Generation that was recorded */
+	std::uint32_t generation;
+
+	/** Settings the course of the run was generated with */
+	PipeCourse::Settings courseSettings;
+
+	/** Length of the ticks, stored only when it changes */
+	std::vector<TimeStep> timeSteps;
+
+	/** Birds recorded during the run, starting with the best one */
+	std::vector<RecordedBird> birds;
+};
+
+/**
+ * \brief Records decisions of the birds, so the best runs can be watched again without training.
+ *
+ * During the run the decision of every bird is kept in memory as a single bit per tick.
+ * When the run is over, only the best birds are kept and the run is passed to the background
+ * thread, which appends it to the log file. The game never waits for the disk.
+ *
+ * Only the decisions of the networks are recorded. Flaps forced by the player are not
+ * part of the log, so such run is replayed the way the networks would play it.
+ */
+class DecisionRecorder
+{
+public:
+	/**
+	 * \brief Starts the thread writing the runs to the log file
+	 * \param path_to_log Path of the file to which the runs are appended
+	 * \param birdsToKeep Number of the best birds kept from every run
+	 */
+	DecisionRecorder(std::string path_to_log, std::size_t birdsToKeep);
+
+	/**
+	 * \brief Writes all the remaining runs and stops the thread
+	 */
+	~DecisionRecorder();
+
+	DecisionRecorder(const DecisionRecorder&) = delete;
+	DecisionRecorder& operator=(const DecisionRecorder&) = delete;
+
+	/**
+	 * \brief Starts recording a new run, dropping the unfinished one
+	 * \param generation Generation that is going to be recorded
+	 * \param course Course the birds are going to follow
+	 * \param numberOfBirds Number of birds taking part in the run
+	 */
+	void beginRun(std::uint32_t generation, std::shared_ptr<const PipeCourse> course, std::size_t numberOfBirds);
+
+	/**
+	 * \brief Records the start of the next tick
+	 * \param deltaTime The time that passes in this tick
+	 */
+	void recordTick(const sf::Time& deltaTime);
+
+	/**
+	 * \brief Records the decision of the bird that is still alive at this tick
+	 * \param birdIndex Index of the bird inside the population
+	 * \param flapped True if the bird decided to flap
+	 */
+	void recordDecision(std::size_t birdIndex, bool flapped);
+
+	/**
+	 * \brief Forgets everything recorded after the given tick, so the run can be recorded again from there
+	 * \param tick Number of ticks that stay recorded
+	 */
+	void rewindTo(std::uint32_t tick);
+
+	/**
+	 * \brief Finishes the run and passes its best birds to be written to the log
+	 * \param course Course the birds were following at the end of the run
+	 * \param fitness Fitness score of every bird indexed as in the population
+	 *
+	 * If the course has changed during the run, it could not be replayed, so it is dropped.
+	 */
+	void finishRun(const std::shared_ptr<const PipeCourse>& course, const std::vector<float>& fitness);
+
+	/**
+	 * \brief Reads all the complete runs from the log file
+	 * \param path_to_log Path of the log file
+	 * \return Runs in the order they were recorded
+	 */
+	static std::vector<RecordedRun> readRuns(const std::string& path_to_log);
+
+	/**
+	 * \brief Returns the path of the file to which the runs are appended
+	 * \return Path of the log file
+	 */
+	const std::string& logPath() const;
+
+private:
+	/**
+	 * \brief Appends the serialized runs to the log file until the recorder is destroyed
+	 */
+	void writeRuns();
+
+	/**
+	 * \brief Turns the run into the bytes stored in the log file
+	 * \param run Run to serialize
+	 * \return Bytes of the run
+	 */
+	static std::vector<char> serialize(const RecordedRun& run);
+
+private:
+	/** Path of the file to which the runs are appended */
+	std::string mLogPath;
+
+	/** Number of the best birds kept from every run */
+	std::size_t mBirdsToKeep;
+
+	/** Run that is being recorded */
+	RecordedRun mRun;
+
+	/** Course the recorded run follows */
+	std::shared_ptr<const PipeCourse> mCourse;
+
+	/** Number of ticks recorded in the current run */
+	std::uint32_t mTick;
+
+	/** Serialized runs waiting to be written to the disk */
+	std::deque<std::vector<char>> mPendingRuns;
+
+	/** Guards the pending runs and the stopping flag */
+	std::mutex mMutex;
+
+	/** Wakes the writing thread up when there is something to write */
+	std::condition_variable mRunsPending;
+
+	/** Flag telling the writing thread to finish */
+	bool mIsStopping;
+
+	/** Thread appending the runs to the log file */
+	std::thread mWriter;
+};
@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "FitnessCache.h"
+
+#include <cstring>
+#include <utility>
+
+#include "Optimizer.h"
+
+namespace
+{
+	constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+	constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+	/**
+	 * \brief Adds the next word to the FNV-1a hash, a whole word at a time instead of byte after byte
+	 * \param hash Hash computed so far
+	 * \param word Word to add
+	 * \return Updated hash
+	 */
+	std::uint64_t hashWord(std::uint64_t hash, std::uint32_t word)
+	{
+		return (hash ^ word) * FNV_PRIME;
+	}
+
+	std::uint64_t hashFloat(std::uint64_t hash, float value)
+	{
+		static_assert(sizeof(float) == sizeof(std::uint32_t));
+		std::uint32_t word;
+		std::memcpy(&word, &value, sizeof(word));
+		return hashWord(hash, word);
+	}
+}
+
+FitnessCache::FitnessCache(std::size_t capacity) :
+	mCapacity(capacity)
+{
+	mRecentScores.reserve(capacity);
+	mOlderScores.reserve(capacity);
+}
+
+std::uint64_t FitnessCache::hashOf(const fann* ann)
+{
+	auto hash = FNV_OFFSET_BASIS;
+	for (unsigned int connection = 0; connection < ann->total_connections; ++connection)
+	{
+		hash = hashFloat(hash, ann->weights[connection]);
+	}
+
+	const auto [firstNeuron, lastNeuron] = Optimizer::neuronsOf(ann);
+	for (const auto* neuron = firstNeuron; neuron != lastNeuron; ++neuron)
+	{
+		hash = hashFloat(hash, neuron->activation_steepness);
+		hash = hashWord(hash, static_cast<std::uint32_t>(neuron->activation_function));
+	}
+	return hash;
+}
+
+std::uint64_t FitnessCache::keyOf(std::uint64_t genome, std::uint64_t course)
+{
+	// Finalizer of MurmurHash3, so the similar keys of the courses do not collide after mixing
+	auto key = genome ^ (course + 0x9e3779b97f4a7c15ull + (genome << 6) + (genome >> 2));
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ull;
+	key ^= key >> 33;
+	return key;
+}
+
+std::optional<float> FitnessCache::find(std::uint64_t key)
+{
+	++mStatistics.lookups;
+	if (const auto recent = mRecentScores.find(key); recent != mRecentScores.end())
+	{
+		++mStatistics.hits;
+		return recent->second;
+	}
+	if (const auto older = mOlderScores.find(key); older != mOlderScores.end())
+	{
+		++mStatistics.hits;
+		const auto score = older->second;
+		insert(key, score);
+		return score;
+	}
+	return std::nullopt;
+}
+
+void FitnessCache::countDuplicate()
+{
+	++mStatistics.lookups;
+	++mStatistics.hits;
+}
+
+void FitnessCache::insert(std::uint64_t key, float score)
+{
+	if (mRecentScores.size() >= mCapacity)
+	{
+		mOlderScores.clear();
+		std::swap(mRecentScores, mOlderScores);
+	}
+	mRecentScores[key] = score;
+}
+
+FitnessCache::Statistics FitnessCache::takeStatistics()
+{
+	return std::exchange(mStatistics, {});
+}
+
+void FitnessCache::clear()
+{
+	mRecentScores.clear();
+	mOlderScores.clear();
+}
+
+std::size_t FitnessCache::size() const
+{
+	return mRecentScores.size() + mOlderScores.size();
+}
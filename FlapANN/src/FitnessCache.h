@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+#include "fann/fann.h"
+
+/**
+ * \brief Remembers the scores of the networks that were already played, so they are not played again.
+ *
+ * Units copied from the previous generation, elites and duplicates inside the same generation
+ * have exactly the same weights. The courses are deterministic, so the same network on the same
+ * course always gets the same score. The scores are kept under the hash of the network combined
+ * with the key of the course.
+ *
+ * The cache keeps two tables. New scores go to the recent one, and once it is full, it becomes
+ * the older one and the previous older one is forgotten. Scores found in the older table are
+ * brought back to the recent one, so units that survive many generations are never forgotten.
+ */
+class FitnessCache
+{
+public:
+	/**
+	 * \brief Lookups made since the statistics were last taken
+	 */
+	struct Statistics
+	{
+		/** Number of scores looked for */
+		std::uint64_t lookups = 0;
+
+		/** Number of scores found or shared with a duplicate, which did not have to be played */
+		std::uint64_t hits = 0;
+	};
+
+	/**
+	 * \brief Creates the empty cache
+	 * \param capacity Number of scores kept in each of the two tables
+	 */
+	explicit FitnessCache(std::size_t capacity);
+
+	/**
+	 * \brief Computes the hash of everything that decides the output of the network
+	 * \param ann Network to hash
+	 * \return Hash of the weights, activation functions and steepness of the network
+	 */
+	static std::uint64_t hashOf(const fann* ann);
+
+	/**
+	 * \brief Combines the hash of the network with the key of the course
+	 * \param genome Hash of the network
+	 * \param course Key of the course and of the rules under which it is played
+	 * \return Key under which the score is kept
+	 */
+	static std::uint64_t keyOf(std::uint64_t genome, std::uint64_t course);
+
+	/**
+	 * \brief Looks for the score, counting the lookup in the statistics
+	 * \param key Key of the network and the course
+	 * \return The score if the network was already played on the course
+	 */
+	std::optional<float> find(std::uint64_t key);
+
+	/**
+	 * \brief Counts the unit that was not played, because its duplicate was played on the same course at the same time
+	 */
+	void countDuplicate();
+
+	/**
+	 * \brief Remembers the score of the network played on the course
+	 * \param key Key of the network and the course
+	 * \param score Score the network got
+	 */
+	void insert(std::uint64_t key, float score);
+
+	/**
+	 * \brief Returns the statistics of the lookups and starts counting them again
+	 * \return Lookups made since the last call
+	 */
+	Statistics takeStatistics();
+
+	/**
+	 * \brief Forgets all the scores
+	 */
+	void clear();
+
+	/**
+	 * \brief Returns the number of the remembered scores
+	 * \return Number of the scores in both tables
+	 */
+	std::size_t size() const;
+
+private:
+	/** Number of scores kept in each of the two tables */
+	std::size_t mCapacity;
+
+	/** Scores remembered or used most recently */
+	std::unordered_map<std::uint64_t, float> mRecentScores;
+
+	/** Scores forgotten once the recent table fills up again */
+	std::unordered_map<std::uint64_t, float> mOlderScores;
+
+	/** Lookups made since the statistics were last taken */
+	Statistics mStatistics;
+};
@@ -0,0 +1,342 @@
+#include "pch.h"
+#include "FitnessEvaluator.h"
+
+#include <deque>
+#include <future>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+namespace
+{
+	/**
+	 * \brief Bird reduced to what matters for the rules of the game
+	 */
+	struct HeadlessBird
+	{
+		sf::Vector2f position;
+		sf::Vector2f velocity;
+		float score;
+		float fitness;
+		bool isDead;
+	};
+
+	/**
+	 * \brief Pipe set placed on the course, moved in the same closed form as PipeSet
+	 */
+	struct HeadlessPipeSet
+	{
+		float spawnX;
+		const CoursePipeSet* coursePipeSet;
+		sf::Time spawnTime;
+
+		/** Position of the upper end of the bottom pipe in the current tick */
+		sf::Vector2f bottom;
+
+		/** Position of the lower end of the upper pipe in the current tick */
+		sf::Vector2f upper;
+	};
+
+	/**
+	 * \brief Normalized distance in the same way as the inputs of the network in the game
+	 * \param delta Signed distance
+	 * \param range Size of the screen in the same direction
+	 * \return Distance from -1 to 1, positive if the delta is negative
+	 */
+	float normalizedDistance(float delta, float range)
+	{
+		const auto distance = std::clamp(std::abs(delta) / range, 0.f, 1.f);
+		return delta < 0 ? distance : -distance;
+	}
+}
+
+FitnessEvaluator::FitnessEvaluator(const HeadlessGeometry& geometry) :
+	mGeometry(geometry)
+{
+}
+
+void FitnessEvaluator::evaluate(std::vector<GeneticAlgorithm::Unit>& population, const PipeCourse::Settings& courseSettings,
+                                const Settings& settings, FitnessCache* cache, FitnessSurrogate* surrogate) const
+{
+	assert(settings.numberOfSeeds > 0);
+
+	std::vector<std::uint64_t> genomes;
+	genomes.reserve(population.size());
+	for (const auto& unit : population)
+	{
+		genomes.push_back(FitnessCache::hashOf(unit.ann));
+	}
+
+	// Offspring predicted to be among the weakest are left out of every course
+	std::vector<std::optional<float>> skippedFitness(population.size());
+	if (surrogate)
+	{
+		for (std::size_t unitIndex = 0; unitIndex < population.size(); ++unitIndex)
+		{
+			skippedFitness[unitIndex] = surrogate->skippedFitness(population[unitIndex].ann, settings.numberOfSeeds);
+		}
+	}
+
+	// Units of the population played on a single course. Every unit either
+	// has its score already, or takes it from one of the played birds.
+	struct CoursePlan
+	{
+		std::uint64_t courseKey;
+		std::vector<float> scores;
+		std::vector<int> birdOfUnit;
+		std::vector<std::uint64_t> keyOfBird;
+		std::vector<GeneticAlgorithm::Unit> playedUnits;
+	};
+
+	std::vector<CoursePlan> plans(settings.numberOfSeeds);
+	std::vector<std::future<std::vector<float>>> courseScores;
+	for (auto seed = 0; seed < settings.numberOfSeeds; ++seed)
+	{
+		auto seedCourseSettings = courseSettings;
+		seedCourseSettings.seed += static_cast<std::uint32_t>(seed);
+
+		auto& plan = plans[seed];
+		plan.courseKey = courseKeyOf(seedCourseSettings, settings);
+		plan.scores.resize(population.size());
+		plan.birdOfUnit.assign(population.size(), -1);
+
+		std::unordered_map<std::uint64_t, int> birdOfKey;
+		for (std::size_t unitIndex = 0; unitIndex < population.size(); ++unitIndex)
+		{
+			if (skippedFitness[unitIndex])
+			{
+				continue;
+			}
+
+			const auto key = FitnessCache::keyOf(genomes[unitIndex], plan.courseKey);
+			if (const auto bird = birdOfKey.find(key); bird != birdOfKey.end())
+			{
+				plan.birdOfUnit[unitIndex] = bird->second;
+				if (cache)
+				{
+					cache->countDuplicate();
+				}
+				continue;
+			}
+			if (const auto score = cache ? cache->find(key) : std::nullopt)
+			{
+				plan.scores[unitIndex] = *score;
+				continue;
+			}
+
+			// Running the network writes into it, so every thread plays with its own copies
+			const auto bird = static_cast<int>(plan.playedUnits.size());
+			birdOfKey.emplace(key, bird);
+			plan.birdOfUnit[unitIndex] = bird;
+			plan.keyOfBird.push_back(key);
+			plan.playedUnits.push_back(population[unitIndex]);
+		}
+
+		courseScores.push_back(std::async(std::launch::async, [this, &plan, seedCourseSettings, &settings]()
+		{
+			std::vector<fann*> networks;
+			networks.reserve(plan.playedUnits.size());
+			for (const auto& unit : plan.playedUnits)
+			{
+				networks.push_back(unit.ann);
+			}
+			return play(networks, PipeCourse(seedCourseSettings), settings);
+		}));
+	}
+
+	for (std::size_t course = 0; course < plans.size(); ++course)
+	{
+		auto& plan = plans[course];
+		const auto birdScores = courseScores[course].get();
+		for (std::size_t unitIndex = 0; unitIndex < population.size(); ++unitIndex)
+		{
+			if (plan.birdOfUnit[unitIndex] >= 0)
+			{
+				plan.scores[unitIndex] = birdScores[plan.birdOfUnit[unitIndex]];
+			}
+		}
+		if (cache)
+		{
+			for (std::size_t bird = 0; bird < birdScores.size(); ++bird)
+			{
+				cache->insert(plan.keyOfBird[bird], birdScores[bird]);
+			}
+		}
+	}
+
+	std::vector<float> unitScores(plans.size());
+	for (std::size_t unitIndex = 0; unitIndex < population.size(); ++unitIndex)
+	{
+		if (skippedFitness[unitIndex])
+		{
+			population[unitIndex].fitness = *skippedFitness[unitIndex];
+			continue;
+		}
+
+		for (std::size_t course = 0; course < plans.size(); ++course)
+		{
+			unitScores[course] = plans[course].scores[unitIndex];
+		}
+		population[unitIndex].fitness = aggregate(unitScores, settings);
+	}
+}
+
+std::vector<float> FitnessEvaluator::play(const std::vector<fann*>& networks, const PipeCourse& course, const Settings& settings) const
+{
+	return play(networks.size(), course, settings, [&networks](std::size_t bird, const fann_type* input)
+	{
+		return fann_run(networks[bird], const_cast<fann_type*>(input))[0] > 0.5f;
+	});
+}
+
+std::vector<float> FitnessEvaluator::play(std::size_t numberOfBirds, const PipeCourse& course, const Settings& settings, const Controller& flaps) const
+{
+	const auto& geometry = mGeometry;
+	const auto timeStep = settings.timeStep.asSeconds();
+
+	std::vector<HeadlessBird> birds(numberOfBirds, { geometry.birdStartPosition, {}, 0.f, 0.f, false });
+	auto aliveBirds = birds.size();
+
+	std::deque<HeadlessPipeSet> pipeSets;
+	std::size_t nextCoursePipeSet = 0;
+	auto lastPipeSetDistance = 0.f;
+	auto courseTime = sf::Time::Zero;
+
+	auto hitsPipe = [&geometry](const sf::FloatRect& hitbox, const HeadlessPipeSet& pipeSet)
+	{
+		// Pipes have their origin in the middle of their end, and the upper one is turned upside down
+		const sf::FloatRect bottomPipe{ pipeSet.bottom.x - geometry.pipeSize.x / 2.f, pipeSet.bottom.y,
+		                                geometry.pipeSize.x, geometry.pipeSize.y };
+		const sf::FloatRect upperPipe{ pipeSet.upper.x - geometry.pipeSize.x / 2.f, pipeSet.upper.y - geometry.pipeSize.y,
+		                               geometry.pipeSize.x, geometry.pipeSize.y };
+		return bottomPipe.intersects(hitbox) || upperPipe.intersects(hitbox);
+	};
+
+	for (std::uint32_t tick = 0; tick < settings.maximumTicks && aliveBirds > 0; ++tick)
+	{
+		// Pipes are generated and placed exactly as in PipesGenerator
+		courseTime += settings.timeStep;
+		const auto travelledDistance = geometry.pipeSpeed * courseTime.asSeconds();
+		while (nextCoursePipeSet == 0 || lastPipeSetDistance < travelledDistance)
+		{
+			const auto& coursePipeSet = course[nextCoursePipeSet++];
+			lastPipeSetDistance += coursePipeSet.xOffset;
+			pipeSets.push_back({ geometry.screenSize.x + lastPipeSetDistance - travelledDistance, &coursePipeSet, courseTime, {}, {} });
+		}
+		for (auto& pipeSet : pipeSets)
+		{
+			const auto elapsedTime = courseTime - pipeSet.spawnTime;
+			const auto offset = sf::Vector2f(-geometry.pipeSpeed * elapsedTime.asSeconds(), 0.f)
+			                  + pipeSet.coursePipeSet->movePattern.offsetAt(elapsedTime);
+			const auto& gapCenter = pipeSet.coursePipeSet->gapCenter;
+			const auto& gapSize = pipeSet.coursePipeSet->gapSize;
+			pipeSet.bottom = sf::Vector2f(pipeSet.spawnX, gapCenter + gapSize / 2.f) + offset;
+			pipeSet.upper = sf::Vector2f(pipeSet.spawnX, gapCenter - gapSize / 2.f) + offset;
+		}
+		while (!pipeSets.empty() && pipeSets.front().bottom.x + geometry.pipeSize.x < 0.f)
+		{
+			pipeSets.pop_front();
+		}
+
+		for (std::size_t birdNumber = 0; birdNumber < birds.size(); ++birdNumber)
+		{
+			auto& bird = birds[birdNumber];
+			if (bird.isDead)
+			{
+				continue;
+			}
+
+			bird.position += bird.velocity * timeStep;
+			bird.velocity.y += geometry.gravity * timeStep;
+			bird.score += timeStep;
+			if (bird.position.y < 0 || bird.position.y + geometry.birdHitbox.height > geometry.groundTop)
+			{
+				bird.isDead = true;
+				--aliveBirds;
+				continue;
+			}
+
+			const HeadlessPipeSet* nearestPipeSet = nullptr;
+			for (const auto& pipeSet : pipeSets)
+			{
+				if (bird.position.x <= pipeSet.bottom.x + geometry.pipeSize.x / 1.8f &&
+				    (!nearestPipeSet || std::abs(bird.position.x - pipeSet.bottom.x) < std::abs(bird.position.x - nearestPipeSet->bottom.x)))
+				{
+					nearestPipeSet = &pipeSet;
+				}
+			}
+			assert(nearestPipeSet);
+
+			const auto gapCenterY = (nearestPipeSet->upper.y + nearestPipeSet->bottom.y) / 2.f;
+			fann_type input[NUMBER_OF_INPUTS] = {
+				normalizedDistance(bird.position.x - nearestPipeSet->bottom.x, geometry.screenSize.x),
+				normalizedDistance(bird.position.y - gapCenterY, geometry.screenSize.y),
+				std::clamp(std::abs(bird.position.y) / geometry.screenSize.y, 0.f, 1.f)
+			};
+			bird.fitness = bird.score - std::sqrt(input[0] * input[0] + input[1] * input[1]) / 10.f;
+			if (flaps(birdNumber, input))
+			{
+				bird.velocity = { 0.f, -geometry.jumpStrength };
+			}
+
+			const sf::FloatRect hitbox{ bird.position.x + geometry.birdHitbox.left, bird.position.y + geometry.birdHitbox.top,
+			                            geometry.birdHitbox.width, geometry.birdHitbox.height };
+			if (std::any_of(pipeSets.cbegin(), pipeSets.cend(), [&](const HeadlessPipeSet& pipeSet) { return hitsPipe(hitbox, pipeSet); }))
+			{
+				bird.isDead = true;
+				--aliveBirds;
+			}
+		}
+	}
+
+	std::vector<float> fitness;
+	fitness.reserve(birds.size());
+	for (const auto& bird : birds)
+	{
+		fitness.push_back(bird.fitness);
+	}
+	return fitness;
+}
+
+std::uint64_t FitnessEvaluator::courseKeyOf(const PipeCourse::Settings& courseSettings, const Settings& settings) const
+{
+	const auto& movePattern = courseSettings.movePattern;
+	const float values[] = {
+		courseSettings.minXOffset, courseSettings.maxXOffset,
+		courseSettings.minGapCenter, courseSettings.maxGapCenter, courseSettings.gapSize,
+		static_cast<float>(movePattern.pattern()), movePattern.patternSpeed(), movePattern.patternRange(),
+		settings.timeStep.asSeconds(),
+		mGeometry.screenSize.x, mGeometry.screenSize.y, mGeometry.birdStartPosition.x, mGeometry.birdStartPosition.y,
+		mGeometry.birdHitbox.left, mGeometry.birdHitbox.top, mGeometry.birdHitbox.width, mGeometry.birdHitbox.height,
+		mGeometry.pipeSize.x, mGeometry.pipeSize.y, mGeometry.groundTop, mGeometry.jumpStrength, mGeometry.gravity,
+		mGeometry.pipeSpeed
+	};
+
+	auto key = FitnessCache::keyOf(courseSettings.seed, settings.maximumTicks);
+	for (const auto value : values)
+	{
+		key = FitnessCache::keyOf(key, static_cast<std::uint64_t>(std::hash<float>{}(value)));
+	}
+	return key;
+}
+
+float FitnessEvaluator::aggregate(std::vector<float>& scores, const Settings& settings)
+{
+	assert(!scores.empty());
+
+	switch (settings.aggregation)
+	{
+		case Aggregation::Mean:
+			return std::accumulate(scores.cbegin(), scores.cend(), 0.f) / static_cast<float>(scores.size());
+		case Aggregation::Minimum:
+			return *std::min_element(scores.cbegin(), scores.cend());
+		case Aggregation::Quantile:
+		{
+			const auto quantile = std::clamp(settings.quantile, 0.f, 1.f);
+			const auto position = scores.begin() + static_cast<std::ptrdiff_t>(quantile * (scores.size() - 1) + 0.5f);
+			std::nth_element(scores.begin(), position, scores.end());
+			return *position;
+		}
+	}
+	return 0.f;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "FitnessCache.h"
+#include "GeneticAlgorithm.h"
+#include "nodes/objects/pipe/PipeCourse.h"
+
+/**
+ * \brief Sizes and forces of the game needed to simulate it without any graphics
+ */
+struct HeadlessGeometry
+{
+	/** Size of the screen where the game is displayed */
+	sf::Vector2f screenSize;
+
+	/** Position at which every bird starts */
+	sf::Vector2f birdStartPosition;
+
+	/** Hitbox of the bird relative to its position */
+	sf::FloatRect birdHitbox;
+
+	/** Size of the pipe texture */
+	sf::Vector2f pipeSize;
+
+	/** Height at which the ground starts */
+	float groundTop;
+
+	/** Upward speed the bird gets when it flaps */
+	float jumpStrength;
+
+	/** Downward acceleration of the birds */
+	float gravity;
+
+	/** Speed at which the pipes move to the left */
+	float pipeSpeed;
+};
+
+/**
+ * \brief Scores every unit on several seeded courses at once, each course played on its own thread.
+ *
+ * A single run on a single course is a noisy measure of the network, since some courses are
+ * simply easier than the others. Here the whole population plays each of the courses without
+ * any graphics, exactly by the rules of the game, and the scores from all the courses are
+ * aggregated into the final fitness.
+ */
+class FitnessEvaluator
+{
+public:
+	/** Number of the inputs of the network of every bird, which is the size of the first layer of the game's networks */
+	static constexpr unsigned NUMBER_OF_INPUTS = 3;
+
+	/**
+	 * \brief The way in which the scores from the courses are combined
+	 */
+	enum class Aggregation
+	{
+		Mean,
+		Minimum,
+		Quantile,
+	};
+
+	/**
+	 * \brief Options of the evaluation
+	 */
+	struct Settings
+	{
+		/** Number of courses every unit plays. A single course means the live run is used instead. */
+		int numberOfSeeds = 1;
+
+		/** The way in which the scores are combined */
+		Aggregation aggregation = Aggregation::Mean;
+
+		/** Quantile of the scores used by Aggregation::Quantile, from 0 (the worst) to 1 (the best) */
+		float quantile = 0.25f;
+
+		/** Number of ticks after which the run is stopped, even if some birds are still alive */
+		std::uint32_t maximumTicks = 5 * 60 * 60;
+
+		/** Length of a single tick */
+		sf::Time timeStep = sf::seconds(1.f / 60.f);
+	};
+
+	/**
+	 * \brief Creates the evaluator of the game with the given geometry
+	 * \param geometry Sizes and forces of the game
+	 */
+	explicit FitnessEvaluator(const HeadlessGeometry& geometry);
+
+	/**
+	 * \brief Sets the fitness of every unit to its aggregated score from all the courses.
+	 *
+	 * Units with exactly the same network are played only once on every course and share the score.
+	 * Scores found in the cache are not played at all, and neither are the offspring the surrogate
+	 * predicts to be among the weakest, which get the predicted fitness instead.
+	 *
+	 * \param population Units to score
+	 * \param courseSettings Settings of the first course. The following ones get the next seeds.
+	 * \param settings Options of the evaluation
+	 * \param cache Scores of the networks played before, used only by the calling thread. Nothing is cached if null.
+	 * \param surrogate Model that predicted the fitness of the offspring, used only by the calling thread.
+	 * Every unit is played if null.
+	 */
+	void evaluate(std::vector<GeneticAlgorithm::Unit>& population, const PipeCourse::Settings& courseSettings,
+	              const Settings& settings, FitnessCache* cache = nullptr, FitnessSurrogate* surrogate = nullptr) const;
+
+	/**
+	 * \brief Decides if the bird flaps in the current tick
+	 *
+	 * Called with the number of the bird and the inputs its network would get, in the same order as in the game.
+	 */
+	using Controller = std::function<bool(std::size_t bird, const fann_type* input)>;
+
+	/**
+	 * \brief Plays the whole course with all the networks at once
+	 * \param networks Networks controlling the birds, used only by the calling thread
+	 * \param course Course the birds follow
+	 * \param settings Options of the evaluation
+	 * \return Fitness score of every bird, in the order of the networks
+	 */
+	std::vector<float> play(const std::vector<fann*>& networks, const PipeCourse& course, const Settings& settings) const;
+
+	/**
+	 * \brief Plays the whole course with all the birds at once, each of them steered by the controller
+	 * \param numberOfBirds Number of the birds
+	 * \param course Course the birds follow
+	 * \param settings Options of the evaluation
+	 * \param flaps Decides when every bird flaps, called only by the calling thread
+	 * \return Fitness score of every bird
+	 */
+	std::vector<float> play(std::size_t numberOfBirds, const PipeCourse& course, const Settings& settings, const Controller& flaps) const;
+
+	/**
+	 * \brief Combines the scores of a single unit
+	 * \param scores Scores from every course, reordered by the call
+	 * \param settings Options of the evaluation
+	 * \return Final fitness of the unit
+	 */
+	static float aggregate(std::vector<float>& scores, const Settings& settings);
+
+private:
+	/**
+	 * \brief Computes the key of everything besides the network that decides the score
+	 * \param courseSettings Settings of the course
+	 * \param settings Options of the evaluation
+	 * \return Hash of the course, the rules of the game and the length of the run
+	 */
+	std::uint64_t courseKeyOf(const PipeCourse::Settings& courseSettings, const Settings& settings) const;
+
+private:
+	/** Sizes and forces of the game */
+	HeadlessGeometry mGeometry;
+};
@@ -0,0 +1,208 @@
+#include "pch.h"
+#include "FitnessSurrogate.h"
+
+#include <cmath>
+#include <numeric>
+
+#include "FitnessCache.h"
+#include "Optimizer.h"
+
+namespace
+{
+	/**
+	 * \brief Ranks every value, the smallest one getting zero
+	 */
+	std::vector<float> ranksOf(const std::vector<float>& values)
+	{
+		std::vector<std::size_t> order(values.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&values](std::size_t a, std::size_t b) { return values[a] < values[b]; });
+
+		std::vector<float> ranks(values.size());
+		for (std::size_t rank = 0; rank < order.size(); ++rank)
+		{
+			ranks[order[rank]] = static_cast<float>(rank);
+		}
+		return ranks;
+	}
+
+	/**
+	 * \brief Computes the Spearman rank correlation of the two series of the same length
+	 */
+	float rankCorrelation(const std::vector<float>& a, const std::vector<float>& b)
+	{
+		const auto ranksOfA = ranksOf(a);
+		const auto ranksOfB = ranksOf(b);
+		const auto meanRank = (static_cast<float>(a.size()) - 1.f) / 2.f;
+		auto covariance = 0.f;
+		auto varianceOfA = 0.f;
+		auto varianceOfB = 0.f;
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			const auto deviationOfA = ranksOfA[i] - meanRank;
+			const auto deviationOfB = ranksOfB[i] - meanRank;
+			covariance += deviationOfA * deviationOfB;
+			varianceOfA += deviationOfA * deviationOfA;
+			varianceOfB += deviationOfB * deviationOfB;
+		}
+		return varianceOfA > 0.f && varianceOfB > 0.f ? covariance / std::sqrt(varianceOfA * varianceOfB) : 0.f;
+	}
+}
+
+FitnessSurrogate::FitnessSurrogate(Settings settings) :
+	mSettings(settings),
+	mDimension(0),
+	mNextSample(0),
+	mSkippedFitness(0.f),
+	mSavedSimulations(0),
+	mReport{}
+{
+	assert(mSettings.neighbours > 0 && mSettings.oversampling > 0 && mSettings.capacity > 0);
+	assert(mSettings.skippedQuantile >= 0.f && mSettings.skippedQuantile <= 1.f);
+}
+
+void FitnessSurrogate::learn(const std::vector<const fann*>& networks, const std::vector<float>& fitness)
+{
+	assert(networks.size() == fitness.size());
+
+	std::vector<float> predicted;
+	std::vector<float> played;
+	mReport = {};
+	mReport.skippedOffspring = static_cast<int>(mSkippedOffspring.size());
+	mReport.savedSimulations = mSavedSimulations;
+	for (std::size_t network = 0; network < networks.size(); ++network)
+	{
+		// The fitness of the skipped offspring is the prediction itself, so there is nothing to learn from it
+		const auto hash = FitnessCache::hashOf(networks[network]);
+		if (mSkippedOffspring.count(hash) != 0)
+		{
+			continue;
+		}
+
+		const auto genome = Optimizer::genomeOf(networks[network]);
+		if (mDimension == 0)
+		{
+			mDimension = genome.size();
+		}
+		assert(genome.size() == mDimension);
+
+		if (const auto prediction = mPredictions.find(hash); prediction != mPredictions.end())
+		{
+			predicted.push_back(prediction->second);
+			played.push_back(fitness[network]);
+			mReport.meanAbsoluteError += std::abs(prediction->second - fitness[network]);
+		}
+
+		// The model works as a ring of the most recently played networks
+		if (mFitness.size() < mSettings.capacity)
+		{
+			mGenomes.insert(mGenomes.end(), genome.cbegin(), genome.cend());
+			mFitness.push_back(fitness[network]);
+		}
+		else
+		{
+			std::copy(genome.cbegin(), genome.cend(), mGenomes.begin() + mNextSample * mDimension);
+			mFitness[mNextSample] = fitness[network];
+			mNextSample = (mNextSample + 1) % mSettings.capacity;
+		}
+	}
+	mPredictions.clear();
+	mSkippedOffspring.clear();
+	mSavedSimulations = 0;
+
+	mReport.comparedOffspring = static_cast<int>(predicted.size());
+	if (!predicted.empty())
+	{
+		mReport.meanAbsoluteError /= static_cast<float>(predicted.size());
+		mReport.rankCorrelation = rankCorrelation(predicted, played);
+	}
+
+	if (!mFitness.empty())
+	{
+		auto fitness = mFitness;
+		const auto quantile = fitness.begin() + static_cast<std::ptrdiff_t>(mSettings.skippedQuantile * (fitness.size() - 1));
+		std::nth_element(fitness.begin(), quantile, fitness.end());
+		mSkippedFitness = *quantile;
+	}
+}
+
+bool FitnessSurrogate::isReady() const
+{
+	return mFitness.size() >= std::max(mSettings.minimumSamples, static_cast<std::size_t>(mSettings.neighbours));
+}
+
+float FitnessSurrogate::predict(const fann* ann) const
+{
+	assert(isReady());
+
+	const auto genome = Optimizer::genomeOf(ann);
+	assert(genome.size() == mDimension);
+
+	std::vector<std::pair<float, std::size_t>> distances(mFitness.size());
+	for (std::size_t sample = 0; sample < mFitness.size(); ++sample)
+	{
+		const auto* sampleGenome = mGenomes.data() + sample * mDimension;
+		auto squaredDistance = 0.f;
+		for (std::size_t gene = 0; gene < mDimension; ++gene)
+		{
+			const auto difference = genome[gene] - sampleGenome[gene];
+			squaredDistance += difference * difference;
+		}
+		distances[sample] = { squaredDistance, sample };
+	}
+
+	const auto neighbours = std::min(static_cast<std::size_t>(mSettings.neighbours), distances.size());
+	std::nth_element(distances.begin(), distances.begin() + (neighbours - 1), distances.end());
+
+	// The nearer the played network, the more its fitness counts. An identical one nearly decides alone.
+	auto weightedFitness = 0.f;
+	auto sumOfWeights = 0.f;
+	for (std::size_t neighbour = 0; neighbour < neighbours; ++neighbour)
+	{
+		const auto [squaredDistance, sample] = distances[neighbour];
+		const auto weight = 1.f / (squaredDistance + 1e-6f);
+		weightedFitness += weight * mFitness[sample];
+		sumOfWeights += weight;
+	}
+	return weightedFitness / sumOfWeights;
+}
+
+void FitnessSurrogate::recordScreening(const fann* ann, float prediction, int rejectedOffspring)
+{
+	mPredictions[FitnessCache::hashOf(ann)] = prediction;
+	++mReport.keptOffspring;
+	mReport.rejectedOffspring += rejectedOffspring;
+}
+
+std::optional<float> FitnessSurrogate::skippedFitness(const fann* ann, int numberOfCourses)
+{
+	// Only the predictions that were checked against the played fitness are trusted
+	if (mReport.comparedOffspring == 0 || mReport.rankCorrelation < mSettings.minimumRankCorrelation)
+	{
+		return std::nullopt;
+	}
+
+	const auto hash = FitnessCache::hashOf(ann);
+	const auto prediction = mPredictions.find(hash);
+	if (prediction == mPredictions.end() || prediction->second >= mSkippedFitness)
+	{
+		return std::nullopt;
+	}
+
+	// Identical offspring would have been played only once anyway
+	if (mSkippedOffspring.insert(hash).second)
+	{
+		mSavedSimulations += numberOfCourses;
+	}
+	return prediction->second;
+}
+
+const FitnessSurrogate::Settings& FitnessSurrogate::settings() const
+{
+	return mSettings;
+}
+
+const FitnessSurrogate::Report& FitnessSurrogate::report() const
+{
+	return mReport;
+}
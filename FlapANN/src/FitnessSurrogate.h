@@ -0,0 +1,163 @@
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "fann/fann.h"
+
+/**
+ * \brief Cheap model predicting the fitness of a network from its genes, learned during the training.
+ *
+ * Most of the offspring die on the first pipe, yet each of them costs a whole simulated bird.
+ * The surrogate remembers the genomes of the recently played networks with their fitness, and
+ * predicts the fitness of a new network as the distance-weighted mean of its nearest neighbours.
+ * Several offspring are bred for every place in the population and only the most promising one
+ * is kept, while the rest are rejected without being simulated. The predictions are compared
+ * with the fitness the played offspring really get, so it is known how much the model can be trusted.
+ * Once the predictions rank the offspring well enough, the kept offspring predicted to be among
+ * the weakest are not played on the evaluation courses at all, and get the predicted fitness.
+ */
+class FitnessSurrogate
+{
+public:
+	/**
+	 * \brief Size of the model and strength of the screening
+	 */
+	struct Settings
+	{
+		/** Number of the nearest played networks a prediction is made from */
+		int neighbours = 8;
+
+		/** Number of the played networks remembered. The oldest ones are forgotten first. */
+		std::size_t capacity = 2048;
+
+		/** Number of offspring bred for every place in the population */
+		int oversampling = 4;
+
+		/** Number of the played networks needed before the offspring are screened */
+		std::size_t minimumSamples = 300;
+
+		/** Kept offspring predicted below this quantile of the remembered fitness are not played, from 0 to 1 */
+		float skippedQuantile = 0.25f;
+
+		/** Rank correlation of the last predictions needed before any offspring is left unplayed */
+		float minimumRankCorrelation = 0.5f;
+	};
+
+	/**
+	 * \brief Accuracy of the predictions and the savings of a single generation
+	 */
+	struct Report
+	{
+		/** Rank correlation between the predicted and the played fitness of the screened offspring, from -1 to 1 */
+		float rankCorrelation;
+
+		/** Mean difference between the predicted and the played fitness */
+		float meanAbsoluteError;
+
+		/** Number of the screened offspring whose fitness was compared with the prediction */
+		int comparedOffspring;
+
+		/** Number of the offspring that were kept, one for every screened place */
+		int keptOffspring;
+
+		/** Number of the offspring that were rejected without being played */
+		int rejectedOffspring;
+
+		/** Number of the kept offspring that were given their predicted fitness instead of being played */
+		int skippedOffspring;
+
+		/** Number of the runs not simulated thanks to the skipped offspring, one for every course */
+		int savedSimulations;
+	};
+
+	/**
+	 * \brief Creates the empty model
+	 * \param settings Size of the model and strength of the screening
+	 */
+	explicit FitnessSurrogate(Settings settings);
+
+	/**
+	 * \brief Remembers the played networks and compares them with their predictions, starting a new report
+	 * \param networks Networks that were played
+	 * \param fitness Final fitness of every network
+	 */
+	void learn(const std::vector<const fann*>& networks, const std::vector<float>& fitness);
+
+	/**
+	 * \brief Checks if enough networks were played for the predictions to be used
+	 * \return True if the offspring can be screened
+	 */
+	bool isReady() const;
+
+	/**
+	 * \brief Predicts the fitness of the network
+	 * \param ann Network of the same layout as the played ones
+	 * \return Predicted fitness
+	 */
+	float predict(const fann* ann) const;
+
+	/**
+	 * \brief Remembers the prediction of the offspring that was kept, so it can be compared once it is played
+	 * \param ann Kept offspring
+	 * \param prediction Predicted fitness of the offspring
+	 * \param rejectedOffspring Number of the offspring bred for the same place and rejected
+	 */
+	void recordScreening(const fann* ann, float prediction, int rejectedOffspring);
+
+	/**
+	 * \brief Decides if the kept offspring is weak enough to be given its prediction instead of being played
+	 *
+	 * The skipped offspring is counted in the next report, and neither learned from nor compared with its prediction.
+	 *
+	 * \param ann Offspring about to be played
+	 * \param numberOfCourses Number of the courses it would be played on
+	 * \return Predicted fitness if the offspring is not to be played
+	 */
+	std::optional<float> skippedFitness(const fann* ann, int numberOfCourses);
+
+	/**
+	 * \brief Returns the size of the model and the strength of the screening
+	 * \return Current settings
+	 */
+	const Settings& settings() const;
+
+	/**
+	 * \brief Returns the accuracy of the last predictions and the savings of the last breeding
+	 * \return Report of the last generation
+	 */
+	const Report& report() const;
+
+private:
+	/** Size of the model and strength of the screening */
+	Settings mSettings;
+
+	/** Number of the genes of a network. Zero until the first network is played. */
+	std::size_t mDimension;
+
+	/** Genomes of the remembered networks, one after another */
+	std::vector<float> mGenomes;
+
+	/** Fitness of the remembered networks */
+	std::vector<float> mFitness;
+
+	/** Place to which the next played network is written once the model is full */
+	std::size_t mNextSample;
+
+	/** Predicted fitness of the kept offspring by the hash of their genome, until they are played */
+	std::unordered_map<std::uint64_t, float> mPredictions;
+
+	/** Fitness below which the kept offspring are not played. Calculated again whenever the model learns. */
+	float mSkippedFitness;
+
+	/** Hashes of the genomes of the offspring that were not played since the model last learned */
+	std::unordered_set<std::uint64_t> mSkippedOffspring;
+
+	/** Number of the runs not simulated since the model last learned */
+	int mSavedSimulations;
+
+	/** Report of the last generation */
+	Report mReport;
+};
@@ -1,13 +1,15 @@
 #include "pch.h"
 #include "Game.h"
 
+#include <future>
 #include <imgui-sfml/imgui-SFML.h>
 #include <imgui/imgui.h>
 
-#include "nodes/objects/bird/Bird.h"
+#include "nodes/objects/bird/Birds.h"
 #include "nodes/objects/pipe/Pipe.h"
 #include "nodes/objects/background/Background.h"
 #include "nodes/objects/background/Ground.h"
+#include "Profiler.h"
 
 const sf::Time Game::TIME_PER_FRAME = sf::seconds(1.f / 60.f);
 const int Game::GAME_WIDTH = 144;
@@ -15,6 +17,8 @@ const int Game::GAME_HEIGHT = 256;
 const int Game::SCREEN_SCALE = 3;
 const int Game::IMGUI_SIDEMENU_WIDTH = GAME_WIDTH;
 float Game::TIME_SPEED_SCALAR = 1.f;
+const std::string Game::RESOURCES_DIRECTORY = "resources";
+const std::string Game::RESOURCE_ARCHIVE_PATH = "resources.pak";
 
 
 Game::Game():
@@ -45,6 +49,7 @@ void Game::run()
 	auto frameTimeElapsed = sf::Time::Zero;
 	while (mGameWindow.isOpen())
 	{
+		PROFILE_SCOPE(Frame);
 		if (TIME_SPEED_SCALAR >= 1.f)
 		{
 			frameTimeElapsed += clock.restart() * TIME_SPEED_SCALAR;
@@ -77,6 +82,7 @@ void Game::run()
 
 void Game::processEvents()
 {
+	PROFILE_SCOPE(ProcessEvents);
 	sf::Event event;
 	while (mGameWindow.pollEvent(event))
 	{
@@ -96,11 +102,13 @@ void Game::processEvents()
 
 void Game::update(const sf::Time& deltaTime)
 {
+	PROFILE_SCOPE(Update);
 	mGameManager->update(deltaTime);
 }
 
 void Game::updateImGui()
 {
+	PROFILE_SCOPE(UpdateImGui);
 	ImGui::SetNextWindowPos(ImVec2(GAME_WIDTH * SCREEN_SCALE, 0), ImGuiCond_Once);
 	ImGui::SetNextWindowSize(ImVec2(IMGUI_SIDEMENU_WIDTH * SCREEN_SCALE, GAME_HEIGHT * SCREEN_SCALE), ImGuiCond_Once);
 	ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.1f, 0.1f, 0.1f, 1.0f)); 
@@ -114,12 +122,19 @@ void Game::updateImGui()
 	ImGui::PushItemWidth(-textSize.x);
 	ImGui::SliderFloat(sliderText, &TIME_SPEED_SCALAR, 0.f, 5.f);
     mGameManager->updateImGui();
+
+	// Without the profiling the profiler is never created, as nothing is measured
+	if constexpr (Profiler::isEnabled())
+	{
+		Profiler::instance().updateImGui();
+	}
 	ImGui::End();
 	ImGui::PopStyleColor();
 }
 
 void Game::render()
 {
+	PROFILE_SCOPE(Render);
 	// before drawing anything clean
 	// the previous frame
 	mGameWindow.clear();
@@ -137,10 +152,29 @@ void Game::render()
 
 void Game::loadResources()
 {
-	mFonts.storeResource(Fonts_ID::ArialNarrow, "resources/fonts/arial_narrow.ttf");
+	// All the resources are read from a single archive mapped into the memory.
+	// It is created again from the loose files whenever any of them changes.
+	// If it is impossible to create it, then the loose files are used.
+	if (ResourceArchive::isOutdated(RESOURCE_ARCHIVE_PATH, RESOURCES_DIRECTORY))
+	{
+		ResourceArchive::create(RESOURCE_ARCHIVE_PATH, RESOURCES_DIRECTORY);
+	}
+	if (mResourceArchive.open(RESOURCE_ARCHIVE_PATH))
+	{
+		mFonts.useArchive(mResourceArchive);
+		mTextures.useArchive(mResourceArchive);
+	}
 
-	Bird::loadResources(mTextures);
+	mFonts.queueResource(Fonts_ID::ArialNarrow, "resources/fonts/arial_narrow.ttf");
+
+	Birds::loadResources(mTextures);
 	Pipe::loadResources(mTextures);
 	Background::loadResources(mTextures);
 	Ground::loadResources(mTextures);
+
+	// Fonts do not need the OpenGL context at all, so they
+	// are loaded at the same time as textures are decoded
+	auto fontsLoading = std::async(std::launch::async, [this]() { mFonts.loadQueuedResources(); });
+	mTextures.loadQueuedResources();
+	fontsLoading.get();
 }
@@ -75,9 +75,18 @@ private:
 	static const int GAME_HEIGHT; //!< Default game window height
 	static const int SCREEN_SCALE; //!< Window size multiplier
 	static const int IMGUI_SIDEMENU_WIDTH; //!< Width of the additional imgui sidemenu
+	static const std::string RESOURCES_DIRECTORY; //!< Directory containing all the loose resource files
+	static const std::string RESOURCE_ARCHIVE_PATH; //!< Archive packing all the resources into a single file
 
 	sf::RenderWindow mGameWindow; //!< The window to which the game image should be drawn.
 
+	/**
+	 * \brief Archive mapped into the memory from which all the resources are loaded.
+	 *
+	 * It must outlive the resources, as some of them (fonts) read it during the whole game.
+	 */
+	ResourceArchive mResourceArchive;
+
 	/**
 	 * \brief An object that holds loaded fonts that can be used inside the game.
 	 *
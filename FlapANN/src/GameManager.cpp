@@ -1,12 +1,15 @@
 #include "pch.h"
 #include "GameManager.h"
 
+#include <cfloat>
 #include <chrono>
+#include <numeric>
 #include <optional>
 #include <imgui/imgui.h>
 
+#include "AllocationTracker.h"
 #include "Game.h"
-#include "nodes/objects/bird/Bird.h"
+#include "Profiler.h"
 
 float normalize(float StartRange, float EndRange, float value)
 {
@@ -19,72 +22,150 @@ float normalize(float StartRange, float EndRange, float value)
 }
 
 
+const std::string GameManager::DECISION_LOG_PATH = "decisions.flaprec";
+const std::string GameManager::TELEMETRY_PATH = "telemetry.csv";
+const std::string GameManager::HALL_OF_FAME_PATH = "hall_of_fame.flaphof";
+
 GameManager::GameManager(const TextureManager& textureManager, sf::Vector2u screenSize, const FontManager& fonts) :
 	mBackground(textureManager),
 	mGround(textureManager),
 	mPipesGenerator(textureManager, fonts, screenSize),
+	mBirds(textureManager),
     mTextureManager(textureManager),
     mScreenSize(screenSize),
-    mGeneticAlgorithm(150, 5, {3, {8}, 1})
+    mGeneticAlgorithm(150, TOP_EVOLVING_UNITS, {FitnessEvaluator::NUMBER_OF_INPUTS, {8}, 1}),
+    mOptimizerBackend(Optimizer::Backend::Genetic),
+    mConvergenceMonitor(mGeneticAlgorithm.mutation(), mGeneticAlgorithm.populationSize()),
+    mDecisionRecorder(DECISION_LOG_PATH, 5),
+    mReplayedTick(0),
+    mRewindBuffer(4 * 1024 * 1024, 30, 8),
+    mTick(0),
+    mTelemetry(TELEMETRY_PATH),
+    mEvolutionMode(EvolutionMode::Generational),
+    mFitnessCache(std::make_shared<FitnessCache>(FITNESS_CACHE_CAPACITY)),
+    mIsTurbo(false),
+    mLastGenerationEnd(GenerationEnd::NotOver),
+    mTrainedCourse(mPipesGenerator.course()),
+    mWarmStartOnCourseChange(false),
+    mSavedHallOfFameRevision(0)
 {
 	mGround.setPosition(0, static_cast<float>(screenSize.y));
 	restartGame();
+
+	// Champions of the previous runs are the starting point of this one
+	mGeneticAlgorithm.loadHallOfFame(HALL_OF_FAME_PATH);
+	mSavedHallOfFameRevision = mGeneticAlgorithm.hallOfFame().revision();
 	mGeneticAlgorithm.createPopulation();
+	mDecisionRecorder.beginRun(mGeneticAlgorithm.currentGeneration(), mPipesGenerator.course(), mBirds.size());
+
+	// Without any champions the training would start from random networks, so they are pretrained first
+	if (mGeneticAlgorithm.hallOfFame().members().empty())
+	{
+		startPretraining();
+	}
 }
 
-bool GameManager::allBirdsAreDead()
+bool GameManager::allBirdsAreDead() const
 {
-    return std::all_of(mBirds.begin(), mBirds.end(), [this](const Bird& bird)
+    for (std::size_t bird = 0; bird < mBirds.size(); ++bird)
     {
-        return bird.isDead() && bird.getPosition().x < 0;
-    });
+        if (isInSimulation(bird) && !(mBirds.isDead(bird) && mBirds.position(bird).x < 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+GameManager::GenerationEnd GameManager::generationEnd() const
+{
+	const auto& population = mGeneticAlgorithm.population();
+	const auto bestUnit = std::max_element(population.cbegin(), population.cend(), [](const auto& a, const auto& b)
+	{
+		return a.fitness < b.fitness;
+	});
+	if (mTerminationRules.solvedFitness > 0.f && bestUnit != population.cend() && bestUnit->fitness >= mTerminationRules.solvedFitness)
+	{
+		return GenerationEnd::Solved;
+	}
+	if (allBirdsAreDead())
+	{
+		return GenerationEnd::AllBirdsGone;
+	}
+
+	if (!anyBirdIsAlive() && mTerminationRules.endWhenLastBirdDies)
+	{
+		return GenerationEnd::LastBirdDied;
+	}
+	if (mTerminationRules.maximumTicks > 0 && mTick >= mTerminationRules.maximumTicks)
+	{
+		return GenerationEnd::TimeLimit;
+	}
+	return GenerationEnd::NotOver;
 }
 
-void GameManager::killIfExceedsTopScreenBoundary(Bird& currentBird)
+bool GameManager::anyBirdIsAlive() const
 {
-    if (currentBird.getPosition().y < 0)
+	for (std::size_t bird = 0; bird < mBirds.size(); ++bird)
+	{
+		if (!mBirds.isDead(bird))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool GameManager::isInSimulation(std::size_t bird) const
+{
+	return !(mIsTurbo && mBirds.isDead(bird));
+}
+
+void GameManager::killIfExceedsTopScreenBoundary(std::size_t currentBird)
+{
+    if (mBirds.position(currentBird).y < 0)
     {
-		currentBird.kill();
+		mBirds.kill(currentBird);
     }
 }
 
-void GameManager::killIfExceedsBottomScreenBoundary(Bird& currentBird) const
+void GameManager::killIfExceedsBottomScreenBoundary(std::size_t currentBird)
 {
     static auto groundTop = mScreenSize.y - mTextureManager.getResourceReference(Textures_ID::Ground).getSize().y;
-    if (currentBird.getPosition().y + currentBird.getBirdBounds().height > groundTop)
+    if (mBirds.position(currentBird).y + mBirds.birdBounds(currentBird).height > groundTop)
     {
-        currentBird.kill();
-        currentBird.setPosition(currentBird.getPosition().x, groundTop);
-        currentBird.setVelocity({-50.f, 0});
+        mBirds.kill(currentBird);
+        mBirds.setPosition(currentBird, { mBirds.position(currentBird).x, static_cast<float>(groundTop) });
+        mBirds.setVelocity(currentBird, {-50.f, 0});
     }
 }
 
-void GameManager::killIfExceedsScreenBoundaries(Bird& currentBird)
+void GameManager::killIfExceedsScreenBoundaries(std::size_t currentBird)
 {
     killIfExceedsTopScreenBoundary(currentBird);
     killIfExceedsBottomScreenBoundary(currentBird);
 }
 
-float GameManager::horizontalNormalizedDistanceBetweenBirdAndPipeset(const Bird& currentBird, const PipeSet& nearestPipe) const
+float GameManager::horizontalNormalizedDistanceBetweenBirdAndPipeset(const sf::Vector2f& birdPosition, const PipeSet& nearestPipe) const
 {
-	auto xDelta = currentBird.getPosition().x - nearestPipe.position().x;
+	auto xDelta = birdPosition.x - nearestPipe.position().x;
 	float horizontalDistance = std::clamp(normalize(0, mScreenSize.x,std::abs(xDelta)), 0.f, 1.f);
 	horizontalDistance = (xDelta < 0) ? horizontalDistance : -horizontalDistance;
 	return horizontalDistance;
 }
 
-float GameManager::verticalNormalizedDistanceBetweenBirdAndPipeset(const Bird& currentBird, const PipeSet& nearestPipe) const
+float GameManager::verticalNormalizedDistanceBetweenBirdAndPipeset(const sf::Vector2f& birdPosition, const PipeSet& nearestPipe) const
 {
-	auto yDelta = currentBird.getPosition().y - nearestPipe.position().y;
+	auto yDelta = birdPosition.y - nearestPipe.position().y;
 	auto verticalDistance = std::clamp(normalize(0, mScreenSize.y, std::abs(yDelta)), 0.f, 1.f);
 	verticalDistance = (yDelta < 0) ? verticalDistance : -verticalDistance;
 	return verticalDistance;
 }
 
-float GameManager::normalizedVerticalBirdPosition(const Bird& currentBird) const
+float GameManager::normalizedVerticalBirdPosition(const sf::Vector2f& birdPosition) const
 {
 	return std::clamp(normalize(0, mScreenSize.y,
-	                            std::abs(currentBird.getPosition().y)), 0.f, 1.f);
+	                            std::abs(birdPosition.y)), 0.f, 1.f);
 }
 
 float GameManager::distance(float x, float y)
@@ -92,97 +173,869 @@ float GameManager::distance(float x, float y)
 	return std::sqrtf(std::powf(x, 2) + std::powf(y, 2));
 }
 
-float GameManager::calculateBirdFitnessScore(const Bird& currentBird, const float& distanceToGap)
+float GameManager::calculateBirdFitnessScore(float birdScore, const float& distanceToGap)
 {
-	return currentBird.fitnessScore() - distanceToGap / 10.f;
+	return birdScore - distanceToGap / 10.f;
 }
 
-std::pair<float, float> GameManager::normalizedDistancesBetweenBirdAndPipeset(const Bird& currentBird, const PipeSet& nearestPipeset) const
+std::pair<float, float> GameManager::normalizedDistancesBetweenBirdAndPipeset(const sf::Vector2f& birdPosition, const PipeSet& nearestPipeset) const
 {
-	auto horizontalDistance = horizontalNormalizedDistanceBetweenBirdAndPipeset(currentBird, nearestPipeset);
-	auto verticalDistance = verticalNormalizedDistanceBetweenBirdAndPipeset(currentBird, nearestPipeset);
+	auto horizontalDistance = horizontalNormalizedDistanceBetweenBirdAndPipeset(birdPosition, nearestPipeset);
+	auto verticalDistance = verticalNormalizedDistanceBetweenBirdAndPipeset(birdPosition, nearestPipeset);
 
 	return { horizontalDistance, verticalDistance };
 }
 
 void GameManager::updateANN()
 {
+	PROFILE_SCOPE(UpdateANN);
 	if(mBirds.size() != mGeneticAlgorithm.population().size())
 	{
 		throw std::runtime_error("Number of birds is not equal to number of 'brains'");
 	}
 
-	auto birdNumber = 0;
-    for(auto& currentBird : mBirds)
+    for(std::size_t birdNumber = 0; birdNumber < mBirds.size(); ++birdNumber)
     {
-        const auto& nearestPipe = *mPipesGenerator.sortedByDistancePipesetsInfrontOfPoint(currentBird.getPosition()).front();
-        const auto& [horizontalDistance, verticalDistance] = normalizedDistancesBetweenBirdAndPipeset(currentBird, nearestPipe);
-        const auto& birdPositionY = normalizedVerticalBirdPosition(currentBird);
+        auto& decision = mDecisions[birdNumber];
+        if(mBirds.isDead(birdNumber))
+        {
+            // The fitness of the dead bird stays as it was when it died, so it is final
+            // as soon as the last bird dies, and the next population can be bred from then on
+            decision.wasAlive = false;
+            continue;
+        }
+
+        const auto birdPosition = mBirds.position(birdNumber);
+        const auto& nearestPipe = *mPipesGenerator.nearestPipeSetInFrontOfPoint(birdPosition);
+        const auto& [horizontalDistance, verticalDistance] = normalizedDistancesBetweenBirdAndPipeset(birdPosition, nearestPipe);
+        const auto& birdPositionY = normalizedVerticalBirdPosition(birdPosition);
 		const auto& distanceToGap = distance(horizontalDistance, verticalDistance);
 
-		auto& currentGenome = mGeneticAlgorithm.at(birdNumber);
-        currentGenome.fitness = calculateBirdFitnessScore(currentBird, distanceToGap);
-        currentGenome.performOnPredictedOutput({ horizontalDistance, verticalDistance, birdPositionY }, [&currentBird](fann_type* output)
+		auto& currentGenome = mGeneticAlgorithm.at(static_cast<int>(birdNumber));
+        currentGenome.fitness = calculateBirdFitnessScore(mBirds.fitnessScore(birdNumber), distanceToGap);
+        decision.wasAlive = true;
+        currentGenome.performOnPredictedOutput({ horizontalDistance, verticalDistance, birdPositionY }, [this, birdNumber, &decision](fann_type* output)
         {
-            if(output[0] > 0.5f)
+            decision.flapped = output[0] > 0.5f;
+            if(decision.flapped)
             {
-                currentBird.flap();
+                mBirds.flap(birdNumber);
             }
         });
-        ++birdNumber;
     }
 }
 
 void GameManager::updateBirds(const sf::Time& deltaTime)
 {
-    for (auto currentBird = mBirds.begin(), birdEnd = mBirds.end(); currentBird != birdEnd; ++currentBird)
+	PROFILE_SCOPE(UpdateBirds);
+    mBirds.update(deltaTime, !mIsTurbo);
+    for (std::size_t currentBird = 0; currentBird < mBirds.size(); ++currentBird)
     {
-        currentBird->update(deltaTime);
-        killIfExceedsScreenBoundaries(*currentBird);
+        if (isInSimulation(currentBird))
+        {
+            killIfExceedsScreenBoundaries(currentBird);
+        }
     }
 }
 
-void GameManager::update(const sf::Time& deltaTime)
+void GameManager::updateWorld(const sf::Time& deltaTime)
 {
-	mBackground.update(deltaTime);
-	mGround.update(deltaTime);
-	mPipesGenerator.update(deltaTime);
+	PROFILE_SCOPE(UpdateWorld);
+	// Nothing is pinned to the objects of the world, so each kind of them is updated
+	// on its own, without walking through the scene hierarchy
+	mBackground.updateThis(deltaTime);
+	mGround.updateThis(deltaTime);
+	mPipesGenerator.updateThis(deltaTime);
 
 	updateBirds(deltaTime);
-	updateANN();
+}
+
+void GameManager::simulateTick(const sf::Time& deltaTime)
+{
+	// The birds are given new genomes during the steady-state evolution,
+	// so neither the keyframes nor the decisions would let it be played again
+	const auto isGenerational = mEvolutionMode == EvolutionMode::Generational;
+	if (isGenerational && mRewindBuffer.isKeyframeDue(mTick, deltaTime))
+	{
+		mRewindBuffer.storeKeyframe(worldState(deltaTime));
+	}
+
+	if (isGenerational)
+	{
+		mDecisionRecorder.recordTick(deltaTime);
+	}
+	{
+		// Keyframes and the decision log grow now and then, but the simulation itself never allocates
+		EXPECT_NO_ALLOCATIONS();
+		updateWorld(deltaTime);
+		updateANN();
+		handleCollision();
+
+		std::uint32_t aliveBirds = 0;
+		for (std::size_t bird = 0; bird < mBirds.size(); ++bird)
+		{
+			aliveBirds += !mBirds.isDead(bird);
+		}
+		mTelemetry.recordTick(mTick, aliveBirds);
+	}
+	if (isGenerational)
+	{
+		recordDecisions();
+	}
+	++mTick;
+}
+
+void GameManager::recordDecisions()
+{
+	for (std::size_t birdNumber = 0; birdNumber < mDecisions.size(); ++birdNumber)
+	{
+		const auto& decision = mDecisions[birdNumber];
+		if (decision.wasAlive)
+		{
+			mDecisionRecorder.recordDecision(birdNumber, decision.flapped);
+		}
+	}
+}
+
+WorldState GameManager::worldState(const sf::Time& deltaTime) const
+{
+	WorldState state{ mTick, deltaTime, {}, mPipesGenerator.state(), mBackground.getPosition(), mGround.getPosition() };
+	for (std::size_t bird = 0; bird < mBirds.size(); ++bird)
+	{
+		state.birds.push(mBirds.state(bird));
+	}
+	return state;
+}
+
+void GameManager::restoreWorldState(const WorldState& state)
+{
+	assert(state.birds.size() == mBirds.size());
+
+	mTick = state.tick;
+	mPipesGenerator.restoreState(state.pipes);
+	mBackground.setPosition(state.backgroundPosition);
+	mGround.setPosition(state.groundPosition);
+	for (std::size_t birdNumber = 0; birdNumber < mBirds.size(); ++birdNumber)
+	{
+		mBirds.restoreState(birdNumber, state.birds.at(birdNumber));
+	}
+}
+
+void GameManager::seek(std::uint32_t tick)
+{
+	assert(tick <= mTick);
+
+	const auto keyframe = mRewindBuffer.keyframeBefore(tick);
+	if (!keyframe)
+	{
+		return;
+	}
+
+	// Birds that come back to life change their fitness, so the population bred from it is useless
+	mGeneticAlgorithm.discardEvolving();
+
+	// Everything after the keyframe is going to be simulated again, and it is stored once more on the way
+	restoreWorldState(*keyframe);
+	mRewindBuffer.discardAfter(keyframe->tick);
+	mDecisionRecorder.rewindTo(keyframe->tick);
+
+	// All the ticks between two keyframes have the same length
+	while (mTick < tick)
+	{
+		simulateTick(keyframe->deltaTime);
+	}
+}
+
+void GameManager::update(const sf::Time& deltaTime)
+{
+	if (mReplayedRun)
+	{
+		updateReplay(deltaTime);
+		return;
+	}
+
+	// The benchmark measures the time of its backends, so the training does not compete with it
+	if (mOptimizerBenchmark.isRunning())
+	{
+		return;
+	}
+
+	// Networks pretrained in the background replace the population, so the training is held until they are
+	// ready. Otherwise a generation would be played partly by one population and scored for the other.
+	if (mTeacherPretrainer.isRunning())
+	{
+		const auto pretrainedUnits = mTeacherPretrainer.takeNetworks();
+		if (!pretrainedUnits)
+		{
+			return;
+		}
+		if (!pretrainedUnits->empty())
+		{
+			warmStart(*pretrainedUnits);
+		}
+	}
+
+	simulateTick(deltaTime);
+	if (mEvolutionMode == EvolutionMode::SteadyState)
+	{
+		const auto generation = mGeneticAlgorithm.currentGeneration();
+		replaceDeadBirds();
+		if (mGeneticAlgorithm.currentGeneration() != generation)
+		{
+			warmStartIfCourseChanged();
+		}
+		return;
+	}
+
+	// The fitness is final once the last bird dies, so the next population is bred
+	// in the background while the dead birds are still falling off the screen
+	if (!mGeneticAlgorithm.isEvolving() && !anyBirdIsAlive())
+	{
+		startEvolving();
+	}
+
+	if (const auto end = generationEnd(); end != GenerationEnd::NotOver)
+	{
+		mLastGenerationEnd = end;
+		if (end == GenerationEnd::Solved && !mSolvedGeneration)
+		{
+			mSolvedGeneration = mGeneticAlgorithm.currentGeneration();
+		}
+		finishGeneration();
+		warmStartIfCourseChanged();
+	}
+}
+
+void GameManager::replaceDeadBirds()
+{
+	const auto spawnX = mScreenSize.x / 4.f;
+	for (std::size_t birdNumber = 0; birdNumber < mBirds.size(); ++birdNumber)
+	{
+		if (!mBirds.isDead(birdNumber))
+		{
+			continue;
+		}
+
+		const auto generation = mGeneticAlgorithm.currentGeneration();
+		mSteadyStateFitness.push_back(mGeneticAlgorithm.at(static_cast<int>(birdNumber)).fitness);
+		mGeneticAlgorithm.replaceWithOffspring(static_cast<int>(birdNumber));
+		if (mGeneticAlgorithm.currentGeneration() != generation)
+		{
+			GenerationStatistics statistics{};
+			statistics.generation = static_cast<std::uint32_t>(generation);
+			statistics.ticks = mTick;
+			summarizeFitness(std::move(mSteadyStateFitness), statistics);
+			mTelemetry.recordGeneration(statistics);
+			mSteadyStateFitness.clear();
+			saveHallOfFame();
+		}
+
+		// The new bird starts in the middle of the nearest gap, so it is not killed right away
+		const auto* nearestPipeSet = mPipesGenerator.nearestPipeSetInFrontOfPoint({ spawnX, 0.f });
+		const auto spawnY = nearestPipeSet ? nearestPipeSet->position().y : mScreenSize.y / 2.f;
+		mBirds.restoreState(birdNumber, { { spawnX, spawnY }, {}, 0.f, 0.f, false });
+	}
+}
+
+void GameManager::setEvolutionMode(EvolutionMode mode)
+{
+	if (mode == mEvolutionMode)
+	{
+		return;
+	}
+
+	mEvolutionMode = mode;
+	mGeneticAlgorithm.discardEvolving();
+	mSteadyStateFitness.clear();
+	restartGame();
+	mDecisionRecorder.beginRun(mGeneticAlgorithm.currentGeneration(), mPipesGenerator.course(), mBirds.size());
+}
+
+void GameManager::warmStart(const std::vector<GeneticAlgorithm::Unit>& pretrainedUnits)
+{
+	mGeneticAlgorithm.discardEvolving();
+	mSteadyStateFitness.clear();
+	const auto adaptation = mConvergenceMonitor.reset();
+	mGeneticAlgorithm.setMutation(adaptation.mutation);
+	mGeneticAlgorithm.setPopulationSize(adaptation.populationSize);
+	mGeneticAlgorithm.setOptimizer(createOptimizer());
+	if (pretrainedUnits.empty())
+	{
+		mGeneticAlgorithm.createPopulation();
+	}
+	else
+	{
+		mGeneticAlgorithm.createPopulation(pretrainedUnits);
+	}
+	restartGame();
+	mDecisionRecorder.beginRun(mGeneticAlgorithm.currentGeneration(), mPipesGenerator.course(), mBirds.size());
+}
+
+void GameManager::startPretraining()
+{
+	mTeacherPretrainer.start(headlessGeometry(), mPipesGenerator.course()->settings(), mGeneticAlgorithm.layers());
+}
+
+void GameManager::updateImGuiPretraining()
+{
+	if (!ImGui::CollapsingHeader("Pretraining"))
+	{
+		return;
+	}
+
+	if (!mTeacherPretrainer.isRunning() && !mReplayedRun && ImGui::Button("Pretrain from the teacher"))
+	{
+		startPretraining();
+	}
+	mTeacherPretrainer.updateImGui();
+}
+
+void GameManager::saveHallOfFame()
+{
+	const auto revision = mGeneticAlgorithm.hallOfFame().revision();
+	if (revision != mSavedHallOfFameRevision && mGeneticAlgorithm.saveHallOfFame(HALL_OF_FAME_PATH))
+	{
+		mSavedHallOfFameRevision = revision;
+	}
+}
+
+void GameManager::updateImGuiHallOfFame()
+{
+	if (!ImGui::CollapsingHeader("Hall of fame"))
+	{
+		return;
+	}
+
+	ImGui::Checkbox("Warm-start when the pipes change", &mWarmStartOnCourseChange);
+	ImGui::SameLine();
+	ImGui::TextDisabled("(at the end of the generation)");
+	if (!mReplayedRun && ImGui::Button("Warm-start now"))
+	{
+		warmStart();
+	}
+
+	const auto& members = mGeneticAlgorithm.hallOfFame().members();
+	ImGui::Text("Archived networks: %zu, saved to %s", members.size(), HALL_OF_FAME_PATH.c_str());
+	constexpr auto tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+	if (!members.empty() && ImGui::BeginTable("Members", 3, tableFlags))
+	{
+		ImGui::TableSetupColumn("Place");
+		ImGui::TableSetupColumn("Fitness");
+		ImGui::TableSetupColumn("Generation");
+		ImGui::TableHeadersRow();
+		for (std::size_t place = 0; place < members.size(); ++place)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%zu", place + 1);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", members[place].fitness);
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", members[place].generation);
+		}
+		ImGui::EndTable();
+	}
+
+	if (!members.empty() && !mChampionPruner.isRunning() && ImGui::Button("Prune the champion"))
+	{
+		const auto& layers = mGeneticAlgorithm.layers();
+		auto* ann = fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data());
+		Optimizer::applyGenome(members.front().genome, ann);
+		mChampionPruner.start(GeneticAlgorithm::Unit(ann, 0, 0), headlessGeometry(), mPipesGenerator.course()->settings());
+	}
+	mChampionPruner.updateImGui();
+
+	if (!members.empty() && ImGui::Button("Export the champion"))
+	{
+		const auto& layers = mGeneticAlgorithm.layers();
+		auto* ann = fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data());
+		Optimizer::applyGenome(members.front().genome, ann);
+		mChampionExporter.exportChampion(GeneticAlgorithm::Unit(ann, 0, 0));
+	}
+	mChampionExporter.updateImGui();
+}
+
+void GameManager::updateImGuiEvolution()
+{
+	if (!ImGui::CollapsingHeader("Evolution"))
+	{
+		return;
+	}
+
+	auto mode = static_cast<int>(mEvolutionMode);
+	ImGui::RadioButton("Generational", &mode, static_cast<int>(EvolutionMode::Generational));
+	ImGui::SameLine();
+	ImGui::RadioButton("Steady-state", &mode, static_cast<int>(EvolutionMode::SteadyState));
+	setEvolutionMode(static_cast<EvolutionMode>(mode));
+
+	if (mEvolutionMode == EvolutionMode::SteadyState)
+	{
+		const auto& eliteArchive = mGeneticAlgorithm.eliteArchive();
+		ImGui::Text("Best archived fitness: %.2f", eliteArchive.empty() ? 0.f : eliteArchive.front().fitness);
+		return;
+	}
+
+	auto isScreened = mGeneticAlgorithm.surrogate() != nullptr;
+	if (ImGui::Checkbox("Screen offspring with a surrogate model", &isScreened))
+	{
+		mGeneticAlgorithm.discardEvolving();
+		mGeneticAlgorithm.setSurrogate(isScreened ? std::make_unique<FitnessSurrogate>(FitnessSurrogate::Settings{}) : nullptr);
+	}
+	if (const auto* surrogate = mGeneticAlgorithm.surrogate(); surrogate && !mGeneticAlgorithm.isEvolving())
+	{
+		const auto& report = surrogate->report();
+		ImGui::Text("Rank correlation: %.2f, mean error: %.2f", report.rankCorrelation, report.meanAbsoluteError);
+		ImGui::Text("Kept offspring: %d, rejected without playing: %d", report.keptOffspring, report.rejectedOffspring);
+		ImGui::Text("Skipped offspring: %d, simulations saved: %d", report.skippedOffspring, report.savedSimulations);
+		if (mEvaluationSettings.numberOfSeeds <= 1)
+		{
+			ImGui::TextWrapped("Offspring are skipped only when the generation is scored on several courses.");
+		}
+		if (!surrogate->isReady())
+		{
+			ImGui::TextUnformatted("Learning from the played birds before screening...");
+		}
+	}
+}
+
+void GameManager::startEvolving()
+{
+	if (mEvaluationSettings.numberOfSeeds <= 1)
+	{
+		mGeneticAlgorithm.startEvolving();
+		return;
+	}
+
+	// Everything the evaluation needs is copied, so the game can go on while the courses are played
+	mGeneticAlgorithm.startEvolving([evaluator = FitnessEvaluator(headlessGeometry()),
+	                                 courseSettings = mPipesGenerator.course()->settings(),
+	                                 settings = mEvaluationSettings,
+	                                 cache = mFitnessCache](std::vector<GeneticAlgorithm::Unit>& population, FitnessSurrogate* surrogate)
+	{
+		evaluator.evaluate(population, courseSettings, settings, cache.get(), surrogate);
+	});
+}
+
+void GameManager::setOptimizerBackend(Optimizer::Backend backend)
+{
+	if (backend == mOptimizerBackend)
+	{
+		return;
+	}
+
+	mOptimizerBackend = backend;
+	mGeneticAlgorithm.discardEvolving();
+	mGeneticAlgorithm.setOptimizer(createOptimizer());
+}
+
+std::unique_ptr<Optimizer> GameManager::createOptimizer() const
+{
+	if (mOptimizerBackend == Optimizer::Backend::Genetic)
+	{
+		return nullptr;
+	}
+	return Optimizer::create(mOptimizerBackend, mGeneticAlgorithm.layers(), TOP_EVOLVING_UNITS);
+}
+
+void GameManager::updateImGuiOptimizer()
+{
+	if (!ImGui::CollapsingHeader("Optimizer"))
+	{
+		return;
+	}
+
+	auto backend = static_cast<int>(mOptimizerBackend);
+	ImGui::RadioButton("Genetic", &backend, static_cast<int>(Optimizer::Backend::Genetic));
+	ImGui::SameLine();
+	ImGui::RadioButton("CMA-ES", &backend, static_cast<int>(Optimizer::Backend::CmaEs));
+	ImGui::SameLine();
+	ImGui::RadioButton("Mirrored ES", &backend, static_cast<int>(Optimizer::Backend::MirroredEs));
+	setOptimizerBackend(static_cast<Optimizer::Backend>(backend));
+	if (mEvolutionMode == EvolutionMode::SteadyState && mOptimizerBackend != Optimizer::Backend::Genetic)
+	{
+		ImGui::TextWrapped("The steady-state evolution always breeds from the elite archive.");
+	}
+
+	if (!mOptimizerBenchmark.isRunning() && ImGui::Button("Run benchmark"))
+	{
+		mOptimizerBenchmark.start(headlessGeometry(), mPipesGenerator.course()->settings(),
+		                          mGeneticAlgorithm.layers(), TOP_EVOLVING_UNITS);
+	}
+	mOptimizerBenchmark.updateImGui();
+}
+
+HeadlessGeometry GameManager::headlessGeometry() const
+{
+	auto birdHitbox = mBirds.birdBounds(0);
+	birdHitbox.left -= mBirds.position(0).x;
+	birdHitbox.top -= mBirds.position(0).y;
+
+	const auto& pipeTextureRect = mTextureManager.getResourceRect(Textures_ID::Pipe_Green);
+	const auto groundHeight = mTextureManager.getResourceReference(Textures_ID::Ground).getSize().y;
+	return {
+		sf::Vector2f(mScreenSize),
+		{ mScreenSize.x / 4.f, mScreenSize.y / 2.f },
+		birdHitbox,
+		{ static_cast<float>(pipeTextureRect.width), static_cast<float>(pipeTextureRect.height) },
+		static_cast<float>(mScreenSize.y - groundHeight),
+		Birds::jumpStrength(),
+		Birds::gravity(),
+		Pipe::pipeSpeed()
+	};
+}
+
+void GameManager::updateImGuiEvaluation()
+{
+	if (!ImGui::CollapsingHeader("Evaluation"))
+	{
+		return;
+	}
+
+	ImGui::SliderInt("Courses per generation", &mEvaluationSettings.numberOfSeeds, 1, 8);
+	if (mEvaluationSettings.numberOfSeeds <= 1)
+	{
+		ImGui::TextWrapped("The fitness comes from the run shown on the screen.");
+		return;
+	}
+
+	const char* aggregations[] = { "Mean", "Minimum", "Quantile" };
+	auto aggregation = static_cast<int>(mEvaluationSettings.aggregation);
+	if (ImGui::Combo("Aggregation", &aggregation, aggregations, IM_ARRAYSIZE(aggregations)))
+	{
+		mEvaluationSettings.aggregation = static_cast<FitnessEvaluator::Aggregation>(aggregation);
+	}
+	if (mEvaluationSettings.aggregation == FitnessEvaluator::Aggregation::Quantile)
+	{
+		ImGui::SliderFloat("Quantile", &mEvaluationSettings.quantile, 0.f, 1.f, "%.2f");
+	}
+	ImGui::TextWrapped("Every generation is scored without graphics on %d courses, one thread each. "
+	                   "The run on the screen only shows the population.", mEvaluationSettings.numberOfSeeds);
+}
+
+void GameManager::summarizeFitness(std::vector<float> fitness, GenerationStatistics& statistics)
+{
+	if (fitness.empty())
+	{
+		return;
+	}
+
+	statistics.bestFitness = *std::max_element(fitness.cbegin(), fitness.cend());
+	statistics.meanFitness = std::accumulate(fitness.cbegin(), fitness.cend(), 0.f) / static_cast<float>(fitness.size());
+	const auto median = fitness.begin() + fitness.size() / 2;
+	std::nth_element(fitness.begin(), median, fitness.end());
+	statistics.medianFitness = *median;
+}
+
+void GameManager::finishGeneration()
+{
+	std::vector<float> fitness;
+	for (std::size_t birdNumber = 0; birdNumber < mBirds.size(); ++birdNumber)
+	{
+		fitness.push_back(mGeneticAlgorithm.at(static_cast<int>(birdNumber)).fitness);
+	}
+	mDecisionRecorder.finishRun(mPipesGenerator.course(), fitness);
+
+	GenerationStatistics statistics{};
+	statistics.generation = static_cast<std::uint32_t>(mGeneticAlgorithm.currentGeneration());
+	statistics.ticks = mTick;
+
+	// The birds are reset while the next population is still being bred
+	if (!mGeneticAlgorithm.isEvolving())
+	{
+		startEvolving();
+	}
+	restartGame();
+
+	// Only the time the game had to wait for the next population is measured
+	const auto evolveStart = std::chrono::steady_clock::now();
+	{
+		PROFILE_SCOPE(Evolve);
+		mGeneticAlgorithm.finishEvolving();
+	}
+
+	// A resized population needs a different number of birds
+	if (mBirds.size() != mGeneticAlgorithm.population().size())
+	{
+		restartGame();
+	}
+	const std::chrono::duration<float, std::milli> evolveTime = std::chrono::steady_clock::now() - evolveStart;
+	statistics.evolveMilliseconds = evolveTime.count();
+
+	// The worker is done, so the cache can be read again
+	const auto cacheStatistics = mFitnessCache->takeStatistics();
+	statistics.cacheHitRate = cacheStatistics.lookups == 0 ? 0.f : static_cast<float>(cacheStatistics.hits) / cacheStatistics.lookups;
+
+	// The population could have been scored again on several courses, so the fitness it was bred by is reported
+	summarizeFitness(mGeneticAlgorithm.parentsFitness(), statistics);
+	const auto& diversity = mPopulationDiversity.measure(mGeneticAlgorithm.population());
+	statistics.diversity = diversity.meanWeightDeviation;
+	statistics.meanPairwiseDistance = diversity.meanPairwiseDistance;
+	statistics.centroidSpread = diversity.centroidSpread;
+	if (const auto* surrogate = mGeneticAlgorithm.surrogate())
+	{
+		statistics.surrogateRankCorrelation = surrogate->report().rankCorrelation;
+		statistics.surrogateRejectedOffspring = static_cast<std::uint32_t>(surrogate->report().rejectedOffspring);
+		statistics.surrogateSavedSimulations = static_cast<std::uint32_t>(surrogate->report().savedSimulations);
+	}
+
+	saveHallOfFame();
+
+	// The adaptation is used starting with the population bred at the end of this generation
+	const auto adaptation = mConvergenceMonitor.update(mGeneticAlgorithm.parentsFitness(), statistics.diversity);
+	mGeneticAlgorithm.setMutation(adaptation.mutation);
+	mGeneticAlgorithm.setPopulationSize(adaptation.populationSize);
+	mTelemetry.recordGeneration(statistics);
+
+	mDecisionRecorder.beginRun(mGeneticAlgorithm.currentGeneration(), mPipesGenerator.course(), mBirds.size());
+}
+
+void GameManager::warmStartIfCourseChanged()
+{
+	// Fitness earned on the previous pipes says little about the new ones
+	if (mPipesGenerator.course() == mTrainedCourse)
+	{
+		return;
+	}
+
+	mTrainedCourse = mPipesGenerator.course();
+	if (mWarmStartOnCourseChange)
+	{
+		warmStart();
+	}
+}
+
+void GameManager::startReplay(const RecordedRun& run)
+{
+	if (!mReplayedRun)
+	{
+		mTrainingCourse = mPipesGenerator.course();
+	}
+	mGeneticAlgorithm.discardEvolving();
+	mReplayedRun = run;
+	mReplayedTick = 0;
+	mReplayClock = sf::Time::Zero;
+
+	mPipesGenerator.useCourse(std::make_shared<const PipeCourse>(run.courseSettings));
+	mPipesGenerator.restart();
+	mBirds.clear();
+	const Birds::State startState{ {(mScreenSize.x / 4.f), (mScreenSize.y / 2.f)}, {}, 0.f, 0.f, false };
+	for (const auto& recordedBird : run.birds)
+	{
+		mBirds.add(mBirdTextures[recordedBird.index % mBirdTextures.size()], startState);
+	}
+}
+
+void GameManager::stopReplay()
+{
+	mReplayedRun.reset();
+	mPipesGenerator.useCourse(std::move(mTrainingCourse));
+	restartGame();
+	mDecisionRecorder.beginRun(mGeneticAlgorithm.currentGeneration(), mPipesGenerator.course(), mBirds.size());
+}
+
+void GameManager::updateReplay(const sf::Time& deltaTime)
+{
+	// The stop of the replay at the end of the run resets it, which ends the loop as well
+	mReplayClock += deltaTime;
+	while (mReplayedRun && mReplayClock >= mReplayedRun->timeStepAt(mReplayedTick))
+	{
+		mReplayClock -= mReplayedRun->timeStepAt(mReplayedTick);
+		replayTick();
+	}
+}
+
+void GameManager::replayTick()
+{
+	// The recorded length of the tick is used, as the run depends on it
+	updateWorld(mReplayedRun->timeStepAt(mReplayedTick));
+
+	// Exactly as the networks did, the decision is made after the birds were updated
+	for (std::size_t birdNumber = 0; birdNumber < mBirds.size(); ++birdNumber)
+	{
+		if (mReplayedRun->birds[birdNumber].hasFlapped(mReplayedTick))
+		{
+			mBirds.flap(birdNumber);
+		}
+	}
 	handleCollision();
+	++mReplayedTick;
+
 	if (allBirdsAreDead())
 	{
-		restartGame();
-		mGeneticAlgorithm.evolve();
+		stopReplay();
+	}
+}
+
+void GameManager::updateImGuiReplays()
+{
+	if (!ImGui::CollapsingHeader("Replays"))
+	{
+		return;
+	}
+
+	if (mReplayedRun)
+	{
+		ImGui::Text("Replaying generation %u", mReplayedRun->generation);
+		if (ImGui::Button("Stop replay"))
+		{
+			stopReplay();
+		}
+	}
+
+	if (ImGui::Button("Load recorded runs"))
+	{
+		mRecordedRuns = DecisionRecorder::readRuns(mDecisionRecorder.logPath());
+	}
+
+	const RecordedRun* selectedRun = nullptr;
+	for (const auto& run : mRecordedRuns)
+	{
+		const auto bestFitness = run.birds.empty() ? 0.f : run.birds.front().fitness;
+		const auto label = "Generation " + std::to_string(run.generation) + " (best: " + std::to_string(bestFitness) + ")";
+		if (ImGui::Selectable(label.c_str()))
+		{
+			selectedRun = &run;
+		}
+	}
+	if (selectedRun)
+	{
+		startReplay(*selectedRun);
+	}
+}
+
+void GameManager::updateImGuiRewind()
+{
+	if (!ImGui::CollapsingHeader("Rewind"))
+	{
+		return;
+	}
+
+	if (mReplayedRun || mRewindBuffer.empty())
+	{
+		ImGui::Text("Available only during the generational training");
+		return;
+	}
+
+	const static auto& sliderText = "Timeline";
+	const static auto& textSize = ImGui::CalcTextSize(sliderText);
+	auto tick = static_cast<int>(mTick);
+
+	ImGui::PushItemWidth(-textSize.x);
+	if (ImGui::SliderInt(sliderText, &tick, static_cast<int>(mRewindBuffer.oldestTick()), static_cast<int>(mTick)))
+	{
+		seek(static_cast<std::uint32_t>(tick));
+	}
+	ImGui::Text("Rewind memory: %zu KB, birds compressed %.2fx", mRewindBuffer.memoryUsage() / 1024, mRewindBuffer.compressionRatio());
+}
+
+void GameManager::updateImGuiStatistics()
+{
+	if (!ImGui::CollapsingHeader("Statistics"))
+	{
+		return;
+	}
+
+	const auto plots = mTelemetry.plots();
+	const auto plotSize = ImVec2(0.f, 60.f);
+	auto plot = [&plotSize](const char* label, const std::vector<float>& values)
+	{
+		const auto overlay = values.empty() ? std::string() : std::to_string(values.back());
+		ImGui::PlotLines(label, values.data(), static_cast<int>(values.size()), 0, overlay.c_str(),
+		                 FLT_MAX, FLT_MAX, plotSize);
+	};
+
+	ImGui::Text("Generation: %d", mGeneticAlgorithm.currentGeneration());
+	plot("Best fitness", plots.bestFitness);
+	plot("Mean fitness", plots.meanFitness);
+	plot("Median fitness", plots.medianFitness);
+	plot("Evolve time [ms]", plots.evolveMilliseconds);
+	plot("Cache hit rate", plots.cacheHitRate);
+	plot("Diversity", plots.diversity);
+	plot("Pairwise distance", plots.meanPairwiseDistance);
+	plot("Surrogate accuracy", plots.surrogateRankCorrelation);
+	plot("Alive birds", plots.aliveBirds);
+	if (const auto droppedRecords = mTelemetry.droppedRecords())
+	{
+		ImGui::Text("Dropped records: %zu", droppedRecords);
+	}
+}
+
+void GameManager::updateImGuiTermination()
+{
+	if (!ImGui::CollapsingHeader("Termination"))
+	{
+		return;
+	}
+
+	ImGui::Checkbox("End when the last bird dies", &mTerminationRules.endWhenLastBirdDies);
+
+	auto maximumTicks = static_cast<int>(mTerminationRules.maximumTicks);
+	if (ImGui::InputInt("Tick limit", &maximumTicks, 600, 6000))
+	{
+		mTerminationRules.maximumTicks = static_cast<std::uint32_t>(std::max(maximumTicks, 0));
 	}
+	ImGui::InputFloat("Solved fitness", &mTerminationRules.solvedFitness, 1.f, 10.f, "%.1f");
+
+	auto endName = [](GenerationEnd end)
+	{
+		switch (end)
+		{
+			case GenerationEnd::AllBirdsGone: return "all birds gone";
+			case GenerationEnd::LastBirdDied: return "last bird died";
+			case GenerationEnd::TimeLimit: return "tick limit";
+			case GenerationEnd::Solved: return "solved";
+			default: return "-";
+		}
+	};
+	ImGui::Text("Previous generation ended: %s", endName(mLastGenerationEnd));
+	if (mSolvedGeneration)
+	{
+		ImGui::Text("Solved in generation %d", *mSolvedGeneration);
+	}
+	ImGui::Checkbox("Turbo: dead birds leave immediately", &mIsTurbo);
 }
 
 void GameManager::updateImGui()
 {
+	updateImGuiStatistics();
+	updateImGuiEvolution();
+	updateImGuiEvaluation();
+	updateImGuiOptimizer();
+	mConvergenceMonitor.updateImGui();
+	mPopulationDiversity.updateImGui();
+	updateImGuiHallOfFame();
+	updateImGuiPretraining();
+	updateImGuiTermination();
+	updateImGuiReplays();
+	updateImGuiRewind();
 	mPipesGenerator.updateImGuiThis();
 	mBackground.updateImGui();
 	mGround.updateImGui();
-
-	for (auto& bird : mBirds)
-	{
-		bird.updateImGui();
-	}
 }
 
 void GameManager::handleEvents(const sf::Event& event)
 {
-	for (auto& bird : mBirds)
+	// Recorded run is played exactly as it was, so the player can not interfere
+	if (mReplayedRun)
 	{
-		bird.handleEvents(event);
+		return;
 	}
+
+	mBirds.handleEvents(event);
 }
 
 void GameManager::handleCollision()
 {
-	for (auto& bird : mBirds)
+	PROFILE_SCOPE(HandleCollision);
+	for (std::size_t bird = 0; bird < mBirds.size(); ++bird)
 	{
-		mPipesGenerator.checkCollision(bird);
+		if (isInSimulation(bird) && mPipesGenerator.collides(mBirds.birdBounds(bird)))
+		{
+			mBirds.kill(bird);
+
+			auto birdVelocity = (mBirds.velocity(bird).y < 0) ? 0 : mBirds.velocity(bird).y;
+			mBirds.setVelocity(bird, {-Pipe::pipeSpeed(), birdVelocity});
+		}
 	}
 }
 
@@ -192,9 +1045,12 @@ void GameManager::draw(sf::RenderTarget& target, sf::RenderStates states) const
 	target.draw(mPipesGenerator, states);
 	target.draw(mGround, states);
 
-	for (const auto& bird : mBirds)
+	for (std::size_t bird = 0; bird < mBirds.size(); ++bird)
 	{
-		target.draw(bird, states);
+		if (isInSimulation(bird))
+		{
+			mBirds.draw(target, states, bird);
+		}
 	}
 }
 
@@ -202,18 +1058,37 @@ void GameManager::addBirds(const TextureManager& textureManager, const sf::Vecto
                                         const unsigned& numberOfBirds)
 {
 	const auto& birdTextureSize = mBirdTextures.size();
+	const Birds::State startState{ {(screenSize.x / 4.f), (screenSize.y / 2.f)}, {}, 0.f, 0.f, false };
 
 	for (unsigned birdIndex = 0; birdIndex < numberOfBirds; ++birdIndex)
 	{
 		const int& textureIndex = birdIndex % birdTextureSize;
-		mBirds.emplace_back(textureManager.getResourceReference(mBirdTextures[textureIndex]));
-		mBirds.back().setPosition({(screenSize.x / 4.f), (screenSize.y / 2.f)});
+		mBirds.add(mBirdTextures[textureIndex], startState);
 	}
 }
 
 void GameManager::restartGame()
 {
-	mBirds.clear();
+	mTick = 0;
+	mRewindBuffer.clear();
 	mPipesGenerator.restart();
-	addBirds(mTextureManager, mScreenSize, 150);
+
+	// Birds of the previous generation are reused, only their state is brought back to the start.
+	// Before the first population is created, there are as many birds as it is going to have.
+	const auto& population = mGeneticAlgorithm.population();
+	const auto numberOfBirds = static_cast<unsigned>(population.empty() ? mGeneticAlgorithm.populationSize() : population.size());
+	if (mBirds.size() == numberOfBirds)
+	{
+		const Birds::State startState{ {(mScreenSize.x / 4.f), (mScreenSize.y / 2.f)}, {}, 0.f, 0.f, false };
+		for (std::size_t bird = 0; bird < mBirds.size(); ++bird)
+		{
+			mBirds.restoreState(bird, startState);
+		}
+	}
+	else
+	{
+		mBirds.clear();
+		addBirds(mTextureManager, mScreenSize, numberOfBirds);
+	}
+	mDecisions.assign(mBirds.size(), {});
 }
@@ -1,10 +1,20 @@
 #pragma once
 #include <optional>
 
+#include "ChampionExporter.h"
+#include "ChampionPruner.h"
+#include "ConvergenceMonitor.h"
+#include "DecisionRecorder.h"
+#include "FitnessEvaluator.h"
 #include "GeneticAlgorithm.h"
+#include "OptimizerBenchmark.h"
+#include "PopulationDiversity.h"
+#include "RewindBuffer.h"
+#include "TeacherPretrainer.h"
+#include "Telemetry.h"
 #include "nodes/objects/background/Background.h"
 #include "nodes/objects/background/Ground.h"
-#include "nodes/objects/bird/Bird.h"
+#include "nodes/objects/bird/Birds.h"
 #include "nodes/objects/pipe/PipesGenerator.h"
 
 
@@ -15,6 +25,45 @@
 class GameManager : public sf::Drawable
 {
 public:
+	/**
+	 * \brief Rules deciding when the generation is over, besides all the birds being dead
+	 */
+	struct TerminationRules
+	{
+		/** Ends the generation as soon as the last bird dies, without waiting for the dead birds to fall off the screen */
+		bool endWhenLastBirdDies = false;
+
+		/** Ends the generation after this many ticks, even if some birds are still alive. Zero means no limit. */
+		std::uint32_t maximumTicks = 0;
+
+		/** Ends the generation and marks the training as solved once any bird reaches this fitness. Zero means never. */
+		float solvedFitness = 0.f;
+	};
+
+	/**
+	 * \brief The way in which the population is evolved
+	 */
+	enum class EvolutionMode
+	{
+		/** The whole population is replaced once all the birds are dead */
+		Generational,
+
+		/** Every bird is replaced by the offspring of the elite archive as soon as it dies */
+		SteadyState,
+	};
+
+	/**
+	 * \brief Reason for which the generation was finished
+	 */
+	enum class GenerationEnd
+	{
+		NotOver,
+		AllBirdsGone,
+		LastBirdDied,
+		TimeLimit,
+		Solved,
+	};
+
 	/**
 	 * \brief The main constructor of the game manager.
 	 * \param textureManager Texture manager holds all the available textures in the game.
@@ -71,58 +120,260 @@ private:
 	 */
 	void restartGame();
 
+	/**
+	 * \brief Updates all objects of the world, without making any decisions for the birds
+	 * \param deltaTime Time elapsed since previous update
+	 */
+	void updateWorld(const sf::Time& deltaTime);
+
+	/**
+	 * \brief Plays a single tick of the training
+	 * \param deltaTime Time elapsed since previous update
+	 */
+	void simulateTick(const sf::Time& deltaTime);
+
+	/**
+	 * \brief Passes the decisions the networks made in this tick to the decision recorder
+	 */
+	void recordDecisions();
+
+	/**
+	 * \brief Collects the state of the whole world
+	 * \param deltaTime Length of the following ticks
+	 * \return State of the world at the current tick
+	 */
+	WorldState worldState(const sf::Time& deltaTime) const;
+
+	/**
+	 * \brief Brings the whole world back to the given state
+	 * \param state State of the world
+	 */
+	void restoreWorldState(const WorldState& state);
+
+	/**
+	 * \brief Rewinds the current generation to the given tick
+	 * \param tick Tick counting from the start of the generation
+	 *
+	 * The nearest keyframe before the tick is restored, and the game is simulated from it up to the tick.
+	 */
+	void seek(std::uint32_t tick);
+
+	/**
+	 * \brief Updates the timeline slider used to rewind the current generation
+	 */
+	void updateImGuiRewind();
+
+	/**
+	 * \brief Updates the plots of the training statistics
+	 */
+	void updateImGuiStatistics();
+
+	/**
+	 * \brief Records the finished generation, evolves the population and starts the next generation
+	 */
+	void finishGeneration();
+
+	/**
+	 * \brief Starts the training again from the hall of fame if the pipes changed during the generation that just ended.
+	 *
+	 * Waiting for the end of the generation means dragging a slider of the course restarts the training once,
+	 * with the final settings, instead of on every frame of the drag.
+	 */
+	void warmStartIfCourseChanged();
+
+	/**
+	 * \brief Summarizes the fitness scores of the finished generation
+	 * \param fitness Fitness scores of all the units that took part in the generation
+	 * \param statistics Statistics to which the best, mean and median fitness are written
+	 */
+	static void summarizeFitness(std::vector<float> fitness, GenerationStatistics& statistics);
+
+	/**
+	 * \brief Switches the way in which the population is evolved, starting the current generation again
+	 * \param mode New evolution mode
+	 */
+	void setEvolutionMode(EvolutionMode mode);
+
+	/**
+	 * \brief Starts the training again, keeping the generation counter so the telemetry stays in order.
+	 * The convergence monitor, with its time to the target, starts over.
+	 * \param pretrainedUnits Networks the new population starts from. The hall of fame is used if there are none.
+	 */
+	void warmStart(const std::vector<GeneticAlgorithm::Unit>& pretrainedUnits = {});
+
+	/**
+	 * \brief Starts training the networks to imitate the analytic teacher in the background.
+	 * The population starts again from them once they are ready.
+	 */
+	void startPretraining();
+
+	/**
+	 * \brief Updates the options of the pretraining and its report
+	 */
+	void updateImGuiPretraining();
+
+	/**
+	 * \brief Saves the hall of fame if it changed since it was last saved
+	 */
+	void saveHallOfFame();
+
+	/**
+	 * \brief Updates the list of the archived networks, the warm start controls and the pruning of the champion
+	 */
+	void updateImGuiHallOfFame();
+
+	/**
+	 * \brief Replaces every dead bird with the offspring of the elite archive and brings it back into the game.
+	 * Used only in the steady-state evolution.
+	 */
+	void replaceDeadBirds();
+
+	/**
+	 * \brief Updates the choice of the evolution mode
+	 */
+	void updateImGuiEvolution();
+
+	/**
+	 * \brief Starts breeding the next population in the background. If more than one course is
+	 * played in the evaluation, the population is scored on them before it is bred.
+	 */
+	void startEvolving();
+
+	/**
+	 * \brief Switches the backend breeding the populations in the generational evolution.
+	 * The population bred in the background is dropped and the current one is bred again by the new backend.
+	 * \param backend New backend
+	 */
+	void setOptimizerBackend(Optimizer::Backend backend);
+
+	/**
+	 * \brief Creates a fresh instance of the chosen backend
+	 * \return New optimizer, or null for the built-in genetic algorithm
+	 */
+	std::unique_ptr<Optimizer> createOptimizer() const;
+
+	/**
+	 * \brief Updates the choice of the optimizer backend and the benchmark of the backends
+	 */
+	void updateImGuiOptimizer();
+
+	/**
+	 * \brief Measures the sizes and forces of the game needed to play it without any graphics
+	 * \return Geometry of the current game
+	 */
+	HeadlessGeometry headlessGeometry() const;
+
+	/**
+	 * \brief Updates the options of the evaluation on several courses
+	 */
+	void updateImGuiEvaluation();
+
+	/**
+	 * \brief Starts playing the recorded run instead of the training
+	 * \param run Run to be played again
+	 *
+	 * The current generation is interrupted and it starts again after the replay.
+	 */
+	void startReplay(const RecordedRun& run);
+
+	/**
+	 * \brief Stops playing the recorded run and goes back to the training
+	 */
+	void stopReplay();
+
+	/**
+	 * \brief Plays the recorded ticks that fit into the time that has passed. Every tick keeps its recorded
+	 * length, so the run is played exactly, but a slowed down game clock slows the replay down too.
+	 * \param deltaTime the time that has passed since the game was last updated
+	 */
+	void updateReplay(const sf::Time& deltaTime);
+
+	/**
+	 * \brief Plays the next tick of the recorded run. Flaps are taken from the record, not from the networks.
+	 */
+	void replayTick();
+
+	/**
+	 * \brief Updates the list of the recorded runs, and the replay controls
+	 */
+	void updateImGuiReplays();
+
 	/**
 	 * \brief Checks if all birds in the game are already dead
 	 * \return True if all birds are dead, false otherwise
 	 */
-	bool allBirdsAreDead();
+	bool allBirdsAreDead() const;
+
+	/**
+	 * \brief Checks the termination rules against the current state of the generation
+	 * \return Reason for which the generation is over, or NotOver
+	 */
+	GenerationEnd generationEnd() const;
+
+	/**
+	 * \brief Checks if any bird in the game is still alive
+	 * \return True if at least one bird is alive
+	 */
+	bool anyBirdIsAlive() const;
+
+	/**
+	 * \brief Checks if the bird takes part in the simulation. In the turbo mode dead birds do not.
+	 * \param bird Index of the bird to check
+	 * \return True if the bird should be updated, drawn and checked for collisions
+	 */
+	bool isInSimulation(std::size_t bird) const;
+
+	/**
+	 * \brief Updates the termination rules of the generation
+	 */
+	void updateImGuiTermination();
 
 	/**
 	 * \brief Checks if the bird crosses the top border of the screen.
 	 * If it does, kills it.
 	 *
-	 * \param currentBird A bird that is checked for crossing the top edge of the screen
+	 * \param currentBird Index of the bird that is checked for crossing the top edge of the screen
 	 */
-	static void killIfExceedsTopScreenBoundary(Bird& currentBird);
+	void killIfExceedsTopScreenBoundary(std::size_t currentBird);
 
 	/**
 	 * \brief Checks if the bird crosses the bottom border of the screen.
 	 * If it does, kills it and imparts a velocity equal to that of the moving floor
 	 *
-	 * \param currentBird A bird that is checked for crossing the bottom edge of the screen
+	 * \param currentBird Index of the bird that is checked for crossing the bottom edge of the screen
 	 */
-    void killIfExceedsBottomScreenBoundary(Bird& currentBird) const;
+    void killIfExceedsBottomScreenBoundary(std::size_t currentBird);
 
 	/**
 	 * \brief Checks if the bird crosses the borders of the screen.
 	 * If it does, kills it and imparts a velocity equal to that of the moving floor
 	 *
-	 * \param currentBird A bird that is checked for crossing the edge of the screen
+	 * \param currentBird Index of the bird that is checked for crossing the edge of the screen
 	 */
-    void killIfExceedsScreenBoundaries(Bird& currentBird);
+    void killIfExceedsScreenBoundaries(std::size_t currentBird);
 
 	/**
 	 * \brief Gives the horizontal distance between the bird and the pipes normalized to a value between 0 and 1.
-	 * \param currentBird Bird from which distance is measured
+	 * \param birdPosition Position of the bird from which distance is measured
 	 * \param nearestPipe Pipeset from which distance is measured
 	 * \return Horizontal distance between bird and between two pipes
 	 */
-	float horizontalNormalizedDistanceBetweenBirdAndPipeset(const Bird& currentBird, const PipeSet& nearestPipe) const;
+	float horizontalNormalizedDistanceBetweenBirdAndPipeset(const sf::Vector2f& birdPosition, const PipeSet& nearestPipe) const;
 
 	/**
 	 * \brief Gives the vertical distance between the bird and the pipe gap normalized to a value between 0 and 1.
-	 * \param currentBird Bird from which distance is measured
+	 * \param birdPosition Position of the bird from which distance is measured
 	 * \param nearestPipe Pipeset from which distance is gained to the middle of the gap between the two pipes
 	 * \return Vertical distance between bird and gap between two pipes
 	 */
-	float verticalNormalizedDistanceBetweenBirdAndPipeset(const Bird& currentBird, const PipeSet& nearestPipe) const;
+	float verticalNormalizedDistanceBetweenBirdAndPipeset(const sf::Vector2f& birdPosition, const PipeSet& nearestPipe) const;
 
 	/**
 	 * \brief The height at which the bird is located normalized to a range of 0 to 1.
-	 * \param currentBird Bird whose height is being checked
+	 * \param birdPosition Position of the bird whose height is being checked
 	 * \return Height in range 0 to 1
 	 */
-	float normalizedVerticalBirdPosition(const Bird& currentBird) const;
+	float normalizedVerticalBirdPosition(const sf::Vector2f& birdPosition) const;
 
 	/**
 	 * \brief The distance resulting from the Pythagoras theorem - calculated as the length of the hypotenuse.
@@ -134,19 +385,19 @@ private:
 
 	/**
 	 * \brief Calculates the bird's earned fitness score
-	 * \param currentBird Bird for which the fitness score is calculated
+	 * \param birdScore Score the bird earned by staying alive
 	 * \param distanceToGap The distance between the bird and the nearest gap between the pipes
 	 * \return Fitness score of the bird
 	 */
-	static float calculateBirdFitnessScore(const Bird& currentBird, const float& distanceToGap);
+	static float calculateBirdFitnessScore(float birdScore, const float& distanceToGap);
 
 	/**
 	 * \brief Normalized vertical and horizontal distance from 0 to 1 between the bird and the nearest gap between two pipes.
-	 * \param currentBird Bird for which the distance is counted
+	 * \param birdPosition Position of the bird for which the distance is counted
 	 * \param nearestPipeset Nearest two pipes between which the distance is calculated
 	 * \return Normalized horizontal (first) and vertical (second) distance from 0 to 1
 	 */
-	std::pair<float, float> normalizedDistancesBetweenBirdAndPipeset(const Bird& currentBird, const PipeSet& nearestPipeset) const;
+	std::pair<float, float> normalizedDistancesBetweenBirdAndPipeset(const sf::Vector2f& birdPosition, const PipeSet& nearestPipeset) const;
 
 	/**
 	 * \brief Updates the state of Artificial Neural Network
@@ -175,12 +426,123 @@ private:
 	/** Handles pipes generation and related operations */
 	PipesGenerator mPipesGenerator;
 
-	/** List of current birds in the game */
-	std::list<Bird> mBirds;
+	/** Current birds in the game, with their data kept in contiguous arrays */
+	Birds mBirds;
 
 	/** Array containing all types of bird textures */
 	std::array<Textures_ID, 3> mBirdTextures{Textures_ID::Bird_Blue, Textures_ID::Bird_Orange, Textures_ID::Bird_Red};
 
 	/** Genetic algorithm used to control bird behavior */
 	GeneticAlgorithm mGeneticAlgorithm;
+
+	/** Backend breeding the populations in the generational evolution */
+	Optimizer::Backend mOptimizerBackend;
+
+	/** Compares the backends on the headless game */
+	OptimizerBenchmark mOptimizerBenchmark;
+
+	/** Prunes the best network of the hall of fame for the cheaper runs */
+	ChampionPruner mChampionPruner;
+
+	/** Exports the best network of the hall of fame as standalone C++ */
+	ChampionExporter mChampionExporter;
+
+	/** Trains the first networks to imitate the analytic teacher */
+	TeacherPretrainer mTeacherPretrainer;
+
+	/** Adapts the mutation and the size of the population to the progress of the training */
+	ConvergenceMonitor mConvergenceMonitor;
+
+	/** Measures the diversity of every bred population */
+	PopulationDiversity mPopulationDiversity;
+
+	/**
+	 * \brief Decision made by the network of a single bird in the current tick
+	 */
+	struct BirdDecision
+	{
+		bool wasAlive = false;
+		bool flapped = false;
+	};
+
+	/**
+	 * Decisions of the current tick, indexed as the birds. They are recorded after the tick,
+	 * so the simulation itself never waits for the decision log to grow.
+	 */
+	std::vector<BirdDecision> mDecisions;
+
+	/** Records decisions of the best birds of every generation */
+	DecisionRecorder mDecisionRecorder;
+
+	/** Runs read from the decision log that can be played again */
+	std::vector<RecordedRun> mRecordedRuns;
+
+	/** Run that is being played again. Empty during the training. */
+	std::optional<RecordedRun> mReplayedRun;
+
+	/** Tick of the replayed run that is going to be played next */
+	std::uint32_t mReplayedTick;
+
+	/** Time of the game clock that has passed, but was not played by the replayed ticks yet */
+	sf::Time mReplayClock;
+
+	/** Course of the training, brought back once the replay is over */
+	std::shared_ptr<const PipeCourse> mTrainingCourse;
+
+	/** Recent states of the world, used to rewind the current generation */
+	RewindBuffer mRewindBuffer;
+
+	/** Number of ticks that have passed since the generation started */
+	std::uint32_t mTick;
+
+	/** Statistics of the training, collected without slowing the game down */
+	Telemetry mTelemetry;
+
+	/** Rules deciding when the generation is over */
+	TerminationRules mTerminationRules;
+
+	/** The way in which the population is evolved */
+	EvolutionMode mEvolutionMode;
+
+	/** Options of the evaluation of every generation on several courses */
+	FitnessEvaluator::Settings mEvaluationSettings;
+
+	/** Scores of the networks already played in the evaluation. Shared with the evolve worker, which alone uses it while evolving. */
+	std::shared_ptr<FitnessCache> mFitnessCache;
+
+	/** Fitness of the birds that died since the generation counter was last advanced in the steady-state evolution */
+	std::vector<float> mSteadyStateFitness;
+
+	/** Set by the user to stop simulating and drawing the dead birds. Off by default, whatever the speed of the game. */
+	bool mIsTurbo;
+
+	/** Reason for which the previous generation was finished */
+	GenerationEnd mLastGenerationEnd;
+
+	/** First generation in which any bird reached the solved fitness */
+	std::optional<int> mSolvedGeneration;
+
+	/** Course the population was trained on. When the pipes change, the training may start again from the hall of fame. */
+	std::shared_ptr<const PipeCourse> mTrainedCourse;
+
+	/** Set if the training starts again from the hall of fame at the end of a generation in which the pipes changed */
+	bool mWarmStartOnCourseChange;
+
+	/** Revision of the hall of fame that was last saved */
+	std::uint64_t mSavedHallOfFameRevision;
+
+	/** File to which the hall of fame is saved, and from which it is loaded at the start */
+	static const std::string HALL_OF_FAME_PATH;
+
+	/** How many of the best units the genetic algorithm breeds from */
+	static constexpr int TOP_EVOLVING_UNITS = 5;
+
+	/** Number of scores kept by the fitness cache in each of its tables, a few generations played on every course */
+	static constexpr std::size_t FITNESS_CACHE_CAPACITY = 8 * 1024;
+
+	/** File to which the statistics of every generation are appended */
+	static const std::string TELEMETRY_PATH;
+
+	/** File to which the decisions of the best birds are appended */
+	static const std::string DECISION_LOG_PATH;
 };
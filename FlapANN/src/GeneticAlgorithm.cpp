@@ -24,51 +24,45 @@ GeneticAlgorithm::Unit& GeneticAlgorithm::Unit::operator=(const Unit& rhs)
 {
 	if (this != &rhs)
 	{
+		fann_destroy(ann);
 		ann = fann_copy(rhs.ann);
 		index = rhs.index;
 		fitness = rhs.fitness;
-		mMutateRate = rhs.mMutateRate;
 	}
 	return *this;
 }
 
 GeneticAlgorithm::Unit& GeneticAlgorithm::Unit::operator=(Unit&& rhs) noexcept
 {
-	ann = rhs.ann;
+	// The previous network is destroyed together with the moved-from unit
+	std::swap(ann, rhs.ann);
 	index = rhs.index;
 	fitness = rhs.fitness;
-	mMutateRate = rhs.mMutateRate;
-	rhs.ann = nullptr;
 	return *this;
 }
 
-void GeneticAlgorithm::Unit::performOnPredictedOutput(std::vector<fann_type> input, std::function<void(fann_type*)> perform) const
-{
-    perform(fann_run(ann, input.data()));
-}
-
-void GeneticAlgorithm::Unit::mutate()
+void GeneticAlgorithm::Unit::mutate(const Mutation& mutation)
 {
     for(int i = 0; i < ann->total_connections; ++i)
     {
-        ann->weights[i] = mutateGene(ann->weights[i]);
+        ann->weights[i] = mutateGene(ann->weights[i], mutation);
     }
     for (int i = 0; i < ann->total_connections; ++i)
     {
-        ann->connections[i]->activation_steepness = mutateGene(ann->connections[i]->activation_steepness);
+        ann->connections[i]->activation_steepness = mutateGene(ann->connections[i]->activation_steepness, mutation);
     }
 }
 
-float GeneticAlgorithm::Unit::mutateGene(float gene)
+float GeneticAlgorithm::Unit::mutateGene(float gene, const Mutation& mutation)
 {
     auto randomBetweenZeroAndOne = []()
     {
         return (static_cast<float>(std::rand()) / (RAND_MAX));
     };
     auto random = randomBetweenZeroAndOne();
-    if(random < mMutateRate)
+    if(random < mutation.rate)
     {
-        const auto mutateFactor = 1.f + ((randomBetweenZeroAndOne() - 0.5f) * 3.f + (randomBetweenZeroAndOne() - 0.5f));
+        const auto mutateFactor = 1.f + ((randomBetweenZeroAndOne() - 0.5f) * 3.f + (randomBetweenZeroAndOne() - 0.5f)) * mutation.strength;
         gene *= mutateFactor;
     }
     return gene;
@@ -78,105 +72,283 @@ GeneticAlgorithm::GeneticAlgorithm(int populationSize, int topEvolvingUnits, Net
     : mSizeOfPopulation(populationSize)
     , mTopUnits(topEvolvingUnits)
     , mCurrentGeneration(0)
+    , mReplacedUnits(0)
+    , mHallOfFame(HALL_OF_FAME_CAPACITY)
+    , mRandomGenerator(std::random_device{}())
 {
     mLayers.push_back(settings.mInputNeurons);
     mLayers.insert(mLayers.begin()+1, settings.mNeuronsPerHiddenLayer.begin(), settings.mNeuronsPerHiddenLayer.end());
     mLayers.push_back(settings.mOutputNeurons);
 }
 
-bool GeneticAlgorithm::doesBestUnitFailed()
-{
-    return bestUnits().at(0).fitness < minimumFitnessScore;
-}
-
-void GeneticAlgorithm::clearPopulation()
-{
-    mPopulation.clear();
-}
-
-void GeneticAlgorithm::resetIfTheBestUnitIsTooWeak()
+bool GeneticAlgorithm::doesBestUnitFailed(const std::vector<Unit>& population)
 {
-    if(doesBestUnitFailed())
+    return std::none_of(population.begin(), population.end(), [](const Unit& unit)
     {
-        clearPopulation();
-        createPopulation();
-    }
+        return unit.fitness >= minimumFitnessScore;
+    });
 }
 
-std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::crossoverTwoRandomBestUnits()
+std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::crossoverTwoRandomBestUnits(const std::vector<Unit>& sortedPopulation) const
 {
-	auto& bestUnits = this->bestUnits();
-	std::vector<Unit> randomBests;
-	std::sample(bestUnits.begin(), bestUnits.end(), std::back_inserter(randomBests), 2,
-	            std::mt19937(std::random_device()()));
-	return crossover(randomBests.at(0), randomBests.at(1));
+	// Two different units drawn from the top ones, without copying any of them
+	const auto topUnits = std::min(mTopUnits, static_cast<int>(sortedPopulation.size()));
+	const auto firstIndex = std::rand() % topUnits;
+	auto secondIndex = std::rand() % (topUnits - 1);
+	if (secondIndex >= firstIndex)
+	{
+		++secondIndex;
+	}
+	return crossover(sortedPopulation.at(firstIndex), sortedPopulation.at(secondIndex));
 }
 
-std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::crossoverTwoRandomUnits()
+std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::crossoverTwoRandomUnits(const std::vector<Unit>& population) const
 {
-	auto population = this->population();
 	return std::make_unique<Unit>(*(population.begin() + (std::rand() % population.size())));
 }
 
-std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::crossoverTwoBestUnits()
+std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::crossoverTwoBestUnits(const std::vector<Unit>& sortedPopulation) const
 {
-	auto bestUnits = this->bestUnits();
-	return crossover(bestUnits.at(0), bestUnits.at(1));
+	return crossover(sortedPopulation.at(0), sortedPopulation.at(1));
 }
 
-void GeneticAlgorithm::reassignIndexes()
+void GeneticAlgorithm::reassignIndexes(std::vector<Unit>& population)
 {
 	int iterator = 0;
-	for(auto& unit : mPopulation)
+	for(auto& unit : population)
 	{
 		unit.index = iterator++;
 	}
 }
 
-void GeneticAlgorithm::reassignPopulation(std::vector<GeneticAlgorithm::Unit> sortedPopulation)
-{
-	mPopulation = sortedPopulation;
-	reassignIndexes();
-}
-
-std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::replaceWeakBirdsWithCrossovers(std::vector<GeneticAlgorithm::Unit>&& sortedPopulationByFitness)
+std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::replaceWeakBirdsWithCrossovers(const std::vector<GeneticAlgorithm::Unit>& sortedPopulationByFitness) const
 {
+	// The population might have been resized since the parents were bred
 	const auto firstWeakUnitIndex = mTopUnits;
-	const auto& populationSizeWithoutTopUnits = mPopulation.size() - mTopUnits;
+	const auto& populationSizeWithoutTopUnits = populationSize() - mTopUnits;
+
+	// The parents are only read, so the top units of the new population are just their copies
+	std::vector<Unit> population(sortedPopulationByFitness.begin(), sortedPopulationByFitness.begin() + firstWeakUnitIndex);
+	population.reserve(populationSize());
 
+	const auto isScreened = mSurrogate && mSurrogate->isReady();
 	for(int i = 0; i < populationSizeWithoutTopUnits; ++i)
 	{
 		auto offspring = std::unique_ptr<Unit>();
 
 		if(i == 0)
 		{
-			offspring = crossoverTwoBestUnits();
+			offspring = crossoverTwoBestUnits(sortedPopulationByFitness);
 		}
 		else if (i < populationSizeWithoutTopUnits - 2)
 		{
-			offspring = crossoverTwoRandomBestUnits();
+			if (isScreened)
+			{
+				// The screened offspring is mutated already, as the mutation is what it was chosen for
+				population.push_back(std::move(*screenedCrossoverOfRandomBestUnits(sortedPopulationByFitness)));
+				continue;
+			}
+			offspring = crossoverTwoRandomBestUnits(sortedPopulationByFitness);
 		}
 		else
 		{
-			offspring = crossoverTwoRandomUnits();
+			offspring = crossoverTwoRandomUnits(sortedPopulationByFitness);
 		}
 
-		offspring->mutate();
-		sortedPopulationByFitness[firstWeakUnitIndex + i] = *offspring.release();
+		offspring->mutate(mMutation);
+		population.push_back(std::move(*offspring));
 	}
-    return sortedPopulationByFitness;
+    return population;
 }
 
-void GeneticAlgorithm::evolveWeakUnits()
+std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::screenedCrossoverOfRandomBestUnits(const std::vector<Unit>& sortedPopulation) const
 {
-	reassignPopulation(replaceWeakBirdsWithCrossovers(sortByFitness(mPopulation)));
-	++mCurrentGeneration;
+	const auto oversampling = mSurrogate->settings().oversampling;
+	auto bestOffspring = std::unique_ptr<Unit>();
+	auto bestPrediction = 0.f;
+	for (int candidate = 0; candidate < oversampling; ++candidate)
+	{
+		auto offspring = crossoverTwoRandomBestUnits(sortedPopulation);
+		offspring->mutate(mMutation);
+		const auto prediction = mSurrogate->predict(offspring->ann);
+		if (!bestOffspring || prediction > bestPrediction)
+		{
+			bestOffspring = std::move(offspring);
+			bestPrediction = prediction;
+		}
+	}
+	mSurrogate->recordScreening(bestOffspring->ann, bestPrediction, oversampling - 1);
+	return bestOffspring;
+}
+
+std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::nextPopulation(std::vector<Unit> parents, HallOfFame& hallOfFame) const
+{
+	if (mSurrogate)
+	{
+		std::vector<const fann*> networks;
+		networks.reserve(parents.size());
+		for (const auto& unit : parents)
+		{
+			networks.push_back(unit.ann);
+		}
+		mSurrogate->learn(networks, fitnessOf(parents));
+	}
+
+	auto sortedParents = sortByFitness(std::move(parents));
+	for (int place = 0; place < mTopUnits && place < static_cast<int>(sortedParents.size()); ++place)
+	{
+		const auto& unit = sortedParents[place];
+		if (unit.fitness >= minimumFitnessScore)
+		{
+			hallOfFame.offer(unit.ann, unit.fitness, mCurrentGeneration);
+		}
+	}
+
+	if (mOptimizer)
+	{
+		auto population = askOptimizer(sortedParents);
+		reassignIndexes(population);
+		return population;
+	}
+
+	// If the best unit is too weak, its development will be practically impossible or too slow,
+	// so the next population is bred from the best networks seen so far instead
+	if (doesBestUnitFailed(sortedParents))
+	{
+		sortedParents = sortByFitness(seededPopulation(hallOfFame));
+	}
+	auto population = replaceWeakBirdsWithCrossovers(sortedParents);
+	reassignIndexes(population);
+	return population;
+}
+
+std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::askOptimizer(const std::vector<Unit>& parents) const
+{
+	std::vector<Optimizer::Genome> genomes;
+	genomes.reserve(parents.size());
+	for (const auto& unit : parents)
+	{
+		genomes.push_back(Optimizer::genomeOf(unit.ann));
+	}
+	mOptimizer->tell(genomes, fitnessOf(parents));
+
+	std::vector<Unit> population;
+	population.reserve(populationSize());
+	for (const auto& genome : mOptimizer->ask(populationSize()))
+	{
+		auto ann = fann_create_standard_array(mLayers.size(), mLayers.data());
+		Optimizer::applyGenome(genome, ann);
+		population.emplace_back(ann, 0, 0);
+	}
+	return population;
+}
+
+std::vector<float> GeneticAlgorithm::fitnessOf(const std::vector<Unit>& population)
+{
+	std::vector<float> fitness;
+	fitness.reserve(population.size());
+	for (const auto& unit : population)
+	{
+		fitness.push_back(unit.fitness);
+	}
+	return fitness;
 }
 
 void GeneticAlgorithm::evolve()
 {
-    resetIfTheBestUnitIsTooWeak();
-    evolveWeakUnits();
+	assert(!isEvolving());
+
+	mParentsFitness = fitnessOf(mPopulation);
+	mPopulation = nextPopulation(mPopulation, mHallOfFame);
+	++mCurrentGeneration;
+}
+
+void GeneticAlgorithm::startEvolving(std::function<void(std::vector<Unit>&, FitnessSurrogate*)> evaluate)
+{
+	assert(!isEvolving());
+
+	mNextPopulation = std::async(std::launch::async, [this, evaluate = std::move(evaluate)]()
+	{
+		// The current population stays untouched, so the copy is scored instead
+		auto parents = mPopulation;
+		if (evaluate)
+		{
+			evaluate(parents, mSurrogate.get());
+		}
+		auto parentsFitness = fitnessOf(parents);
+		auto hallOfFame = mHallOfFame;
+		auto population = nextPopulation(std::move(parents), hallOfFame);
+		return EvolvedPopulation{ std::move(population), std::move(parentsFitness), std::move(hallOfFame) };
+	});
+}
+
+bool GeneticAlgorithm::isEvolving() const
+{
+	return mNextPopulation.valid();
+}
+
+void GeneticAlgorithm::finishEvolving()
+{
+	assert(isEvolving());
+
+	auto evolved = mNextPopulation.get();
+	mPopulation = std::move(evolved.population);
+	mParentsFitness = std::move(evolved.parentsFitness);
+	mHallOfFame = std::move(evolved.hallOfFame);
+	++mCurrentGeneration;
+}
+
+void GeneticAlgorithm::discardEvolving()
+{
+	if (isEvolving())
+	{
+		mNextPopulation.get();
+	}
+}
+
+const std::vector<float>& GeneticAlgorithm::parentsFitness() const
+{
+	return mParentsFitness;
+}
+
+void GeneticAlgorithm::replaceWithOffspring(int index)
+{
+	assert(!isEvolving());
+
+	auto& unit = mPopulation.at(index);
+	if (unit.fitness >= minimumFitnessScore)
+	{
+		mHallOfFame.offer(unit.ann, unit.fitness, mCurrentGeneration);
+	}
+
+	const auto isBetter = [](const Unit& a, const Unit& b) { return a.fitness > b.fitness; };
+	if (mEliteArchive.size() < static_cast<std::size_t>(mTopUnits) || isBetter(unit, mEliteArchive.back()))
+	{
+		mEliteArchive.insert(std::upper_bound(mEliteArchive.begin(), mEliteArchive.end(), unit, isBetter), unit);
+		if (mEliteArchive.size() > static_cast<std::size_t>(mTopUnits))
+		{
+			mEliteArchive.pop_back();
+		}
+	}
+
+	auto offspring = mEliteArchive.size() >= 2
+		                 ? crossoverTwoRandomBestUnits(mEliteArchive)
+		                 : std::make_unique<Unit>(mEliteArchive.front());
+	offspring->mutate(mMutation);
+	offspring->index = index;
+	offspring->fitness = 0;
+	unit = std::move(*offspring);
+
+	if (++mReplacedUnits == populationSize())
+	{
+		mReplacedUnits = 0;
+		++mCurrentGeneration;
+	}
+}
+
+const std::vector<GeneticAlgorithm::Unit>& GeneticAlgorithm::eliteArchive() const
+{
+	return mEliteArchive;
 }
 
 std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::sortByFitness(std::vector<GeneticAlgorithm::Unit> population) const
@@ -189,30 +361,147 @@ std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::sortByFitness(std::vector<
     return population;
 }
 
-std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::bestUnits()
+int GeneticAlgorithm::populationSize() const
+{
+    return mSizeOfPopulation;
+}
+
+void GeneticAlgorithm::setPopulationSize(int populationSize)
 {
-    auto sorted = sortByFitness(mPopulation);
+    assert(!isEvolving());
+    assert(populationSize > mTopUnits);
 
-    return std::vector(sorted.begin(), sorted.begin() + mTopUnits);
+    mSizeOfPopulation = populationSize;
 }
 
-int GeneticAlgorithm::populationSize() const
+const GeneticAlgorithm::Mutation& GeneticAlgorithm::mutation() const
 {
-    return mSizeOfPopulation;
+    return mMutation;
+}
+
+void GeneticAlgorithm::setMutation(const Mutation& mutation)
+{
+    assert(!isEvolving());
+
+    mMutation = mutation;
+}
+
+void GeneticAlgorithm::setOptimizer(std::unique_ptr<Optimizer> optimizer)
+{
+    assert(!isEvolving());
+
+    mOptimizer = std::move(optimizer);
+}
+
+const Optimizer* GeneticAlgorithm::optimizer() const
+{
+    return mOptimizer.get();
+}
+
+void GeneticAlgorithm::setSurrogate(std::unique_ptr<FitnessSurrogate> surrogate)
+{
+    assert(!isEvolving());
+
+    mSurrogate = std::move(surrogate);
+}
+
+const FitnessSurrogate* GeneticAlgorithm::surrogate() const
+{
+    return mSurrogate.get();
+}
+
+const std::vector<unsigned>& GeneticAlgorithm::layers() const
+{
+    return mLayers;
 }
 
 void GeneticAlgorithm::createPopulation()
 {
+    // The archived fitness is only used to rank the networks while breeding, the run starts from zero
+    mPopulation = seededPopulation(mHallOfFame);
+    for (auto& unit : mPopulation)
+    {
+        unit.fitness = 0;
+    }
+}
+
+void GeneticAlgorithm::createPopulation(const std::vector<Unit>& pretrainedUnits)
+{
+    mPopulation = randomPopulation();
+    const auto seededUnits = pretrainedUnits.empty() ? 0 : populationSize() * 3 / 4;
+    for (int i = 0; i < seededUnits; ++i)
+    {
+        auto& unit = mPopulation[i];
+        const auto& pretrainedUnit = pretrainedUnits[i % pretrainedUnits.size()];
+        assert(pretrainedUnit.ann->total_connections == unit.ann->total_connections);
+        unit = pretrainedUnit;
+        unit.index = i;
+        if (i >= static_cast<int>(pretrainedUnits.size()))
+        {
+            unit.mutate(mMutation);
+        }
+    }
+    for (auto& unit : mPopulation)
+    {
+        unit.fitness = 0;
+    }
+}
+
+const HallOfFame& GeneticAlgorithm::hallOfFame() const
+{
+    return mHallOfFame;
+}
+
+bool GeneticAlgorithm::loadHallOfFame(const std::string& path_to_file)
+{
+    assert(!isEvolving());
+
+    return mHallOfFame.load(path_to_file, mLayers);
+}
+
+bool GeneticAlgorithm::saveHallOfFame(const std::string& path_to_file) const
+{
+    return mHallOfFame.save(path_to_file, mLayers);
+}
+
+std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::randomPopulation() const
+{
+    std::vector<Unit> population;
+    population.reserve(populationSize());
     for (int i = 0; i < populationSize(); ++i)
     {
         auto ann = fann_create_standard_array(mLayers.size(), mLayers.data());
-        Unit unit = {ann, i, 0};
-        mPopulation.push_back(unit);
+        fann_randomize_weights(ann, -1.f, 1.f);
+        population.emplace_back(ann, i, 0);
     }
-    for(const auto& unit : mPopulation)
+    return population;
+}
+
+std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::seededPopulation(const HallOfFame& hallOfFame) const
+{
+    auto population = randomPopulation();
+    const auto& members = hallOfFame.members();
+    if (members.empty())
     {
-        fann_randomize_weights(unit.ann, -1.f, 1.f);
+        return population;
     }
+
+    const auto seededUnits = populationSize() * 3 / 4;
+    for (int i = 0; i < seededUnits; ++i)
+    {
+        auto& unit = population[i];
+        const auto& member = members[i % members.size()];
+        Optimizer::applyGenome(member.genome, unit.ann);
+        if (i < static_cast<int>(members.size()))
+        {
+            unit.fitness = member.fitness;
+        }
+        else
+        {
+            unit.mutate(mMutation);
+        }
+    }
+    return population;
 }
 
 int GeneticAlgorithm::currentGeneration() const
@@ -220,7 +509,7 @@ int GeneticAlgorithm::currentGeneration() const
     return mCurrentGeneration;
 }
 
-std::vector<GeneticAlgorithm::Unit> GeneticAlgorithm::population()
+const std::vector<GeneticAlgorithm::Unit>& GeneticAlgorithm::population() const
 {
     return mPopulation;
 }
@@ -232,19 +521,18 @@ GeneticAlgorithm::Unit& GeneticAlgorithm::at(int index)
 
 std::unique_ptr<GeneticAlgorithm::Unit> GeneticAlgorithm::crossover(const Unit& parentA, const Unit& parentB) const
 {
-    static std::random_device rd; 
-    static std::mt19937 gen(rd());
     const std::uniform_int_distribution<> distr(0, parentA.ann->total_connections-1);
     const std::bernoulli_distribution trueOrFalse;
 
-    auto cutPoint = distr(gen);
+    // The child starts with the weights of one parent and takes the ones after the cut point from the other
+    auto cutPoint = distr(mRandomGenerator);
+    const auto& [head, tail] = trueOrFalse(mRandomGenerator) ? std::tie(parentA, parentB) : std::tie(parentB, parentA);
+    auto child = std::make_unique<Unit>(head);
     for (int i = cutPoint; i < parentA.ann->total_connections; ++i)
     {
-        auto biasFromA = parentA.ann->weights[i];
-        parentA.ann->weights[i] = parentB.ann->weights[i];
-        parentB.ann->weights[i] = biasFromA;
+        child->ann->weights[i] = tail.ann->weights[i];
     }
 
-    return (trueOrFalse(gen) ? std::make_unique<Unit>(parentA) : std::make_unique<Unit>(parentB));
+    return child;
 }
 
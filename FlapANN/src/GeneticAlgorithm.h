@@ -1,6 +1,12 @@
 #pragma once
+#include <future>
+#include <initializer_list>
+#include <random>
+
+#include "FitnessSurrogate.h"
+#include "HallOfFame.h"
+#include "Optimizer.h"
 #include "fann/fann.h"
-#include "nodes/objects/bird/Bird.h"
 
 
 /**
@@ -20,6 +26,18 @@ public:
         unsigned mOutputNeurons;
     };
 
+	/**
+     * \brief How strongly the offspring are mutated
+     */
+    struct Mutation
+    {
+        /** Chance of every gene to be mutated */
+        float rate = 0.2f;
+
+        /** Scale of the change of the mutated gene, 1 being the original one */
+        float strength = 1.f;
+    };
+
     struct Unit
     {
         fann* ann;
@@ -33,12 +51,10 @@ public:
         Unit(Unit&& rhs) noexcept;
         Unit& operator=(const Unit& rhs);
         Unit& operator=(Unit&& rhs) noexcept;
-        void performOnPredictedOutput(std::vector<fann_type> input, std::function<void(fann_type*)> perform) const;
-        void mutate();
-        float mutateGene(float gene);
-
-    private:
-        float mMutateRate = 0.2f;
+        template <typename Perform>
+        void performOnPredictedOutput(std::initializer_list<fann_type> input, Perform&& perform) const;
+        void mutate(const Mutation& mutation);
+        float mutateGene(float gene, const Mutation& mutation);
     };
 
 	/**
@@ -54,6 +70,60 @@ public:
      */
     void evolve();
 
+	/**
+     * \brief Starts breeding the next population on a background thread.
+     *
+     * The fitness of every unit has to be final already. Until finishEvolving() is called,
+     * the current population can still be read, but neither it nor its networks may be changed,
+     * which includes running the networks.
+     *
+     * \param evaluate Scores the copy of the current population on the background thread before
+     * it is bred, replacing the fitness from the live run. It gets the surrogate model, if there is any,
+     * so the offspring predicted to be weak need not be played. Nothing is scored again if it is empty.
+     */
+    void startEvolving(std::function<void(std::vector<Unit>&, FitnessSurrogate*)> evaluate = {});
+
+	/**
+     * \brief Checks if the next population is being bred on a background thread
+     * \return True if startEvolving() was called and the population was not taken yet
+     */
+    bool isEvolving() const;
+
+	/**
+     * \brief Replaces the population with the one bred on the background thread, waiting for it if needed.
+     * The exchange itself only swaps the containers.
+     */
+    void finishEvolving();
+
+	/**
+     * \brief Drops the population bred on the background thread, keeping the current one
+     */
+    void discardEvolving();
+
+	/**
+     * \brief Returns the final fitness of every unit of the previous population, as it was used in breeding
+     * \return Fitness scores in the order of the unit indexes. Empty before the first generation is bred.
+     */
+    const std::vector<float>& parentsFitness() const;
+
+	/**
+     * \brief Replaces the unit that finished its run with the offspring of the elite archive.
+     *
+     * Used by the steady-state evolution, in which units are replaced one by one as soon as
+     * their fitness is final, instead of the whole population at once. The finished unit joins
+     * the archive first if it is better than any unit kept there. Every time as many units
+     * were replaced as there are in the population, the generation counter is advanced.
+     *
+     * \param index The index of the unit whose fitness is final
+     */
+    void replaceWithOffspring(int index);
+
+	/**
+     * \brief Returns the best units that ever finished their run in the steady-state evolution
+     * \return Units sorted by fitness score in descending order
+     */
+    const std::vector<Unit>& eliteArchive() const;
+
 	/**
      * \brief Checks the population size (maximum number of units)
      * \return Size of the population
@@ -61,10 +131,96 @@ public:
     int populationSize() const;
 
 	/**
-     * \brief Creates an initial population with random weights ranging from -1 to 1.
+     * \brief Changes the size of the population, starting with the next bred one
+     * \param populationSize New size of the population, larger than the number of the top units
+     */
+    void setPopulationSize(int populationSize);
+
+	/**
+     * \brief Returns how strongly the offspring are mutated
+     * \return Current mutation settings
+     */
+    const Mutation& mutation() const;
+
+	/**
+     * \brief Changes how strongly the offspring are mutated, starting with the next bred population
+     * \param mutation New mutation settings
+     */
+    void setMutation(const Mutation& mutation);
+
+	/**
+     * \brief Replaces the way in which the next population is bred in the generational evolution.
+     *
+     * The parents are told to the optimizer and the next population is asked from it. The hall of fame
+     * is still offered the best parents, and the steady-state evolution keeps using the elite archive.
+     *
+     * \param optimizer Backend breeding the populations. Null restores the built-in genetic algorithm.
+     */
+    void setOptimizer(std::unique_ptr<Optimizer> optimizer);
+
+	/**
+     * \brief Returns the backend breeding the populations
+     * \return Current optimizer, or null if the built-in genetic algorithm is used
+     */
+    const Optimizer* optimizer() const;
+
+	/**
+     * \brief Starts or stops screening the offspring with the surrogate model in the generational evolution.
+     *
+     * The model learns from every played population. Once it is ready, several offspring are bred
+     * for every place filled by a crossover of the top units, and only the one predicted best is kept.
+     *
+     * \param surrogate Model predicting the fitness. Null plays every bred offspring.
+     */
+    void setSurrogate(std::unique_ptr<FitnessSurrogate> surrogate);
+
+	/**
+     * \brief Returns the surrogate model screening the offspring. It may be read only while nothing is being bred.
+     * \return Current model, or null if the offspring are not screened
+     */
+    const FitnessSurrogate* surrogate() const;
+
+	/**
+     * \brief Returns the number of neurons in every layer of the networks
+     * \return Layers from the input to the output one
+     */
+    const std::vector<unsigned>& layers() const;
+
+	/**
+     * \brief Creates an initial population. If the hall of fame is not empty, most of the units start
+     * from the archived networks. The rest get random weights ranging from -1 to 1.
      */
     void createPopulation();
 
+	/**
+     * \brief Creates an initial population starting from the pretrained networks. The first units are
+     * exact copies of them, the following ones are their mutated copies, and the last quarter gets
+     * random weights to keep the gene pool wide.
+     *
+     * \param pretrainedUnits Networks of the same layout. The population is random if there are none.
+     */
+    void createPopulation(const std::vector<Unit>& pretrainedUnits);
+
+	/**
+     * \brief Returns the best networks ever seen during the training
+     * \return Hall of fame of the training
+     */
+    const HallOfFame& hallOfFame() const;
+
+	/**
+     * \brief Replaces the hall of fame with the one saved in the file
+     * \param path_to_file File to read
+     * \return True if the file was read and its networks have the same layout
+     */
+    bool loadHallOfFame(const std::string& path_to_file);
+
+	/**
+     * \brief Saves the hall of fame to the file
+     * \param path_to_file File to write
+     * \return True if the file was written
+     */
+    bool saveHallOfFame(const std::string& path_to_file) const;
+
 	/**
      * \brief Returns information about which generation is currently in progress (depends on the number of evolutions)
      * \return The current generation
@@ -75,7 +231,7 @@ public:
      * \brief Returns the current population
      * \return Container with units forming the population
      */
-    std::vector<Unit> population();
+    const std::vector<Unit>& population() const;
 
 	/**
      * \brief Returns an individual with a given index from the entire population
@@ -85,9 +241,56 @@ public:
     Unit& at(int index);
 
 private:
+	/**
+     * \brief Next population together with the fitness its parents were bred by
+     */
+    struct EvolvedPopulation
+    {
+        std::vector<Unit> population;
+        std::vector<float> parentsFitness;
+        HallOfFame hallOfFame;
+    };
+
+	/**
+     * \brief Breeds the next population from the given parents, so it can be done on any thread
+     * \param parents Population with the final fitness scores
+     * \param hallOfFame Archive offered the best parents, and used if they are too weak to breed from
+     * \return The next population, with the indexes assigned
+     */
+    std::vector<Unit> nextPopulation(std::vector<Unit> parents, HallOfFame& hallOfFame) const;
+
+	/**
+     * \brief Tells the parents to the optimizer and asks it for the next population
+     * \param parents Population with the final fitness scores
+     * \return The next population of the full size, without the indexes assigned
+     */
+    std::vector<Unit> askOptimizer(const std::vector<Unit>& parents) const;
+
+	/**
+     * \brief Collects the fitness of every unit
+     * \param population Population whose fitness is collected
+     * \return Fitness scores in the order of the units
+     */
+    static std::vector<float> fitnessOf(const std::vector<Unit>& population);
 
 	/**
-	 * \brief  Mixes two parents and returns their child.
+     * \brief Creates units with random weights ranging from -1 to 1.
+     * \return Random population of the full size
+     */
+    std::vector<Unit> randomPopulation() const;
+
+	/**
+     * \brief Creates units starting from the archived networks. The first units are exact copies
+     * with their archived fitness, the following ones are their mutated copies, and the last
+     * quarter gets random weights to keep the gene pool wide.
+     *
+     * \param hallOfFame Archive from which the networks are taken
+     * \return Population of the full size, random if the archive is empty
+     */
+    std::vector<Unit> seededPopulation(const HallOfFame& hallOfFame) const;
+
+	/**
+	 * \brief  Mixes two parents and returns their child. The parents stay unchanged.
 	 * The child inherits part of the weights of one parent and part of the other parent.
 	 *
 	 * \param parentA One of the parents from which the weights are taken
@@ -107,49 +310,44 @@ private:
      * \brief It checks if the best unit is not so hopeless already at the start that
      * it prevents or delays too much the development of the network.
      *
+     * \param population Population with the final fitness scores
      * \return True if the best individual has too bad fitness score to continue
      */
-    bool doesBestUnitFailed();
-
-	/**
-     * \brief Cleans up the entire population
-     */
-    void clearPopulation();
-
-	/**
-     * \brief Restarts the game if the best unit is too weak.
-     * Then its development will be practically impossible or too slow.
-     */
-    void resetIfTheBestUnitIsTooWeak();
+    static bool doesBestUnitFailed(const std::vector<Unit>& population);
 
 	/**
      * \brief Selects a random two units from the best and mixes their weights to form their child
+     * \param sortedPopulation Population sorted by fitness score in descending order
      * \return A mixture of the random weights of the top random two units
      */
-    std::unique_ptr<Unit> crossoverTwoRandomBestUnits();
+    std::unique_ptr<Unit> crossoverTwoRandomBestUnits(const std::vector<Unit>& sortedPopulation) const;
+
+    /**
+     * \brief Breeds several children of the random top units and keeps the one the surrogate predicts best
+     * \param sortedPopulation Population sorted by fitness score in descending order
+     * \return The mutated child that is going to be played
+     */
+    std::unique_ptr<Unit> screenedCrossoverOfRandomBestUnits(const std::vector<Unit>& sortedPopulation) const;
 
     /**
-     * \brief Selects two random units and mixes their weights to form their child
-     * \return A mixture of the random weights of two random units
+     * \brief Selects a random unit and copies it
+     * \param population Population from which the unit is selected
+     * \return A copy of the random unit
      */
-    std::unique_ptr<Unit> crossoverTwoRandomUnits();
+    std::unique_ptr<Unit> crossoverTwoRandomUnits(const std::vector<Unit>& population) const;
 
     /**
      * \brief Selects two units from the best and mixes their weights to form their child
+     * \param sortedPopulation Population sorted by fitness score in descending order
      * \return A mixture of the random weights of the top two units
      */
-    std::unique_ptr<Unit> crossoverTwoBestUnits();
+    std::unique_ptr<Unit> crossoverTwoBestUnits(const std::vector<Unit>& sortedPopulation) const;
 
 	/**
 	 * \brief Reassigns the indexes inside population starting from zero to the end
+	 * \param population Population whose indexes are assigned
 	 */
-	void reassignIndexes();
-
-	/**
-     * \brief Assigns a new population by reassigning indexes
-     * \param sortedPopulation Population to be assigned
-     */
-    void reassignPopulation(std::vector<Unit> sortedPopulation);
+	static void reassignIndexes(std::vector<Unit>& population);
 
 	/**
      * \brief All weak birds are swapped for crossover between the best units and a few random ones
@@ -157,18 +355,7 @@ private:
      * \return Returns a population where the top units stay the same and the weaker
      * ones are swapped out with a mix of the better ones
      */
-    std::vector<Unit> replaceWeakBirdsWithCrossovers(std::vector<Unit>&& sortedPopulationByFitness);
-
-	/**
-     * \brief Evolves the current population by replacing weak birds with a mix of better ones
-     */
-    void evolveWeakUnits();
-
-	/**
-     * \brief Returns the best individuals from the current population
-     * \return Best units from the current population
-     */
-    std::vector<Unit> bestUnits();
+    std::vector<Unit> replaceWeakBirdsWithCrossovers(const std::vector<Unit>& sortedPopulationByFitness) const;
 
 private:
     /**
@@ -177,9 +364,15 @@ private:
      */
     static inline float minimumFitnessScore = 2.f;
 
+    /** Maximum number of networks in the hall of fame */
+    static constexpr std::size_t HALL_OF_FAME_CAPACITY = 20;
+
     /** Size of the population */
     int mSizeOfPopulation;
 
+    /** How strongly the offspring are mutated */
+    Mutation mMutation;
+
     /** Size of how much of the population might consider to be top units */
     int mTopUnits;
 
@@ -191,4 +384,39 @@ private:
 
     /** Number indicating the current generation iteration */
     int mCurrentGeneration;
+
+    /** The best units that finished their run in the steady-state evolution, sorted by fitness */
+    std::vector<Unit> mEliteArchive;
+
+    /** Number of units replaced one by one since the generation counter was advanced */
+    int mReplacedUnits;
+
+    /** Next population being bred on the background thread. Not valid if nothing is being bred. */
+    std::future<EvolvedPopulation> mNextPopulation;
+
+    /** Fitness of every unit of the previous population, as it was used in breeding */
+    std::vector<float> mParentsFitness;
+
+    /** The best networks ever seen, offered the top units of every bred population */
+    HallOfFame mHallOfFame;
+
+    /** Backend breeding the populations, used only by the breeding thread. Null means the built-in genetic algorithm. */
+    std::unique_ptr<Optimizer> mOptimizer;
+
+    /** Model screening the offspring, used only by the breeding thread. Null means every offspring is played. */
+    std::unique_ptr<FitnessSurrogate> mSurrogate;
+
+    /** Draws the cut points of the crossover. Like the population, used by a single thread at a time. */
+    mutable std::mt19937 mRandomGenerator;
 };
+
+
+// ---------- Inline ------------ //
+
+template <typename Perform>
+void GeneticAlgorithm::Unit::performOnPredictedOutput(std::initializer_list<fann_type> input, Perform&& perform) const
+{
+    // The inputs stay on the stack and the action is called directly, so running the network allocates nothing
+    assert(input.size() == fann_get_num_input(ann));
+    perform(fann_run(ann, const_cast<fann_type*>(input.begin())));
+}
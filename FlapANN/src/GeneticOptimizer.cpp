@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "GeneticOptimizer.h"
+
+GeneticOptimizer::GeneticOptimizer(int topEvolvingUnits, const std::vector<unsigned>& layers) :
+	mGeneticAlgorithm(topEvolvingUnits + 1, topEvolvingUnits,
+	                  { layers.front(), std::vector<int>(layers.begin() + 1, layers.end() - 1), layers.back() })
+{
+	assert(layers.size() >= 2);
+}
+
+std::vector<Optimizer::Genome> GeneticOptimizer::ask(std::size_t numberOfCandidates)
+{
+	mGeneticAlgorithm.setPopulationSize(static_cast<int>(numberOfCandidates));
+	if (mGeneticAlgorithm.population().empty())
+	{
+		mGeneticAlgorithm.createPopulation();
+	}
+	else
+	{
+		mGeneticAlgorithm.evolve();
+	}
+
+	std::vector<Genome> candidates;
+	candidates.reserve(numberOfCandidates);
+	for (const auto& unit : mGeneticAlgorithm.population())
+	{
+		candidates.push_back(genomeOf(unit.ann));
+	}
+	return candidates;
+}
+
+void GeneticOptimizer::tell(const std::vector<Genome>& candidates, const std::vector<float>& fitness)
+{
+	assert(candidates.size() == fitness.size());
+	assert(candidates.size() == mGeneticAlgorithm.population().size());
+
+	// The candidates do not have to be the asked ones, so the genomes are written back as well
+	for (std::size_t i = 0; i < candidates.size(); ++i)
+	{
+		auto& unit = mGeneticAlgorithm.at(static_cast<int>(i));
+		applyGenome(candidates[i], unit.ann);
+		unit.fitness = fitness[i];
+	}
+}
+
+const char* GeneticOptimizer::name() const
+{
+	return "Genetic";
+}
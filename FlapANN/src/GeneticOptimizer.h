@@ -0,0 +1,27 @@
+#pragma once
+
+#include "GeneticAlgorithm.h"
+#include "Optimizer.h"
+
+/**
+ * \brief The built-in genetic algorithm behind the interface of the optimizers, so it can be
+ * compared with the other backends on the same terms
+ */
+class GeneticOptimizer final : public Optimizer
+{
+public:
+	/**
+	 * \brief Creates the genetic algorithm. Its population is created by the first ask.
+	 * \param topEvolvingUnits How many of the best units are used in evolution process
+	 * \param layers Number of neurons in every layer of the networks
+	 */
+	GeneticOptimizer(int topEvolvingUnits, const std::vector<unsigned>& layers);
+
+	std::vector<Genome> ask(std::size_t numberOfCandidates) override;
+	void tell(const std::vector<Genome>& candidates, const std::vector<float>& fitness) override;
+	const char* name() const override;
+
+private:
+	/** Algorithm whose population holds the candidates */
+	GeneticAlgorithm mGeneticAlgorithm;
+};
@@ -0,0 +1,179 @@
+#include "pch.h"
+#include "HallOfFame.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "FitnessCache.h"
+
+namespace
+{
+	constexpr char FILE_MAGIC[8] = { 'F', 'L', 'A', 'P', 'H', 'O', 'F', '1' };
+
+	template <typename T>
+	void writeValue(std::ofstream& file, const T& value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool readValue(const char*& cursor, const char* end, T& value)
+	{
+		if (static_cast<std::size_t>(end - cursor) < sizeof(T))
+			return false;
+		std::memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+
+	/**
+	 * \brief Returns the number of the connections of the network, after which the steepness starts in its genome
+	 */
+	std::size_t numberOfConnections(const std::vector<unsigned>& layers)
+	{
+		auto* ann = fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data());
+		const auto connections = static_cast<std::size_t>(ann->total_connections);
+		fann_destroy(ann);
+		return connections;
+	}
+}
+
+HallOfFame::HallOfFame(std::size_t capacity) :
+	mCapacity(capacity),
+	mRevision(0)
+{
+}
+
+bool HallOfFame::offer(const fann* ann, float fitness, int generation)
+{
+	const auto isFull = mMembers.size() >= mCapacity;
+	if (mCapacity == 0 || (isFull && fitness <= mMembers.back().fitness))
+	{
+		return false;
+	}
+
+	const auto hash = FitnessCache::hashOf(ann);
+	const auto sameGenome = [hash](const Member& member) { return member.hash == hash; };
+	if (std::any_of(mMembers.cbegin(), mMembers.cend(), sameGenome))
+	{
+		return false;
+	}
+
+	Member member{ Optimizer::genomeOf(ann), fitness, generation, hash };
+
+	const auto isBetter = [](const Member& a, const Member& b) { return a.fitness > b.fitness; };
+	mMembers.insert(std::upper_bound(mMembers.begin(), mMembers.end(), member, isBetter), std::move(member));
+	if (mMembers.size() > mCapacity)
+	{
+		mMembers.pop_back();
+	}
+	++mRevision;
+	return true;
+}
+
+const std::vector<HallOfFame::Member>& HallOfFame::members() const
+{
+	return mMembers;
+}
+
+std::uint64_t HallOfFame::revision() const
+{
+	return mRevision;
+}
+
+bool HallOfFame::save(const std::string& path_to_file, const std::vector<unsigned>& layers) const
+{
+	std::ofstream file(path_to_file, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+	writeValue(file, static_cast<std::uint32_t>(layers.size()));
+	for (const auto neurons : layers)
+	{
+		writeValue(file, static_cast<std::uint32_t>(neurons));
+	}
+
+	// The weights and the steepness are written as two separate series of genes
+	const auto connections = numberOfConnections(layers);
+	writeValue(file, static_cast<std::uint32_t>(mMembers.size()));
+	for (const auto& member : mMembers)
+	{
+		assert(member.genome.size() >= connections);
+		const auto steepness = member.genome.size() - connections;
+		writeValue(file, member.fitness);
+		writeValue(file, member.generation);
+		writeValue(file, static_cast<std::uint32_t>(connections));
+		file.write(reinterpret_cast<const char*>(member.genome.data()), connections * sizeof(fann_type));
+		writeValue(file, static_cast<std::uint32_t>(steepness));
+		file.write(reinterpret_cast<const char*>(member.genome.data() + connections), steepness * sizeof(fann_type));
+	}
+	return static_cast<bool>(file);
+}
+
+bool HallOfFame::load(const std::string& path_to_file, const std::vector<unsigned>& layers)
+{
+	std::ifstream file(path_to_file, std::ios::binary);
+	const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	const char* cursor = bytes.data();
+	const char* end = bytes.data() + bytes.size();
+
+	char magic[sizeof(FILE_MAGIC)];
+	if (!readValue(cursor, end, magic) || std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+		return false;
+
+	// Networks of a different layout can not be used, so the whole archive is rejected
+	std::uint32_t numberOfLayers;
+	if (!readValue(cursor, end, numberOfLayers) || numberOfLayers != layers.size())
+		return false;
+	for (const auto neurons : layers)
+	{
+		std::uint32_t savedNeurons;
+		if (!readValue(cursor, end, savedNeurons) || savedNeurons != neurons)
+			return false;
+	}
+
+	auto readGenes = [&cursor, end](std::vector<fann_type>& genes)
+	{
+		std::uint32_t numberOfGenes;
+		if (!readValue(cursor, end, numberOfGenes) || static_cast<std::size_t>(end - cursor) < numberOfGenes * sizeof(fann_type))
+			return false;
+		genes.resize(numberOfGenes);
+		std::memcpy(genes.data(), cursor, numberOfGenes * sizeof(fann_type));
+		cursor += numberOfGenes * sizeof(fann_type);
+		return true;
+	};
+
+	// The networks are rebuilt to compute their hashes, the same way the archived ones were
+	auto* ann = fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data());
+	const auto [firstNeuron, lastNeuron] = Optimizer::neuronsOf(ann);
+	const auto numberOfNeurons = static_cast<std::size_t>(lastNeuron - firstNeuron);
+
+	HallOfFame hallOfFame(mCapacity);
+	std::uint32_t numberOfMembers;
+	auto isValid = readValue(cursor, end, numberOfMembers);
+	for (std::uint32_t index = 0; isValid && index < numberOfMembers; ++index)
+	{
+		Member member{};
+		std::vector<fann_type> steepness;
+		isValid = readValue(cursor, end, member.fitness) && readValue(cursor, end, member.generation) &&
+		          readGenes(member.genome) && readGenes(steepness) &&
+		          member.genome.size() == ann->total_connections && steepness.size() == numberOfNeurons;
+		if (isValid)
+		{
+			member.genome.insert(member.genome.end(), steepness.cbegin(), steepness.cend());
+			Optimizer::applyGenome(member.genome, ann);
+			hallOfFame.offer(ann, member.fitness, member.generation);
+		}
+	}
+	fann_destroy(ann);
+
+	if (!isValid)
+		return false;
+	mMembers = std::move(hallOfFame.mMembers);
+	++mRevision;
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Optimizer.h"
+#include "fann/fann.h"
+
+/**
+ * \brief The best networks ever seen during the training, kept across resets and runs.
+ *
+ * Members are plain copies of the genes, not the networks themselves, so the archive is
+ * cheap to copy and can be handed over to the thread breeding the next population. Every
+ * network is kept only once, even if it was offered in many generations. The archive can
+ * be saved to and loaded from a file, so the next run of the game starts from the champions
+ * of the previous one instead of random weights.
+ */
+class HallOfFame
+{
+public:
+	/**
+	 * \brief Genes of a single archived network
+	 */
+	struct Member
+	{
+		/** Weights of all the connections followed by the steepness of every neuron */
+		Optimizer::Genome genome;
+
+		/** Fitness with which the network entered the archive */
+		float fitness;
+
+		/** Generation in which the network entered the archive */
+		std::int32_t generation;
+
+		/** Hash of the network, used to keep each network only once */
+		std::uint64_t hash;
+	};
+
+	/**
+	 * \brief Creates the empty archive
+	 * \param capacity Maximum number of archived networks
+	 */
+	explicit HallOfFame(std::size_t capacity);
+
+	/**
+	 * \brief Archives the network if it is better than the worst archived one and is not archived yet
+	 * \param ann Network to archive, it is only read
+	 * \param fitness Fitness of the network
+	 * \param generation Generation in which the network got its fitness
+	 * \return True if the network entered the archive
+	 */
+	bool offer(const fann* ann, float fitness, int generation);
+
+	/**
+	 * \brief Returns the archived networks
+	 * \return Members sorted by fitness in descending order
+	 */
+	const std::vector<Member>& members() const;
+
+	/**
+	 * \brief Returns the number that changes every time the archive does
+	 * \return Revision of the archive
+	 */
+	std::uint64_t revision() const;
+
+	/**
+	 * \brief Saves the archive to the file, replacing its previous content
+	 * \param path_to_file File to write
+	 * \param layers Number of neurons in every layer of the archived networks
+	 * \return True if the file was written
+	 */
+	bool save(const std::string& path_to_file, const std::vector<unsigned>& layers) const;
+
+	/**
+	 * \brief Replaces the archive with the one saved in the file
+	 * \param path_to_file File to read
+	 * \param layers Number of neurons in every layer the networks are expected to have
+	 * \return True if the file was read. The archive stays unchanged otherwise, also if the layers do not match.
+	 */
+	bool load(const std::string& path_to_file, const std::vector<unsigned>& layers);
+
+private:
+	/** Maximum number of archived networks */
+	std::size_t mCapacity;
+
+	/** Archived networks sorted by fitness in descending order */
+	std::vector<Member> mMembers;
+
+	/** Number of changes of the archive */
+	std::uint64_t mRevision;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <optional>
+
+/**
+ * \brief Fixed-size queue passing values from exactly one producer thread to exactly one consumer thread.
+ * \tparam T Type of the passed values
+ * \tparam Capacity Maximum number of values waiting in the queue, has to be a power of two
+ *
+ * Neither of the threads ever waits for the other one. The producer only moves the head
+ * and the consumer only moves the tail, so no locks are needed. When the queue is full,
+ * the new value is rejected instead of waiting for the consumer.
+ */
+template <typename T, std::size_t Capacity>
+class LockFreeRing
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+
+public:
+	/**
+	 * \brief Puts the value at the end of the queue. Called only by the producer.
+	 * \param value Value to put
+	 * \return True if the value was put, false if the queue is full
+	 */
+	bool tryPush(const T& value);
+
+	/**
+	 * \brief Takes the value from the front of the queue. Called only by the consumer.
+	 * \return The oldest value, or nothing if the queue is empty
+	 */
+	std::optional<T> tryPop();
+
+private:
+	/** Values waiting in the queue */
+	std::array<T, Capacity> mValues{};
+
+	/** Number of values ever pushed. Kept in a separate cache line, as the other thread writes the tail. */
+	alignas(64) std::atomic<std::size_t> mHead{ 0 };
+
+	/** Number of values ever popped */
+	alignas(64) std::atomic<std::size_t> mTail{ 0 };
+};
+
+
+// ---------- Inline ------------ //
+
+template <typename T, std::size_t Capacity>
+bool LockFreeRing<T, Capacity>::tryPush(const T& value)
+{
+	const auto head = mHead.load(std::memory_order_relaxed);
+	if (head - mTail.load(std::memory_order_acquire) == Capacity)
+		return false;
+
+	mValues[head & (Capacity - 1)] = value;
+	mHead.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, std::size_t Capacity>
+std::optional<T> LockFreeRing<T, Capacity>::tryPop()
+{
+	const auto tail = mTail.load(std::memory_order_relaxed);
+	if (tail == mHead.load(std::memory_order_acquire))
+		return std::nullopt;
+
+	auto value = mValues[tail & (Capacity - 1)];
+	mTail.store(tail + 1, std::memory_order_release);
+	return value;
+}
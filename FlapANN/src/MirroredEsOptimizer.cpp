@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "MirroredEsOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+	constexpr double ADAM_FIRST_DECAY = 0.9;
+	constexpr double ADAM_SECOND_DECAY = 0.999;
+	constexpr double ADAM_EPSILON = 1e-8;
+}
+
+MirroredEsOptimizer::MirroredEsOptimizer(Genome initialMean, float noiseDeviation, float learningRate) :
+	mMean(initialMean.cbegin(), initialMean.cend()),
+	mNoiseDeviation(noiseDeviation),
+	mLearningRate(learningRate),
+	mFirstMoment(mMean.size(), 0.),
+	mSecondMoment(mMean.size(), 0.),
+	mGeneration(0),
+	mRandomGenerator(std::random_device{}())
+{
+	assert(noiseDeviation > 0.f);
+}
+
+std::vector<Optimizer::Genome> MirroredEsOptimizer::ask(std::size_t numberOfCandidates)
+{
+	const auto numberOfPairs = numberOfCandidates / 2;
+	std::vector<Genome> candidates(numberOfCandidates, Genome(mMean.size()));
+	std::normal_distribution<double> normal(0., mNoiseDeviation);
+	for (std::size_t pair = 0; pair < numberOfPairs; ++pair)
+	{
+		auto& positive = candidates[2 * pair];
+		auto& negative = candidates[2 * pair + 1];
+		for (std::size_t gene = 0; gene < mMean.size(); ++gene)
+		{
+			const auto noise = normal(mRandomGenerator);
+			positive[gene] = static_cast<fann_type>(mMean[gene] + noise);
+			negative[gene] = static_cast<fann_type>(mMean[gene] - noise);
+		}
+	}
+
+	// An odd candidate left without a pair is the mean itself, so its fitness is known as well
+	if (numberOfCandidates % 2 != 0)
+	{
+		std::transform(mMean.cbegin(), mMean.cend(), candidates.back().begin(), [](double gene) { return static_cast<fann_type>(gene); });
+	}
+	return candidates;
+}
+
+void MirroredEsOptimizer::tell(const std::vector<Genome>& candidates, const std::vector<float>& fitness)
+{
+	assert(candidates.size() == fitness.size());
+	const auto numberOfCandidates = candidates.size();
+	if (numberOfCandidates < 2)
+	{
+		return;
+	}
+
+	// Candidates that were not drawn by this strategy, like the very first population, are not
+	// spread around the mean, so the best of them is simply taken as the starting point
+	if (mGeneration++ == 0)
+	{
+		const auto best = std::max_element(fitness.cbegin(), fitness.cend()) - fitness.cbegin();
+		mMean.assign(candidates[best].cbegin(), candidates[best].cend());
+		return;
+	}
+
+	// Centered ranks ranging from -0.5 for the worst to 0.5 for the best candidate
+	std::vector<std::size_t> ranking(numberOfCandidates);
+	std::iota(ranking.begin(), ranking.end(), 0);
+	std::sort(ranking.begin(), ranking.end(), [&fitness](std::size_t a, std::size_t b) { return fitness[a] < fitness[b]; });
+	std::vector<double> utility(numberOfCandidates);
+	for (std::size_t rank = 0; rank < numberOfCandidates; ++rank)
+	{
+		utility[ranking[rank]] = static_cast<double>(rank) / (numberOfCandidates - 1) - 0.5;
+	}
+
+	// The noise of every candidate is recovered from the genome, so any candidates can be told
+	const auto dimension = mMean.size();
+	const auto gradientScale = 1. / (numberOfCandidates * mNoiseDeviation * mNoiseDeviation);
+	const auto step = mGeneration - 1;
+	const auto firstCorrection = 1. - std::pow(ADAM_FIRST_DECAY, step);
+	const auto secondCorrection = 1. - std::pow(ADAM_SECOND_DECAY, step);
+	for (std::size_t gene = 0; gene < dimension; ++gene)
+	{
+		auto gradient = 0.;
+		for (std::size_t candidate = 0; candidate < numberOfCandidates; ++candidate)
+		{
+			assert(candidates[candidate].size() == dimension);
+			gradient += utility[candidate] * (candidates[candidate][gene] - mMean[gene]);
+		}
+		gradient *= gradientScale;
+
+		// Ascent, as the fitness is maximized
+		mFirstMoment[gene] = ADAM_FIRST_DECAY * mFirstMoment[gene] + (1. - ADAM_FIRST_DECAY) * gradient;
+		mSecondMoment[gene] = ADAM_SECOND_DECAY * mSecondMoment[gene] + (1. - ADAM_SECOND_DECAY) * gradient * gradient;
+		const auto firstMoment = mFirstMoment[gene] / firstCorrection;
+		const auto secondMoment = mSecondMoment[gene] / secondCorrection;
+		mMean[gene] += mLearningRate * firstMoment / (std::sqrt(secondMoment) + ADAM_EPSILON);
+	}
+}
+
+const char* MirroredEsOptimizer::name() const
+{
+	return "Mirrored ES";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <random>
+
+#include "Optimizer.h"
+
+/**
+ * \brief Natural evolution strategy with mirrored sampling.
+ *
+ * Every noise vector is used twice, once added to the mean genome and once subtracted from it,
+ * which cancels most of the noise of the gradient estimate. The fitness is replaced by centered
+ * ranks, so a few lucky runs can not dominate the step, and the mean is moved by the Adam
+ * optimizer along the estimated gradient. The step size stays fixed.
+ */
+class MirroredEsOptimizer final : public Optimizer
+{
+public:
+	/**
+	 * \brief Creates the strategy
+	 * \param initialMean Genome around which the first candidates are drawn
+	 * \param noiseDeviation Standard deviation of the noise added to the mean
+	 * \param learningRate Step of the Adam optimizer
+	 */
+	MirroredEsOptimizer(Genome initialMean, float noiseDeviation = 0.1f, float learningRate = 0.03f);
+
+	std::vector<Genome> ask(std::size_t numberOfCandidates) override;
+	void tell(const std::vector<Genome>& candidates, const std::vector<float>& fitness) override;
+	const char* name() const override;
+
+private:
+	/** Center of the distribution of the candidates */
+	std::vector<double> mMean;
+
+	/** Standard deviation of the noise */
+	double mNoiseDeviation;
+
+	/** Step of the Adam optimizer */
+	double mLearningRate;
+
+	/** Running average of the gradient */
+	std::vector<double> mFirstMoment;
+
+	/** Running average of the squared gradient */
+	std::vector<double> mSecondMoment;
+
+	/** Number of updates made so far */
+	int mGeneration;
+
+	/** Draws the noise of the candidates */
+	std::mt19937 mRandomGenerator;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "fann/fann.h"
+
+/**
+ * \brief Measures the mean time of a single run of a network over the states
+ * \tparam Run Callable taking the inputs of a single state and returning the first output of the network
+ * \param states Inputs of the network, one state after another
+ * \param numberOfInputs Number of the inputs of a single state
+ * \param passes Number of times every state is run
+ * \param run Runs the network on a single state
+ * \return Nanoseconds of a single run, or zero if there are no states
+ *
+ * The outputs are summed up and the sum is written to a volatile variable,
+ * so the compiler can not optimize the timed runs away.
+ */
+template <typename Run>
+float nanosecondsPerRun(const std::vector<fann_type>& states, std::size_t numberOfInputs, int passes, Run&& run)
+{
+	const auto numberOfStates = states.size() / numberOfInputs;
+	auto sink = 0.f;
+	const auto start = std::chrono::steady_clock::now();
+	for (auto pass = 0; pass < passes; ++pass)
+	{
+		for (std::size_t state = 0; state < numberOfStates; ++state)
+		{
+			sink += run(states.data() + state * numberOfInputs);
+		}
+	}
+	const std::chrono::duration<float, std::nano> time = std::chrono::steady_clock::now() - start;
+
+	volatile auto usedSink = sink;
+	static_cast<void>(usedSink);
+	return numberOfStates == 0 || passes <= 0 ? 0.f : time.count() / static_cast<float>(numberOfStates * passes);
+}
@@ -8,7 +8,8 @@
 
 NodeScene::NodeScene() :
 	mPinnedNodes(),
-	mParent(nullptr)
+	mParent(nullptr),
+	mIsWorldTransformDirty(true)
 {
 }
 
@@ -16,6 +17,7 @@ void NodeScene::pinNode(Node node)
 {
 	// Now this Scene is mParent of given node
 	node->mParent = this;
+	node->markWorldTransformDirty();
 
 	// So lets add it into mPinnedNodes of this Scene
 	mPinnedNodes.push_back(std::move(node));
@@ -40,32 +42,124 @@ NodeScene::Node NodeScene::unpinNode(const NodeScene& node_scene)
 	// Right now the stolen_node is not part of this Scene anymore.
 	// We may remove its "parentness"
 	stolenNode->mParent = nullptr;
+	stolenNode->markWorldTransformDirty();
 
 	return stolenNode;
 }
 
 sf::Vector2f NodeScene::absolutePosition() const
+{
+	// By applying the world transform on empty Vector2f we move it to the desired position
+	return worldTransform() * sf::Vector2f();
+}
+
+const sf::Transform& NodeScene::worldTransform() const
 {
 	// To do this we have to add all transforms till the top of the hierarchy.
-	sf::Transform transform; //sf::Transform::Identity;
-	for (const auto* node = this; node != nullptr; node = node->mParent)
-		transform = node->getTransform() * transform;
-	
-	// By applying this transform on empty Vector2f we move it to the desired position
-	return transform * sf::Vector2f();
+	// But as long as nothing up there has moved, the previous result is still valid
+	if (mIsWorldTransformDirty)
+	{
+		mWorldTransform = (mParent != nullptr) ? mParent->worldTransform() * getTransform() : getTransform();
+		mIsWorldTransformDirty = false;
+	}
+	return mWorldTransform;
 }
 
-void NodeScene::draw(sf::RenderTarget& target, sf::RenderStates states) const
+void NodeScene::markWorldTransformDirty()
+{
+	// If this node is already dirty, then so are all the pinned nodes,
+	// as none of them could calculate its transform without this node
+	if (mIsWorldTransformDirty)
+		return;
+
+	mIsWorldTransformDirty = true;
+	for (const auto& pinnedNode : mPinnedNodes)
+		pinnedNode->markWorldTransformDirty();
+}
+
+void NodeScene::setPosition(float x, float y)
+{
+	Transformable::setPosition(x, y);
+	markWorldTransformDirty();
+}
+
+void NodeScene::setPosition(const sf::Vector2f& position)
+{
+	Transformable::setPosition(position);
+	markWorldTransformDirty();
+}
+
+void NodeScene::setRotation(float angle)
+{
+	Transformable::setRotation(angle);
+	markWorldTransformDirty();
+}
+
+void NodeScene::setScale(float factorX, float factorY)
+{
+	Transformable::setScale(factorX, factorY);
+	markWorldTransformDirty();
+}
+
+void NodeScene::setScale(const sf::Vector2f& factors)
+{
+	Transformable::setScale(factors);
+	markWorldTransformDirty();
+}
+
+void NodeScene::setOrigin(float x, float y)
+{
+	Transformable::setOrigin(x, y);
+	markWorldTransformDirty();
+}
+
+void NodeScene::setOrigin(const sf::Vector2f& origin)
+{
+	Transformable::setOrigin(origin);
+	markWorldTransformDirty();
+}
+
+void NodeScene::move(float offsetX, float offsetY)
+{
+	Transformable::move(offsetX, offsetY);
+	markWorldTransformDirty();
+}
+
+void NodeScene::move(const sf::Vector2f& offset)
 {
-	// We want to draw this object in relation to the mParent
-	// states.transform stores information about mParent scene render position
-	// by multiplying it by our getTransform() position we get position related
-	// to our mParent
+	Transformable::move(offset);
+	markWorldTransformDirty();
+}
 
-	states.transform *= getTransform(); // Absolute world transform is result of this operation
+void NodeScene::rotate(float angle)
+{
+	Transformable::rotate(angle);
+	markWorldTransformDirty();
+}
+
+void NodeScene::scale(float factorX, float factorY)
+{
+	Transformable::scale(factorX, factorY);
+	markWorldTransformDirty();
+}
+
+void NodeScene::scale(const sf::Vector2f& factor)
+{
+	Transformable::scale(factor);
+	markWorldTransformDirty();
+}
+
+void NodeScene::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	// We want to draw this object in relation to the whole scene.
+	// states.transform stores information about the render position of
+	// the scene, by multiplying it by our cached world transform we get
+	// the position without going through all the parents again
+	auto thisStates = states;
+	thisStates.transform *= worldTransform();
 
 	// As our object is in the right position, we can finally draw it
-	drawThis(target, states);
+	drawThis(target, thisStates);
 
 	// Right after we did this, we can forward drawing to the nodes lower in the hierarchy.
 	// This way we will draw all nodes to the screen starting from the root.
@@ -44,6 +44,11 @@
  *     +----+  +----+  +----+     +----+
  *       (4)     (5)     (6)
  *
+ * Each node remembers its absolute (world) transform and calculates it again only
+ * when it or any of its parents was moved, rotated or scaled. To make it possible
+ * all the functions changing the transform are shadowed by this class, so they
+ * should always be called on the node itself, not on the sf::Transformable.
+ *
  * It derives from sf::Drawable as it is suppossed to be drawn on the screen.
  * It derives from sf::Transformable which gives all members related with position, rotation and scale
  * It derives from sf::NonCopyable as NodeScene like this should not be copied (it may give many problems in current state)
@@ -80,6 +85,32 @@ public:
 	 */
 	sf::Vector2f absolutePosition() const;
 
+	/**
+	 * \brief Returns the absolute transform of this node, combining the transforms of all its parents.
+	 * \return The absolute transform of the node
+	 *
+	 * It is calculated only if this node or any of its parents has changed since the last call.
+	 */
+	const sf::Transform& worldTransform() const;
+
+
+	// ====== Transforming Scenes ====== //
+	// They work exactly the same as in sf::Transformable, but they
+	// also let the pinned nodes know that their world transform changed
+
+	void setPosition(float x, float y);
+	void setPosition(const sf::Vector2f& position);
+	void setRotation(float angle);
+	void setScale(float factorX, float factorY);
+	void setScale(const sf::Vector2f& factors);
+	void setOrigin(float x, float y);
+	void setOrigin(const sf::Vector2f& origin);
+	void move(float offsetX, float offsetY);
+	void move(const sf::Vector2f& offset);
+	void rotate(float angle);
+	void scale(float factorX, float factorY);
+	void scale(const sf::Vector2f& factor);
+
 	
 	// ====== Drawing Scenes ====== //
 
@@ -90,6 +121,9 @@ public:
 	 *
 	 * This function is provided inside sf::Drawable. Thanks to this if we pass this object to
 	 * sf::RenderWindow::draw(), then it will implicitly call this function to draw it!
+	 *
+	 * The transform of the states is the one applied on top of the whole scene,
+	 * each node adds to it its own cached world transform.
 	 */
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const override final;
 
@@ -147,6 +181,10 @@ public:
 	virtual void handleThisEvents(const sf::Event& event);
 
 private:
+	/**
+	 * \brief Marks the world transform of this node and all pinned nodes as outdated.
+	 */
+	void markWorldTransformDirty();
 
 	/**
 	 * \brief A list holding all the nodes attached (children) to this node
@@ -168,6 +206,12 @@ private:
 	 * Nullptr in case of there is no mParent.
 	 */
 	NodeScene* mParent;
+
+	/** The last calculated absolute transform of this node */
+	mutable sf::Transform mWorldTransform;
+
+	/** Flag determining if the world transform has to be calculated again */
+	mutable bool mIsWorldTransformDirty;
 };
 
 #endif
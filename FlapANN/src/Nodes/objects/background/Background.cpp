@@ -10,6 +10,6 @@ Background::Background(const TextureManager& textureManager, const float& scroll
 
 void Background::loadResources(TextureManager& textureManager)
 {
-	textureManager.storeResource(Textures_ID::Background_Day, "resources/textures/background/background.png");
-	textureManager.getResourceReference(Textures_ID::Background_Day).setRepeated(true);
+	textureManager.queueResource(Textures_ID::Background_Day, "resources/textures/background/background.png",
+		[](sf::Texture& texture) { texture.setRepeated(true); });
 }
\ No newline at end of file
@@ -16,7 +16,7 @@ public:
 	Background(const TextureManager& textureManager, const float& scrollSpeed = 10.f);
 
 	/**
-	 * \brief Loads the required resources for this class
+	 * \brief Queues the required resources for this class to be loaded
 	 * \param textureManager Texture storage manager
 	 */
 	static void loadResources(TextureManager& textureManager);
@@ -10,6 +10,6 @@ Ground::Ground(const TextureManager& textureManager, const float& scrollSpeed)
 
 void Ground::loadResources(TextureManager& textureManager)
 {
-	textureManager.storeResource(Textures_ID::Ground, "resources/textures/background/ground.png");
-	textureManager.getResourceReference(Textures_ID::Ground).setRepeated(true);
+	textureManager.queueResource(Textures_ID::Ground, "resources/textures/background/ground.png",
+		[](sf::Texture& texture) { texture.setRepeated(true); });
 }
\ No newline at end of file
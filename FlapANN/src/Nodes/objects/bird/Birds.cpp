@@ -0,0 +1,220 @@
+#include "pch.h"
+#include "Birds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/** Speed in degrees per second with which the bird turns up or down */
+	constexpr float ROTATION_SPEED = 300.f;
+
+	/**
+	 * \brief Brings the angle into the range of [0, 360), exactly as sf::Transformable does
+	 * \param angle Angle in degrees
+	 * \return The same angle in the range of [0, 360)
+	 */
+	float normalizedRotation(float angle)
+	{
+		auto rotation = static_cast<float>(std::fmod(angle, 360.f));
+		if (rotation < 0)
+		{
+			rotation += 360.f;
+		}
+		return rotation;
+	}
+}
+
+Birds::Birds(const TextureManager& textureManager)
+	: mTextureManager(textureManager)
+{
+}
+
+std::uint8_t Birds::lookOf(Textures_ID birdTexture)
+{
+	const auto look = std::find(mLookTextures.cbegin(), mLookTextures.cend(), birdTexture);
+	if (look != mLookTextures.cend())
+	{
+		return static_cast<std::uint8_t>(look - mLookTextures.cbegin());
+	}
+
+	auto sprite = mTextureManager.sprite(birdTexture);
+	sprite.setOrigin(sprite.getLocalBounds().width / 2.f, sprite.getLocalBounds().height / 2.f);
+	mLookTextures.push_back(birdTexture);
+	mLookSprites.push_back(sprite);
+	return static_cast<std::uint8_t>(mLookTextures.size() - 1);
+}
+
+void Birds::add(Textures_ID birdTexture, const State& state)
+{
+	mPositionsX.push_back(state.position.x);
+	mPositionsY.push_back(state.position.y);
+	mVelocitiesX.push_back(state.velocity.x);
+	mVelocitiesY.push_back(state.velocity.y);
+	mRotations.push_back(normalizedRotation(state.rotation));
+	mScores.push_back(state.score);
+	mIsDead.push_back(state.isDead);
+	mLookOfBird.push_back(lookOf(birdTexture));
+}
+
+void Birds::clear()
+{
+	mPositionsX.clear();
+	mPositionsY.clear();
+	mVelocitiesX.clear();
+	mVelocitiesY.clear();
+	mRotations.clear();
+	mScores.clear();
+	mIsDead.clear();
+	mLookOfBird.clear();
+}
+
+std::size_t Birds::size() const
+{
+	return mPositionsX.size();
+}
+
+void Birds::flap(std::size_t bird)
+{
+	if (!isDead(bird))
+	{
+		setVelocity(bird, { 0.f, -mJumpStrength });
+	}
+}
+
+void Birds::kill(std::size_t bird)
+{
+	mIsDead[bird] = true;
+}
+
+bool Birds::isDead(std::size_t bird) const
+{
+	return mIsDead[bird] != 0;
+}
+
+sf::Vector2f Birds::position(std::size_t bird) const
+{
+	return { mPositionsX[bird], mPositionsY[bird] };
+}
+
+void Birds::setPosition(std::size_t bird, const sf::Vector2f& position)
+{
+	mPositionsX[bird] = position.x;
+	mPositionsY[bird] = position.y;
+}
+
+sf::Vector2f Birds::velocity(std::size_t bird) const
+{
+	return { mVelocitiesX[bird], mVelocitiesY[bird] };
+}
+
+void Birds::setVelocity(std::size_t bird, const sf::Vector2f& velocity)
+{
+	mVelocitiesX[bird] = velocity.x;
+	mVelocitiesY[bird] = velocity.y;
+}
+
+float Birds::fitnessScore(std::size_t bird) const
+{
+	return mScores[bird];
+}
+
+Birds::State Birds::state(std::size_t bird) const
+{
+	return { position(bird), velocity(bird), mRotations[bird], mScores[bird], isDead(bird) };
+}
+
+void Birds::restoreState(std::size_t bird, const State& state)
+{
+	setPosition(bird, state.position);
+	setVelocity(bird, state.velocity);
+	mRotations[bird] = normalizedRotation(state.rotation);
+	mScores[bird] = state.score;
+	mIsDead[bird] = state.isDead;
+}
+
+float Birds::rotationSpeed(float velocityY, float rotation)
+{
+	static const auto& fallingThreshold = mJumpStrength * 0.7f;
+
+	const auto isFalling = velocityY - fallingThreshold > 0 && (rotation < 45 || rotation > (365 - 60));
+	if (isFalling)
+	{
+		return ROTATION_SPEED;
+	}
+	const auto isRaising = velocityY < 0 && (rotation > (365 - 45) || rotation < 60);
+	return isRaising ? -ROTATION_SPEED : 0.f;
+}
+
+void Birds::update(const sf::Time& deltaTime, bool updateDeadBirds)
+{
+	const auto seconds = deltaTime.asSeconds();
+	for (std::size_t bird = 0; bird < size(); ++bird)
+	{
+		if (!updateDeadBirds && mIsDead[bird])
+		{
+			continue;
+		}
+
+		mPositionsX[bird] += mVelocitiesX[bird] * seconds;
+		mPositionsY[bird] += mVelocitiesY[bird] * seconds;
+
+		// It falls down slowly
+		mVelocitiesY[bird] += mGravity * seconds;
+		mRotations[bird] = normalizedRotation(mRotations[bird] + rotationSpeed(mVelocitiesY[bird], mRotations[bird]) * seconds);
+		if (!mIsDead[bird])
+		{
+			mScores[bird] += seconds;
+		}
+	}
+}
+
+void Birds::handleEvents(const sf::Event& event)
+{
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space)
+	{
+		for (std::size_t bird = 0; bird < size(); ++bird)
+		{
+			flap(bird);
+		}
+	}
+}
+
+void Birds::draw(sf::RenderTarget& target, sf::RenderStates states, std::size_t bird) const
+{
+	states.transform.translate(position(bird)).rotate(mRotations[bird]);
+	target.draw(mLookSprites[mLookOfBird[bird]], states);
+}
+
+sf::FloatRect Birds::birdBounds(std::size_t bird) const
+{
+	const auto& birdTextureSize = mLookSprites[mLookOfBird[bird]].getLocalBounds();
+	auto birdHitboxSize = sf::Vector2f{
+		birdTextureSize.width / 1.5f,
+		birdTextureSize.height / 1.5f
+	};
+	auto birdTextureSizeDifference = sf::Vector2f{
+		birdTextureSize.width - birdHitboxSize.x,
+		birdTextureSize.height - birdHitboxSize.y
+	};
+	auto rectLeft = mPositionsX[bird] - birdTextureSize.width / 2.f + birdTextureSizeDifference.x;
+	auto rectTop = mPositionsY[bird] - birdTextureSize.width / 2.f + birdTextureSizeDifference.y;
+	return {rectLeft, rectTop, birdHitboxSize.x, birdHitboxSize.y};
+}
+
+float Birds::jumpStrength()
+{
+	return mJumpStrength;
+}
+
+float Birds::gravity()
+{
+	return mGravity;
+}
+
+void Birds::loadResources(TextureManager& textureManager)
+{
+	textureManager.queueResourceInAtlas(Textures_ID::Bird_Orange, "resources/textures/birds/bird_orange.png");
+	textureManager.queueResourceInAtlas(Textures_ID::Bird_Blue, "resources/textures/birds/bird_blue.png");
+	textureManager.queueResourceInAtlas(Textures_ID::Bird_Red, "resources/textures/birds/bird_red.png");
+}
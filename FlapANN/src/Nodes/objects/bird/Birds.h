@@ -0,0 +1,213 @@
+#pragma once
+#include <cstdint>
+
+#include "resources/Resources.h"
+
+
+/**
+ * \brief All the birds of the game, each of which can flop as well as die.
+ *
+ * The birds are not nodes of the scene. Everything the simulation touches in every tick
+ * (positions, velocities, rotations, scores and whether they are dead) is kept in separate
+ * contiguous arrays, and all the birds are updated in a single loop over them.
+ * A bird is identified by its index, which stays the same until the birds are cleared.
+ * Sprites are only needed to draw the birds, so there is one for each look, not for each bird.
+ */
+class Birds final
+{
+public:
+	/**
+	 * \brief Everything that changes in the bird while the game is running
+	 */
+	struct State
+	{
+		sf::Vector2f position;
+		sf::Vector2f velocity;
+		float rotation;
+		float score;
+		bool isDead;
+	};
+
+	/**
+	 * \brief The main constructor of the birds
+	 * \param textureManager Texture storage manager
+	 */
+	explicit Birds(const TextureManager& textureManager);
+
+	/**
+	 * \brief Adds the bird at the end
+	 * \param birdTexture Identifier of the texture the bird should take
+	 * \param state State in which the bird starts
+	 */
+	void add(Textures_ID birdTexture, const State& state);
+
+	/**
+	 * \brief Removes all the birds
+	 */
+	void clear();
+
+	/**
+	 * \brief Returns the number of birds
+	 * \return Number of birds
+	 */
+	std::size_t size() const;
+
+	/**
+	 * \brief Makes the bird "hop/flap" upwards
+	 * \param bird Index of the bird
+	 */
+	void flap(std::size_t bird);
+
+	/**
+	 * \brief Kills the bird, meaning it can no longer flap.
+	 * \param bird Index of the bird
+	 */
+	void kill(std::size_t bird);
+
+	/**
+	 * \brief Checks if the bird is dead
+	 * \param bird Index of the bird
+	 * \return True if bird is dead, false otherwise
+	 */
+	bool isDead(std::size_t bird) const;
+
+	/**
+	 * \brief Returns the position of the bird
+	 * \param bird Index of the bird
+	 * \return Position of the middle of the bird
+	 */
+	sf::Vector2f position(std::size_t bird) const;
+
+	/**
+	 * \brief Sets the position of the bird
+	 * \param bird Index of the bird
+	 * \param position New position of the middle of the bird
+	 */
+	void setPosition(std::size_t bird, const sf::Vector2f& position);
+
+	/**
+	 * \brief Returns the velocity of the bird
+	 * \param bird Index of the bird
+	 * \return Velocity in pixels per second
+	 */
+	sf::Vector2f velocity(std::size_t bird) const;
+
+	/**
+	 * \brief Sets the velocity of the bird
+	 * \param bird Index of the bird
+	 * \param velocity New velocity in pixels per second
+	 */
+	void setVelocity(std::size_t bird, const sf::Vector2f& velocity);
+
+	/**
+	 * \brief Returns the current score (fitness core of the bird)
+	 * \param bird Index of the bird
+	 * \return Fitness score of the bird
+	 */
+	float fitnessScore(std::size_t bird) const;
+
+	/**
+	 * \brief Function that returns the bounds of the bird
+	 * sprite. It is then used in functions that checks
+	 * colision with other objects.
+	 * \param bird Index of the bird
+	 * \return Bounds of the sprite
+	 */
+	sf::FloatRect birdBounds(std::size_t bird) const;
+
+	/**
+	 * \brief Returns the current state of the bird
+	 * \param bird Index of the bird
+	 * \return State from which the bird can be restored
+	 */
+	State state(std::size_t bird) const;
+
+	/**
+	 * \brief Brings the bird back to the given state
+	 * \param bird Index of the bird
+	 * \param state State previously taken from the bird
+	 */
+	void restoreState(std::size_t bird, const State& state);
+
+	/**
+	 * \brief Updates the logic of the birds. Including positions on the screen, or their rotations.
+	 * \param deltaTime the time that has passed since the game was last updated
+	 * \param updateDeadBirds Whether the dead birds are still moved, so they can fall off the screen
+	 */
+	void update(const sf::Time& deltaTime, bool updateDeadBirds);
+
+	/**
+	 * \brief It takes input (event) from the user and interprets it
+	 * \param event user input
+	 */
+	void handleEvents(const sf::Event& event);
+
+	/**
+	 * \brief Draws the bird to the passed target.
+	 * \param target where it should be drawn to
+	 * \param states provides information about rendering process (transform, shader, blend mode)
+	 * \param bird Index of the bird
+	 */
+	void draw(sf::RenderTarget& target, sf::RenderStates states, std::size_t bird) const;
+
+	/**
+	 * \brief Returns the vertical speed the bird gets when it flaps
+	 * \return Upward speed in pixels per second
+	 */
+	static float jumpStrength();
+
+	/**
+	 * \brief Returns the acceleration with which every bird falls
+	 * \return Downward acceleration in pixels per second squared
+	 */
+	static float gravity();
+
+	/**
+	 * \brief Queues the required resources for this class to be loaded
+	 * \param textureManager Texture storage manager
+	 */
+	static void loadResources(TextureManager& textureManager);
+
+private:
+	/**
+	 * \brief Calculates the current rotation that the bird should make.
+	 * \param velocityY Vertical velocity of the bird
+	 * \param rotation Current rotation of the bird
+	 * \return Rotation speed in degrees per second that the bird should make
+	 */
+	static float rotationSpeed(float velocityY, float rotation);
+
+	/**
+	 * \brief Returns the index of the look with the given texture, adding it when needed
+	 * \param birdTexture Identifier of the texture
+	 * \return Index of the look
+	 */
+	std::uint8_t lookOf(Textures_ID birdTexture);
+
+private:
+	/** The force with which the bird jumps determines how high it will raise up during flap */
+	inline static float mJumpStrength = 185.f;
+
+	/** The acceleration with which the bird falls down */
+	inline static float mGravity = 500.f;
+
+	/** Texture storage manager, from which the looks of the birds are taken */
+	const TextureManager& mTextureManager;
+
+	std::vector<float> mPositionsX;
+	std::vector<float> mPositionsY;
+	std::vector<float> mVelocitiesX;
+	std::vector<float> mVelocitiesY;
+	std::vector<float> mRotations;
+	std::vector<float> mScores;
+	std::vector<std::uint8_t> mIsDead;
+
+	/** Index of the look of each bird */
+	std::vector<std::uint8_t> mLookOfBird;
+
+	/** Textures of the looks, in the order they were first used */
+	std::vector<Textures_ID> mLookTextures;
+
+	/** Sprite of each look, with the origin in its middle. Used to draw to the screen. */
+	std::vector<sf::Sprite> mLookSprites;
+};
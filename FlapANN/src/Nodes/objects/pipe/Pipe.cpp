@@ -2,16 +2,14 @@
 #include "Pipe.h"
 #include <SFML/Graphics/RectangleShape.hpp>
 
-Pipe::Pipe(const sf::Texture& pipeTexture, MovePattern movePattern)
-	: mPipe(pipeTexture)
-	, mCurrentMovePattern(movePattern)
+Pipe::Pipe(const TextureManager& textureManager, Textures_ID pipeTexture)
+	: mPipe(textureManager.sprite(pipeTexture))
 {
-	setVelocity({-mPipeSpeed, 0.f});
 }
 
 void Pipe::loadResources(TextureManager& textureManager)
 {
-	textureManager.storeResource(Textures_ID::Pipe_Green, "resources/textures/pipe_green.png");
+	textureManager.queueResourceInAtlas(Textures_ID::Pipe_Green, "resources/textures/pipe_green.png");
 }
 
 void Pipe::drawThis(sf::RenderTarget& target, sf::RenderStates states) const
@@ -19,19 +17,12 @@ void Pipe::drawThis(sf::RenderTarget& target, sf::RenderStates states) const
 	target.draw(mPipe, states);
 }
 
-void Pipe::updateThis(const sf::Time& deltaTime)
-{
-	NodeMoveable::updateThis(deltaTime);
-
-	setPosition(getPosition() + mCurrentMovePattern.positionDelta(deltaTime) * deltaTime.asSeconds() * 100.f);
-}
-
 sf::FloatRect Pipe::getPipeBounds() const
 {
-	return (mPipe.getTransform() * getTransform()).transformRect(mPipe.getGlobalBounds());
+	return worldTransform().transformRect(mPipe.getGlobalBounds());
 }
 
 float Pipe::pipeSpeed()
 {
 	return mPipeSpeed;
-}
\ No newline at end of file
+}
@@ -1,24 +1,26 @@
 #pragma once
 
-#include "PipeMovePattern.h"
-#include "nodes/NodeMoveable.h"
+#include "nodes/NodeScene.h"
 #include "resources/Resources.h"
 
 /**
  * \brief Pipe is an object that blocks birds and collision with it leads to death of the bird.
+ *
+ * The pipe does not move on its own. Its position is calculated by the PipeSet
+ * it belongs to, directly from the time that has passed since it was placed.
  */
-class Pipe final : public NodeMoveable
+class Pipe final : public NodeScene
 {
 public:
 	/**
 	 * \brief The main constructor of the pipe.
-	 * \param pipeTexture The texture the pipe should take.
-	 * \param movePattern Additional movement pattern
+	 * \param textureManager Texture storage manager.
+	 * \param pipeTexture Identifier of the texture the pipe should take.
 	 */
-	Pipe(const sf::Texture& pipeTexture, MovePattern movePattern = MovePattern());
+	Pipe(const TextureManager& textureManager, Textures_ID pipeTexture);
 
 	/**
-	 * \brief Loads the required resources for this class.
+	 * \brief Queues the required resources for this class to be loaded.
 	 * \param textureManager Texture storage manager.
 	 */
 	static void loadResources(TextureManager& textureManager);
@@ -30,13 +32,6 @@ public:
 	 */
 	void drawThis(sf::RenderTarget& target, sf::RenderStates states) const override;
 
-	/**
-	 * \brief Updates the logic of the pipe. Including positions on the screen or
-	 *		  the deletion or generation of the pipe.
-	 * \param deltaTime the time that has passed since the game was last updated
-	 */
-	void updateThis(const sf::Time& deltaTime) override;
-
 	/**
 	 * \brief Returns the bounds of the pipe sprite.
 	 * \return Width and height of the sprite.
@@ -54,9 +49,6 @@ private:
 	/** Pipe graphics drawn on screen */
 	sf::Sprite mPipe;
 
-	/** The pattern by which the pipes move */
-	MovePattern mCurrentMovePattern;
-
 	/** The speed at which the pipe moves */
 	inline static float mPipeSpeed = 40.f;
 };
@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "PipeCourse.h"
+
+namespace
+{
+	/**
+	 * \brief Draws a float from the given range
+	 * \param engine Random number generator
+	 * \param min Minimum value
+	 * \param max Maximum value
+	 * \return Random value between min and max
+	 */
+	float randomInRange(std::mt19937& engine, float min, float max)
+	{
+		// 24 bits are exactly the precision of the float
+		const auto unit = static_cast<float>(engine() >> 8) / static_cast<float>(1u << 24);
+		return min + (max - min) * unit;
+	}
+}
+
+PipeCourse::PipeCourse(const Settings& settings, std::size_t length)
+	: mSettings(settings)
+{
+	assert(length > 0);
+
+	std::mt19937 engine(settings.seed);
+	mPipeSets.reserve(length);
+	for (std::size_t index = 0; index < length; ++index)
+	{
+		const auto xOffset = randomInRange(engine, settings.minXOffset, settings.maxXOffset);
+		const auto gapCenter = randomInRange(engine, settings.minGapCenter, settings.maxGapCenter);
+		mPipeSets.push_back({ xOffset, gapCenter, settings.gapSize, settings.movePattern });
+	}
+}
+
+const CoursePipeSet& PipeCourse::operator[](std::size_t index) const
+{
+	return mPipeSets[index % mPipeSets.size()];
+}
+
+const PipeCourse::Settings& PipeCourse::settings() const
+{
+	return mSettings;
+}
+
+std::size_t PipeCourse::length() const
+{
+	return mPipeSets.size();
+}
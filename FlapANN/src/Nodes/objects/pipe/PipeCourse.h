@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "PipeMovePattern.h"
+
+/**
+ * \brief Parameters of a single pipe set placed on the course
+ */
+struct CoursePipeSet
+{
+	/** Horizontal distance from the previous pipe set */
+	float xOffset;
+
+	/** Vertical position of the center of the gap between the pipes */
+	float gapCenter;
+
+	/** Distance between the bottom and the upper pipe */
+	float gapSize;
+
+	/** Additional movement of both pipes */
+	MovePattern movePattern;
+};
+
+/**
+ * \brief A pre-generated sequence of pipe sets, the same for everyone using the same seed.
+ *
+ * The whole course is generated at once when it is created, and it is never changed
+ * afterwards. Thanks to this, any number of worlds and threads can read it at the same
+ * time without any locks, and each of them sees exactly the same pipes. Every reader
+ * keeps its own index of the next pipe set, and the course wraps around when the index
+ * goes past its length, so the course can be followed endlessly.
+ *
+ * Random numbers are turned into floats by hand instead of using std distributions,
+ * so the course depends only on the seed, not on the standard library implementation.
+ */
+class PipeCourse final
+{
+public:
+	/**
+	 * \brief Contains data needed to generate the course
+	 */
+	struct Settings
+	{
+		/** Seed of the random number generator */
+		std::uint32_t seed;
+
+		/** Minimum horizontal distance between successive pipe sets */
+		float minXOffset;
+
+		/** Maximum horizontal distance between successive pipe sets */
+		float maxXOffset;
+
+		/** Minimum vertical position of the gap center */
+		float minGapCenter;
+
+		/** Maximum vertical position of the gap center */
+		float maxGapCenter;
+
+		/** Distance between the bottom and the upper pipe */
+		float gapSize;
+
+		/** Additional movement of the pipes */
+		MovePattern movePattern;
+	};
+
+	/**
+	 * \brief Generates the whole course
+	 * \param settings Data needed to generate the course
+	 * \param length Number of pipe sets after which the course repeats
+	 */
+	explicit PipeCourse(const Settings& settings, std::size_t length = DEFAULT_LENGTH);
+
+	/**
+	 * \brief Returns the pipe set at the given index of the course
+	 * \param index Index of the pipe set counting from the start of the course
+	 * \return Parameters of the pipe set
+	 */
+	const CoursePipeSet& operator[](std::size_t index) const;
+
+	/**
+	 * \brief Returns the settings the course was generated with
+	 * \return Settings of the course
+	 */
+	const Settings& settings() const;
+
+	/**
+	 * \brief Returns the number of pipe sets after which the course repeats
+	 * \return Length of the course
+	 */
+	std::size_t length() const;
+
+	/** Number of pipe sets of the course by default. No bird is expected to pass them all. */
+	static constexpr std::size_t DEFAULT_LENGTH = 4096;
+
+private:
+	/** Settings the course was generated with */
+	Settings mSettings;
+
+	/** All pipe sets of the course in the order of appearance */
+	std::vector<CoursePipeSet> mPipeSets;
+};
@@ -1,12 +1,10 @@
 #include "pch.h"
 #include "PipeMovePattern.h"
-#include "PipeMovePattern.h"
 
 
 MovePattern::MovePattern()
 	: mCurrentMovePattern(Pattern::None)
 	, mMovePatternSpeed(0)
-	, mMovePatternIteration(0)
 	, mMovePatternRange(0)
 {
 }
@@ -14,7 +12,6 @@ MovePattern::MovePattern()
 void MovePattern::applyPattern(const Pattern& pattern)
 {
 	mCurrentMovePattern = pattern;
-	mMovePatternIteration = 0;
 }
 
 MovePattern::Pattern MovePattern::pattern() const
@@ -27,7 +24,7 @@ void MovePattern::patternSpeed(const float& speed)
 	mMovePatternSpeed = speed;
 }
 
-float MovePattern::patternSpeed()
+float MovePattern::patternSpeed() const
 {
 	return mMovePatternSpeed;
 }
@@ -37,30 +34,45 @@ void MovePattern::patternRange(const float& range)
 	mMovePatternRange = range;
 }
 
-float MovePattern::patternRange()
+float MovePattern::patternRange() const
 {
 	return mMovePatternRange;
 }
 
-sf::Vector2f MovePattern::positionDelta(const sf::Time& deltaTime)
+sf::Vector2f MovePattern::offsetAt(const sf::Time& elapsedTime) const
 {
-	mMovePatternIteration += deltaTime.asSeconds() * mMovePatternSpeed;
-	auto moveDeltaSin = std::sinf(mMovePatternIteration) * mMovePatternRange;
+	if (mCurrentMovePattern == Pattern::None)
+	{
+		return { 0, 0 };
+	}
+
+	// The pattern moves the object with the velocity of sin(speed * t) * range
+	// (and cos(speed * t) * range). Instead of adding it up frame by frame,
+	// the integral of it over the elapsed time is used directly.
+	const auto time = elapsedTime.asSeconds();
+	const auto range = mMovePatternRange * PIXELS_PER_RANGE;
+	auto moveOffsetSin = 0.f;
+	auto moveOffsetCos = range * time;
+	if (mMovePatternSpeed != 0.f)
+	{
+		const auto phase = mMovePatternSpeed * time;
+		moveOffsetSin = range * (1.f - std::cosf(phase)) / mMovePatternSpeed;
+		moveOffsetCos = range * std::sinf(phase) / mMovePatternSpeed;
+	}
 
 	switch (mCurrentMovePattern)
 	{
 		case Pattern::InCircle:
 		{
-			auto moveDeltaCos = std::cosf(mMovePatternIteration) * mMovePatternRange;
-			return { moveDeltaSin, moveDeltaCos };
+			return { moveOffsetSin, moveOffsetCos };
 		}
 		case Pattern::UpDown:
 		{
-			return { 0, moveDeltaSin };
+			return { 0, moveOffsetSin };
 		}
 		case Pattern::LeftRight:
 		{
-			return { moveDeltaSin, 0 };
+			return { moveOffsetSin, 0 };
 		}
 		default: return {  0, 0  };
 	}
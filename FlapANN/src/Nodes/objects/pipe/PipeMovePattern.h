@@ -4,6 +4,11 @@
  * \brief MovePattern calculates and returns the offsets
  * by which the object should be additionally moved in
  * order to move around the given pattern.
+ *
+ * The offset is an explicit function of the time that has passed since
+ * the object started to move, so it does not hold any state changing over
+ * time. The object can be placed at any moment directly, no matter how big
+ * the time step is, and all objects can share the same pattern.
  */
 class MovePattern final
 {
@@ -45,7 +50,7 @@ public:
 	 * \brief Returns the speed of the current pattern
 	 * \return Speed of current pattern
 	 */
-	float patternSpeed();
+	float patternSpeed() const;
 
 	/**
 	 * \brief Sets a new range for the current pattern
@@ -57,16 +62,18 @@ public:
 	 * \brief Returns the range of the current pattern
 	 * \return Range of current pattern
 	 */
-	float patternRange();
+	float patternRange() const;
 
 	/**
 	 * \brief Position by which the object should be moved in addition
-	 * \param deltaTime the time that has passed since the game was last updated
+	 * \param elapsedTime the time that has passed since the object started to move
 	 * \return Position by which the object should be moved in addition
 	 */
-	sf::Vector2f positionDelta(const sf::Time& deltaTime);
+	[[nodiscard]] sf::Vector2f offsetAt(const sf::Time& elapsedTime) const;
 
 private:
+	/** Number of pixels the object moves by per unit of the range */
+	static constexpr float PIXELS_PER_RANGE = 100.f;
 
 	/** Currently selected pattern */
 	Pattern mCurrentMovePattern;
@@ -74,12 +81,6 @@ private:
 	/** Speed of the currently selected pattern */
 	float mMovePatternSpeed;
 
-	/**
-	 * Iteration allows to specify the time at which a particular
-	 * moment of the pattern is displayed
-	 */
-	float mMovePatternIteration;
-
 	/** Range of the currently selected pattern */
 	float mMovePatternRange;
 };
@@ -6,6 +6,7 @@ PipeSet::PipeSet(const FontManager& fontManager, std::unique_ptr<Pipe> bottomPip
     , mUpperPipe(std::move(upperPipe))
     , mOffsetBetweenPipesText(std::to_string(static_cast<int>(offsetBetweenPipes())), 
 		fontManager.getResourceReference(Fonts_ID::ArialNarrow))
+    , mDisplayedOffsetBetweenPipes(static_cast<int>(offsetBetweenPipes()))
 {
 	mOffsetBetweenPipesText.setCharacterSize(12);
 	mOffsetBetweenPipesText.setOutlineThickness(0.25f);
@@ -14,6 +15,31 @@ PipeSet::PipeSet(const FontManager& fontManager, std::unique_ptr<Pipe> bottomPip
 		                            mOffsetBetweenPipesText.getLocalBounds().height / 2.f);
 }
 
+void PipeSet::reset(const sf::Vector2f& bottomPipePosition, const sf::Vector2f& upperPipePosition,
+                    const MovePattern& movePattern, const sf::Time& spawnTime)
+{
+	mBottomPipeSpawnPosition = bottomPipePosition;
+	mUpperPipeSpawnPosition = upperPipePosition;
+	mMovePattern = movePattern;
+	mSpawnTime = spawnTime;
+	updateAt(spawnTime);
+	updateOffsetBetweenPipesText();
+}
+
+void PipeSet::updateOffsetBetweenPipesText()
+{
+	// Laying out the glyphs is expensive, and usually
+	// the space is the same as in the previous pipes
+	const auto offset = static_cast<int>(offsetBetweenPipes());
+	if (offset == mDisplayedOffsetBetweenPipes)
+		return;
+
+	mDisplayedOffsetBetweenPipes = offset;
+	mOffsetBetweenPipesText.setString(std::to_string(offset));
+	mOffsetBetweenPipesText.setOrigin(mOffsetBetweenPipesText.getLocalBounds().width / 2.f,
+		                            mOffsetBetweenPipesText.getLocalBounds().height / 2.f);
+}
+
 sf::Vector2f PipeSet::position() const
 {
 	auto xPosition = mBottomPipe->getPosition().x;
@@ -38,17 +64,52 @@ float PipeSet::offsetBetweenPipes() const
 	return mBottomPipe->getPosition().y - mUpperPipe->getPosition().y;
 }
 
-void PipeSet::update(const sf::Time& deltaTime)
+sf::Vector2f PipeSet::bottomPipeSpawnPosition() const
+{
+	return mBottomPipeSpawnPosition;
+}
+
+sf::Vector2f PipeSet::upperPipeSpawnPosition() const
+{
+	return mUpperPipeSpawnPosition;
+}
+
+sf::Time PipeSet::spawnTime() const
 {
-	mBottomPipe->update(deltaTime);
-	mUpperPipe->update(deltaTime);
+	return mSpawnTime;
+}
+
+const MovePattern& PipeSet::movePattern() const
+{
+	return mMovePattern;
+}
+
+void PipeSet::updateAt(const sf::Time& courseTime)
+{
+	// Both pipes move the same way, so the offset is calculated just once
+	const auto elapsedTime = courseTime - mSpawnTime;
+	const auto offset = sf::Vector2f(-Pipe::pipeSpeed() * elapsedTime.asSeconds(), 0.f)
+	                  + mMovePattern.offsetAt(elapsedTime);
+
+	mBottomPipe->setPosition(mBottomPipeSpawnPosition + offset);
+	mUpperPipe->setPosition(mUpperPipeSpawnPosition + offset);
 	mOffsetBetweenPipesText.setPosition({ position().x + 10.f, position().y });
 }
 
 void PipeSet::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	drawPipes(target, states);
+	drawDescription(target, states);
+}
+
+void PipeSet::drawPipes(sf::RenderTarget& target, sf::RenderStates states) const
 {
 	target.draw(*mBottomPipe, states);
 	target.draw(*mUpperPipe, states);
+}
+
+void PipeSet::drawDescription(sf::RenderTarget& target, sf::RenderStates states) const
+{
 	target.draw(mOffsetBetweenPipesText, states);
 
 	sf::Vertex line[] =
@@ -1,9 +1,14 @@
 #pragma once
 #include "Pipe.h"
+#include "PipeMovePattern.h"
 
 /**
  * \brief A collection consisting of two pipes.
  * One at the top and one at the bottom.
+ *
+ * The position of the pipes is not accumulated frame by frame. It is calculated
+ * directly from the place and the time at which the set was put on the course,
+ * so the set can be placed at any moment of the course at once.
  */
 class PipeSet : public sf::Drawable
 {
@@ -18,6 +23,16 @@ public:
 	PipeSet(const FontManager& fontManager, 
 		std::unique_ptr<Pipe> bottomPipe, std::unique_ptr<Pipe> upperPipe);
 
+	/**
+	 * \brief Places both pipes again, so the set can be reused instead of creating a new one.
+	 * \param bottomPipePosition New position of the pipe located at the bottom of the screen
+	 * \param upperPipePosition New position of the pipe located at the top of the screen
+	 * \param movePattern Additional movement pattern of both pipes
+	 * \param spawnTime Time of the course at which the set is placed
+	 */
+	void reset(const sf::Vector2f& bottomPipePosition, const sf::Vector2f& upperPipePosition,
+	           const MovePattern& movePattern, const sf::Time& spawnTime);
+
     /**
 	 * \brief Current position indicating the center between the two pipes
 	 * \return Center position between two pipes
@@ -38,10 +53,34 @@ public:
 	float offsetBetweenPipes() const;
 
 	/**
-	 * \brief Updates the logic of the both pipes.
-	 * \param deltaTime the time that has passed since the game was last updated
+	 * \brief Returns the position of the pipe located at the bottom of the screen at the moment the set was placed
+	 * \return Position of the bottom pipe passed to reset()
+	 */
+	sf::Vector2f bottomPipeSpawnPosition() const;
+
+	/**
+	 * \brief Returns the position of the pipe located at the top of the screen at the moment the set was placed
+	 * \return Position of the upper pipe passed to reset()
+	 */
+	sf::Vector2f upperPipeSpawnPosition() const;
+
+	/**
+	 * \brief Returns the time of the course at which the set was placed
+	 * \return Time passed to reset()
 	 */
-    void update(const sf::Time& deltaTime);
+	sf::Time spawnTime() const;
+
+	/**
+	 * \brief Returns the pattern by which both pipes move
+	 * \return Pattern passed to reset()
+	 */
+	const MovePattern& movePattern() const;
+
+	/**
+	 * \brief Places both pipes where they are at the given moment of the course.
+	 * \param courseTime Time that has passed since the course started
+	 */
+    void updateAt(const sf::Time& courseTime);
 
 	/**
 	 * \brief Draws the pipes to the passed target.
@@ -50,6 +89,20 @@ public:
 	 */
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
+	/**
+	 * \brief Draws only the pipes without any additional information to the passed target.
+	 * \param target where it should be drawn to
+	 * \param states provides information about rendering process (transform, shader, blend mode).
+	 */
+	void drawPipes(sf::RenderTarget& target, sf::RenderStates states) const;
+
+	/**
+	 * \brief Draws the size of the space between pipes and the line connecting them.
+	 * \param target where it should be drawn to
+	 * \param states provides information about rendering process (transform, shader, blend mode).
+	 */
+	void drawDescription(sf::RenderTarget& target, sf::RenderStates states) const;
+
     /**
 	 * \brief Returns the pipe located at the bottom of the screen
 	 * \return Reference to the bottom pipe
@@ -74,6 +127,12 @@ public:
 	 */
 	const Pipe& upperPipe() const;
 
+private:
+	/**
+	 * \brief Updates the text describing the size of the space between pipes
+	 */
+	void updateOffsetBetweenPipesText();
+
 private:
 
 	/** Bottom pipe from the pipeset */
@@ -82,6 +141,21 @@ private:
 	/** Upper pipe from the pipeset */
 	std::unique_ptr<Pipe> mUpperPipe;
 
+	/** Position of the bottom pipe at the moment the set was placed */
+	sf::Vector2f mBottomPipeSpawnPosition;
+
+	/** Position of the upper pipe at the moment the set was placed */
+	sf::Vector2f mUpperPipeSpawnPosition;
+
+	/** Time of the course at which the set was placed */
+	sf::Time mSpawnTime;
+
+	/** The pattern by which both pipes move */
+	MovePattern mMovePattern;
+
 	/** Text that is displayed between the pipes describing the size of the space between them */
 	sf::Text mOffsetBetweenPipesText;
+
+	/** Space between pipes that is currently displayed by the text */
+	int mDisplayedOffsetBetweenPipes;
 };
\ No newline at end of file
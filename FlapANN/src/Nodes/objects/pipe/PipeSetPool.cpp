@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "PipeSetPool.h"
+
+PipeSetPool::PipeSetPool(const TextureManager& textures, const FontManager& fonts, std::size_t capacity)
+	: mTextures(textures)
+	, mFonts(fonts)
+	, mFront(0)
+	, mSize(0)
+{
+	mPipeSets.reserve(capacity);
+	for (std::size_t i = 0; i < capacity; ++i)
+	{
+		mPipeSets.push_back(createPipeSet());
+	}
+}
+
+PipeSet PipeSetPool::createPipeSet() const
+{
+	const auto& pipeTextureRect = mTextures.getResourceRect(Textures_ID::Pipe_Green);
+	auto createPipe = [this, &pipeTextureRect]()
+	{
+		auto pipe = std::make_unique<Pipe>(mTextures, Textures_ID::Pipe_Green);
+		pipe->setOrigin(static_cast<float>(pipeTextureRect.width) / 2.f, 0);
+		return pipe;
+	};
+
+	auto bottomPipe = createPipe();
+	auto upperPipe = createPipe();
+	upperPipe->setRotation(180);
+
+	return PipeSet{ mFonts, std::move(bottomPipe), std::move(upperPipe) };
+}
+
+void PipeSetPool::grow()
+{
+	std::vector<PipeSet> pipeSets;
+	pipeSets.reserve(mPipeSets.size() * 2);
+	for (std::size_t i = 0; i < mPipeSets.size(); ++i)
+	{
+		pipeSets.push_back(std::move(mPipeSets[(mFront + i) % mPipeSets.size()]));
+	}
+	while (pipeSets.size() < pipeSets.capacity())
+	{
+		pipeSets.push_back(createPipeSet());
+	}
+	mPipeSets = std::move(pipeSets);
+	mFront = 0;
+}
+
+PipeSet& PipeSetPool::acquireBack()
+{
+	if (mSize == mPipeSets.size())
+	{
+		grow();
+	}
+	++mSize;
+	return back();
+}
+
+void PipeSetPool::releaseFront()
+{
+	assert(!empty());
+	mFront = (mFront + 1) % mPipeSets.size();
+	--mSize;
+}
+
+void PipeSetPool::releaseAll()
+{
+	mFront = 0;
+	mSize = 0;
+}
+
+PipeSet& PipeSetPool::operator[](std::size_t position)
+{
+	return mPipeSets[(mFront + position) % mPipeSets.size()];
+}
+
+const PipeSet& PipeSetPool::operator[](std::size_t position) const
+{
+	return mPipeSets[(mFront + position) % mPipeSets.size()];
+}
+
+PipeSet& PipeSetPool::front()
+{
+	return (*this)[0];
+}
+
+const PipeSet& PipeSetPool::front() const
+{
+	return (*this)[0];
+}
+
+PipeSet& PipeSetPool::back()
+{
+	return (*this)[mSize - 1];
+}
+
+const PipeSet& PipeSetPool::back() const
+{
+	return (*this)[mSize - 1];
+}
+
+bool PipeSetPool::empty() const
+{
+	return mSize == 0;
+}
+
+std::size_t PipeSetPool::size() const
+{
+	return mSize;
+}
+
+PipeSetPool::iterator PipeSetPool::begin()
+{
+	return { *this, 0 };
+}
+
+PipeSetPool::iterator PipeSetPool::end()
+{
+	return { *this, mSize };
+}
+
+PipeSetPool::const_iterator PipeSetPool::begin() const
+{
+	return { *this, 0 };
+}
+
+PipeSetPool::const_iterator PipeSetPool::end() const
+{
+	return { *this, mSize };
+}
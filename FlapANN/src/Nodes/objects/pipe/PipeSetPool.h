@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+#include "PipeSet.h"
+
+/**
+ * \brief A ring of pipe sets that are created once and then used again and again.
+ *
+ * Pipe sets leave the screen in the same order in which they entered it, so the
+ * active sets always form a continuous fragment of the ring -- from the front
+ * (the oldest one) to the back (the newest one). A set that has left the screen
+ * is not destroyed, it just waits to be placed again at the back of the ring.
+ * Thanks to this, no memory is allocated while the pipes are generated.
+ *
+ *       front             back
+ *         |                 |
+ *   +---+-v-+---+---+---+---v+---+
+ *   |   | A | A | A | A | A |    |   A - active pipe set
+ *   +---+---+---+---+---+---+----+
+ */
+class PipeSetPool
+{
+	/**
+	 * \brief Iterates over the active pipe sets starting from the front
+	 */
+	template <typename Pool, typename Value>
+	class Iterator
+	{
+	public:
+		Iterator(Pool& pool, std::size_t position) : mPool(&pool), mPosition(position) {}
+		Value& operator*() const { return (*mPool)[mPosition]; }
+		Value* operator->() const { return &(*mPool)[mPosition]; }
+		Iterator& operator++() { ++mPosition; return *this; }
+		bool operator!=(const Iterator& rhs) const { return mPosition != rhs.mPosition; }
+
+	private:
+		Pool* mPool;
+		std::size_t mPosition;
+	};
+
+public:
+	using iterator = Iterator<PipeSetPool, PipeSet>;
+	using const_iterator = Iterator<const PipeSetPool, const PipeSet>;
+
+	/**
+	 * \brief Creates all the pipe sets at once
+	 * \param textures Texture manager holds all the available textures in the game.
+	 * \param fonts Font manager holds all the available fonts in the game
+	 * \param capacity Number of pipe sets that can be active at the same time
+	 */
+	PipeSetPool(const TextureManager& textures, const FontManager& fonts, std::size_t capacity);
+
+	/**
+	 * \brief Activates the next pipe set and puts it at the back
+	 * \return Pipe set that has to be placed again with PipeSet::reset()
+	 *
+	 * If all pipe sets are already active, the ring grows. This should never
+	 * happen when the capacity is chosen correctly.
+	 */
+	PipeSet& acquireBack();
+
+	/**
+	 * \brief Deactivates the oldest pipe set
+	 */
+	void releaseFront();
+
+	/**
+	 * \brief Deactivates all pipe sets
+	 */
+	void releaseAll();
+
+	/**
+	 * \brief Returns the active pipe set counting from the front
+	 * \param position Position counting from the front
+	 * \return Active pipe set at the given position
+	 */
+	PipeSet& operator[](std::size_t position);
+	const PipeSet& operator[](std::size_t position) const;
+
+	PipeSet& front();
+	const PipeSet& front() const;
+	PipeSet& back();
+	const PipeSet& back() const;
+
+	/**
+	 * \brief Checks if there is no active pipe set
+	 * \return True if there is no active pipe set, false otherwise
+	 */
+	bool empty() const;
+
+	/**
+	 * \brief Returns the number of active pipe sets
+	 * \return Number of active pipe sets
+	 */
+	std::size_t size() const;
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	/**
+	 * \brief Creates a new pipe set with pipes already rotated and placed in the right origin
+	 * \return Newly created pipe set
+	 */
+	PipeSet createPipeSet() const;
+
+	/**
+	 * \brief Doubles the number of pipe sets, keeping the order of the active ones
+	 */
+	void grow();
+
+private:
+	/** A manager that stores references to textures in the game */
+	const TextureManager& mTextures;
+
+	/** A manager that stores references to fonts in the game */
+	const FontManager& mFonts;
+
+	/** All pipe sets, both active and inactive */
+	std::vector<PipeSet> mPipeSets;
+
+	/** Index of the oldest active pipe set */
+	std::size_t mFront;
+
+	/** Number of active pipe sets */
+	std::size_t mSize;
+};
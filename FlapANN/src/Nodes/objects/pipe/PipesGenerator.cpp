@@ -1,83 +1,132 @@
 #include "pch.h"
 #include "PipesGenerator.h"
+#include <limits>
 #include <random>
 #include <imgui/imgui.h>
 
-std::random_device PipesGenerator::rndDevice;
-std::mt19937 PipesGenerator::engine(rndDevice());
+#include "Profiler.h"
 
 PipesGenerator::PipesGenerator(const TextureManager& textures, const FontManager& fonts, const sf::Vector2u& screenSize):
 	mTextures(textures),
-	mFonts(fonts),
-	mClippingPoint(screenSize.x)
+	mNextCoursePipeSet(0),
+	mLastPipeSetDistance(0.f),
+	mClippingPoint(screenSize.x),
+	mPipeSets(textures, fonts, maximumNumberOfPipeSets(screenSize))
 {
-	yCoordinate.maxPipeOffset = screenSize.y / 2;
+	mCourseSettings.seed = std::random_device()();
+	mCourseSettings.maxGapCenter = screenSize.y / 2;
+	regenerateCourse();
 }
 
-sf::Vector2f PipesGenerator::randomPipeOffset() const
+void PipesGenerator::regenerateCourse()
 {
-	const std::uniform_real_distribution randomizedXPosition(xCoordinate.minPipeOffset, xCoordinate.maxPipeOffset);
-	const std::uniform_real_distribution randomizedYPosition(yCoordinate.minPipeOffset, yCoordinate.maxPipeOffset);
+	useCourse(std::make_shared<const PipeCourse>(mCourseSettings));
+}
 
-	auto pipeXOffset = randomizedXPosition(engine);
-	auto upperPipeHeight = randomizedYPosition(engine);
+void PipesGenerator::useCourse(std::shared_ptr<const PipeCourse> course)
+{
+	assert(course);
+	mCourseSettings = course->settings();
+	mCourse = std::move(course);
+}
 
-	return {pipeXOffset, upperPipeHeight};
+const std::shared_ptr<const PipeCourse>& PipesGenerator::course() const
+{
+	return mCourse;
 }
 
-sf::Vector2f PipesGenerator::lastPipeSetPosition() const
+PipesGenerator::State PipesGenerator::state() const
 {
-	return mPipeSets.empty() ? sf::Vector2f{mClippingPoint, 0.f} : mPipeSets.back().position();
+	State state{ mCourse, mNextCoursePipeSet, mLastPipeSetDistance, mCourseTime, {} };
+	state.pipeSets.reserve(mPipeSets.size());
+	for (const auto& pipeSet : mPipeSets)
+	{
+		state.pipeSets.push_back({ pipeSet.bottomPipeSpawnPosition(), pipeSet.upperPipeSpawnPosition(),
+		                           pipeSet.movePattern(), pipeSet.spawnTime() });
+	}
+	return state;
 }
 
-std::unique_ptr<Pipe> PipesGenerator::createNextPipeWithOffset(const sf::Vector2f& offset, Textures_ID pipeTextureId) const
+void PipesGenerator::restoreState(const State& state)
 {
-	const auto& pipeTexture = mTextures.getResourceReference(pipeTextureId);
-	auto pipe = std::make_unique<Pipe>(pipeTexture, mMovePattern);
-	pipe->setPosition({lastPipeSetPosition().x + offset.x, offset.y});
-	pipe->setOrigin(static_cast<float>(pipeTexture.getSize().x) / 2.f, 0);
+	useCourse(state.course);
+	mNextCoursePipeSet = state.nextCoursePipeSet;
+	mLastPipeSetDistance = state.lastPipeSetDistance;
+	mCourseTime = state.courseTime;
+
+	mPipeSets.releaseAll();
+	for (const auto& placedPipeSet : state.pipeSets)
+	{
+		mPipeSets.acquireBack().reset(placedPipeSet.bottomPipeSpawnPosition, placedPipeSet.upperPipeSpawnPosition,
+		                              placedPipeSet.movePattern, placedPipeSet.spawnTime);
+	}
+	updatePipesPosition();
+}
 
-	return pipe;
+std::size_t PipesGenerator::maximumNumberOfPipeSets(const sf::Vector2u& screenSize) const
+{
+	// Pipe sets are generated until the newest one is past the screen,
+	// and removed once they leave it from the other side. One more
+	// is added in case of the pipe being very wide or moving a lot.
+	const auto visibleRange = static_cast<float>(screenSize.x) + mCourseSettings.maxXOffset;
+	return static_cast<std::size_t>(std::ceil(visibleRange / mCourseSettings.minXOffset)) + 2;
 }
 
 bool PipesGenerator::isFrontPipeSetOutOfSight() const
 {
+	if (mPipeSets.empty())
+	{
+		return false;
+	}
 	const auto& pipe = mPipeSets.front();
-	return !mPipeSets.empty() && pipe.position().x + pipe.bounds().width < 0.f;
+	return pipe.position().x + pipe.bounds().width < 0.f;
 }
 
-bool PipesGenerator::isLastPipeSetInsideWindowFrame() const
+bool PipesGenerator::isNextPipeSetDue() const
 {
-	return mPipeSets.empty() || mPipeSets.back().position().x < mClippingPoint;
+	// The last pipe set started at the clipping point shifted by its distance,
+	// and since then it has moved left together with the whole course
+	const auto travelledDistance = Pipe::pipeSpeed() * mCourseTime.asSeconds();
+	return mNextCoursePipeSet == 0 || mLastPipeSetDistance < travelledDistance;
 }
 
 void PipesGenerator::generatePipe()
 {
-	const sf::Vector2f& offset = randomPipeOffset();
-
-	auto bottomPipe = createNextPipeWithOffset({ offset.x, offset.y + mOffsetBetweenPipes / 2.f });
-	auto upperPipe = createNextPipeWithOffset({ offset.x, offset.y - mOffsetBetweenPipes / 2.f });
-	upperPipe->setRotation(180);
-
-	mPipeSets.emplace_back(PipeSet{ mFonts, std::move(bottomPipe), std::move(upperPipe) });
+	const auto& coursePipeSet = (*mCourse)[mNextCoursePipeSet++];
+	mLastPipeSetDistance += coursePipeSet.xOffset;
+
+	// The pipe set is placed where it would be if it was placed exactly on time,
+	// so the pipes do not depend on the length of the time steps
+	const auto travelledDistance = Pipe::pipeSpeed() * mCourseTime.asSeconds();
+	const auto pipeSetX = mClippingPoint + mLastPipeSetDistance - travelledDistance;
+	const auto& gapCenter = coursePipeSet.gapCenter;
+	const auto& gapSize = coursePipeSet.gapSize;
+
+	auto& pipeSet = mPipeSets.acquireBack();
+	pipeSet.reset({ pipeSetX, gapCenter + gapSize / 2.f },
+	              { pipeSetX, gapCenter - gapSize / 2.f }, coursePipeSet.movePattern, mCourseTime);
 }
 
 void PipesGenerator::deleteFrontPipe()
 {
-	mPipeSets.pop_front();
+	mPipeSets.releaseFront();
 }
 
-void PipesGenerator::updatePipesPosition(const sf::Time& deltaTime)
+void PipesGenerator::updatePipesPosition()
 {
 	for (auto& pipeSet : mPipeSets)
 	{
-		pipeSet.update(deltaTime);
+		pipeSet.updateAt(mCourseTime);
 	}
 }
 
 void PipesGenerator::updateThis(const sf::Time& deltaTime)
 {
-	if (isLastPipeSetInsideWindowFrame())
+	PROFILE_SCOPE(UpdatePipes);
+
+	mCourseTime += deltaTime;
+
+	while (isNextPipeSetDue())
 	{
 		generatePipe();
 	}
@@ -85,7 +134,7 @@ void PipesGenerator::updateThis(const sf::Time& deltaTime)
 	{
 		deleteFrontPipe();
 	}
-	updatePipesPosition(deltaTime);
+	updatePipesPosition();
 }
 
 void PipesGenerator::updateImGuiOffsetBetweenLowerAndUpperPipe()
@@ -94,7 +143,10 @@ void PipesGenerator::updateImGuiOffsetBetweenLowerAndUpperPipe()
 	const static auto& textSize = ImGui::CalcTextSize(sliderText);
 
 	ImGui::PushItemWidth(-textSize.x);
-	ImGui::SliderFloat(sliderText, &mOffsetBetweenPipes, 0.f, 100.f);
+	if (ImGui::SliderFloat(sliderText, &mCourseSettings.gapSize, 0.f, 100.f))
+	{
+		regenerateCourse();
+	}
 }
 
 void PipesGenerator::updateImGuiMovePattern()
@@ -102,14 +154,16 @@ void PipesGenerator::updateImGuiMovePattern()
 	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
 	if (ImGui::TreeNode("Pattern"))
 	{
-		const auto selected = static_cast<int>(mMovePattern.pattern());
+		auto& movePattern = mCourseSettings.movePattern;
+		const auto selected = static_cast<int>(movePattern.pattern());
 		for (auto patternIndex = static_cast<int>(MovePattern::Pattern::None);
 		     patternIndex < static_cast<int>(MovePattern::Pattern::Last); ++patternIndex)
 		{
 			auto pattern = static_cast<MovePattern::Pattern>(patternIndex);
 			if (ImGui::Selectable(toString(pattern).c_str(), selected == patternIndex))
 			{
-				mMovePattern.applyPattern(pattern);
+				movePattern.applyPattern(pattern);
+				regenerateCourse();
 			}
 		}
 		ImGui::TreePop();
@@ -120,12 +174,13 @@ void PipesGenerator::updateImGuiMovePatternRange()
 {
 	const static auto& sliderText = "Range of the movement pattern";
 	const static auto& textSize = ImGui::CalcTextSize(sliderText);
-	auto movePatternRange = mMovePattern.patternRange();
+	auto movePatternRange = mCourseSettings.movePattern.patternRange();
 
 	ImGui::PushItemWidth(-textSize.x);
 	if(ImGui::SliderFloat(sliderText, &movePatternRange, 0.f, 1.5f))
 	{
-		mMovePattern.patternRange(movePatternRange);
+		mCourseSettings.movePattern.patternRange(movePatternRange);
+		regenerateCourse();
 	}
 }
 
@@ -133,12 +188,27 @@ void PipesGenerator::updateImGuiMovePatternSpeed()
 {
 	const static auto& sliderText = "Speed of the movement pattern";
 	const static auto& textSize = ImGui::CalcTextSize(sliderText);
-	auto movePatternSpeed = mMovePattern.patternSpeed();
+	auto movePatternSpeed = mCourseSettings.movePattern.patternSpeed();
 
 	ImGui::PushItemWidth(-textSize.x);
 	if(ImGui::SliderFloat(sliderText, &movePatternSpeed, 0.f, 5.f))
 	{
-		mMovePattern.patternSpeed(movePatternSpeed);
+		mCourseSettings.movePattern.patternSpeed(movePatternSpeed);
+		regenerateCourse();
+	}
+}
+
+void PipesGenerator::updateImGuiCourseSeed()
+{
+	const static auto& inputText = "Seed of the course";
+	const static auto& textSize = ImGui::CalcTextSize(inputText);
+	auto seed = static_cast<int>(mCourseSettings.seed);
+
+	ImGui::PushItemWidth(-textSize.x);
+	if (ImGui::InputInt(inputText, &seed))
+	{
+		mCourseSettings.seed = static_cast<std::uint32_t>(seed);
+		regenerateCourse();
 	}
 }
 
@@ -146,6 +216,7 @@ void PipesGenerator::updateImGuiThis()
 {
 	if(ImGui::CollapsingHeader("PipeGenerator"))
 	{
+		updateImGuiCourseSeed();
 		updateImGuiOffsetBetweenLowerAndUpperPipe();
 
 		ImGui::SetNextItemOpen(true, ImGuiCond_Once);
@@ -160,63 +231,61 @@ void PipesGenerator::updateImGuiThis()
 
 void PipesGenerator::drawThis(sf::RenderTarget& target, sf::RenderStates states) const
 {
+	// All pipes share the same texture, so they are drawn first
+	// and all together to avoid switching the texture between them
 	for (const auto& pipe : mPipeSets)
 	{
-		pipe.draw(target, states);
+		pipe.drawPipes(target, states);
+	}
+	for (const auto& pipe : mPipeSets)
+	{
+		pipe.drawDescription(target, states);
 	}
 }
 
-std::vector<const PipeSet*> PipesGenerator::sortedByDistancePipeSets(const sf::Vector2f& position) const
+const PipeSet* PipesGenerator::nearestPipeSetInFrontOfPoint(const sf::Vector2f& position) const
 {
-	auto calculateHorizontalDistance = [&position](const sf::Vector2f& newPos)
-	{
-		return std::sqrtf(std::powf(position.x - newPos.x, 2));
-	};
-
-	std::vector<const PipeSet*> pipeSetPtrs;
-	for(const auto& pipeSet : mPipeSets)
-	{
-		pipeSetPtrs.push_back(&pipeSet);
-	}
+	static const auto& pipeWidth = static_cast<float>(mTextures.getResourceRect(Textures_ID::Pipe_Green).width);
 
-	std::sort(pipeSetPtrs.begin(), pipeSetPtrs.end(), 
-		[&calculateHorizontalDistance](const PipeSet* a, const PipeSet* b)
+	const PipeSet* nearestPipeSet = nullptr;
+	auto nearestDistance = std::numeric_limits<float>::max();
+	for (const auto& pipeSet : mPipeSets)
 	{
-		return calculateHorizontalDistance(a->position()) < calculateHorizontalDistance(b->position());
-	});
-
-	return pipeSetPtrs;
-}
+		const auto pipeSetX = pipeSet.position().x;
+		if (position.x > pipeSetX + pipeWidth / 1.8f)
+		{
+			continue;
+		}
 
-std::vector<const PipeSet*> PipesGenerator::sortedByDistancePipesetsInfrontOfPoint(const sf::Vector2f& position) const
-{
-	static const auto& pipeWidth = static_cast<float>(mTextures.getResourceReference(Textures_ID::Pipe_Green).getSize().x);
-	auto neartestPipes = sortedByDistancePipeSets(position);
-	neartestPipes.erase(
-		std::remove_if(neartestPipes.begin(), neartestPipes.end(),
-			[&position](const PipeSet* pipe) { return position.x > pipe->position().x + pipeWidth / 1.8f;  }),
-	neartestPipes.end());
-	return neartestPipes;
+		const auto horizontalDistance = std::abs(position.x - pipeSetX);
+		if (horizontalDistance < nearestDistance)
+		{
+			nearestDistance = horizontalDistance;
+			nearestPipeSet = &pipeSet;
+		}
+	}
+	return nearestPipeSet;
 }
 
-void PipesGenerator::checkCollision(Bird& bird) const
+bool PipesGenerator::collides(const sf::FloatRect& birdBounds) const
 {
 	for (const auto& pipeSet : mPipeSets)
 	{
 		for (const auto& pipe : {std::ref(pipeSet.bottomPipe()), std::ref(pipeSet.upperPipe())})
 		{
-			if (pipe.get().getPipeBounds().intersects(bird.getBirdBounds()))
+			if (pipe.get().getPipeBounds().intersects(birdBounds))
 			{
-				bird.kill();
-
-				auto birdVelocity = (bird.velocity().y < 0) ? 0 : bird.velocity().y;
-				bird.setVelocity({-Pipe::pipeSpeed(), birdVelocity});
+				return true;
 			}
 		}
 	}
+	return false;
 }
 
 void PipesGenerator::restart()
 {
-	mPipeSets.clear();
+	mPipeSets.releaseAll();
+	mNextCoursePipeSet = 0;
+	mLastPipeSetDistance = 0.f;
+	mCourseTime = sf::Time::Zero;
 }
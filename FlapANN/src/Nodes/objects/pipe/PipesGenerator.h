@@ -1,27 +1,48 @@
 #pragma once
 
-#include <deque>
 #include <memory>
 #include "Pipe.h"
+#include "PipeCourse.h"
 #include "PipeSet.h"
-#include "nodes/objects/bird/Bird.h"
+#include "PipeSetPool.h"
 
 
 /**
  * \brief The generator creates pipes based on the information and parameters provided
+ *
+ * Pipes are not randomized on the fly. They are taken one after another from
+ * the pipe course, which can be shared with other generators, so all of them
+ * place exactly the same pipes at exactly the same moments of the course.
  */
 class PipesGenerator : public NodeScene
 {
+public :
 	/**
-	 * \brief Contains data needed to calculate randomized offsets
+	 * \brief Pipe set that is currently on the course
 	 */
-	struct PipeOffset
+	struct PlacedPipeSet
 	{
-		float minPipeOffset;
-		float maxPipeOffset;
+		sf::Vector2f bottomPipeSpawnPosition;
+		sf::Vector2f upperPipeSpawnPosition;
+		MovePattern movePattern;
+		sf::Time spawnTime;
+	};
+
+	/**
+	 * \brief Everything that changes in the generator while the game is running
+	 *
+	 * The course plays the role of the random number generator, so its state
+	 * is just the course and the index of the next pipe set taken from it.
+	 */
+	struct State
+	{
+		std::shared_ptr<const PipeCourse> course;
+		std::size_t nextCoursePipeSet;
+		float lastPipeSetDistance;
+		sf::Time courseTime;
+		std::vector<PlacedPipeSet> pipeSets;
 	};
 
-public :
 	/**
 	 * \brief The main constructor of the pipe generator.
 	 * \param textures Texture manager holds all the available textures in the game.
@@ -49,27 +70,21 @@ public :
 	void drawThis(sf::RenderTarget& target, sf::RenderStates states) const override;
 
 	/**
-	 * \brief Sorts pipesets by distance from a given point.
-	 * PipeSets are ordered by increasing distance.
+	 * \brief Finds the pipeset horizontally nearest to a given point considering only those on the front of the point
 	 * \param position Point from which the distance is calculated
-	 * \return An ascending distance-sorted vector of Pipesets
+	 * \return The nearest pipeset, or nullptr if there are no pipesets in front of the point
+	 *
+	 * It is asked for by every bird in every tick, so it only scans the pipesets without sorting or allocating them.
 	 */
-	std::vector<const PipeSet*> sortedByDistancePipeSets(const sf::Vector2f& position) const;
-
-	/**
-	 * \brief Sorts pipesets by distance from a given point considering only those on the front of the point
-	 * PipeSets are ordered by increasing distance.
-	 * \param position Point from which the distance is calculated
-	 * \return An ascending distance-sorted vector of Pipesets
-	 */
-	std::vector<const PipeSet*> sortedByDistancePipesetsInfrontOfPoint(const sf::Vector2f& position) const;
+	const PipeSet* nearestPipeSetInFrontOfPoint(const sf::Vector2f& position) const;
 
 	/**
 	 * \brief Checks if the bird and pipes are colliding
 	 * (intersecting with each other)
-	 * \param bird Reference to bird
+	 * \param birdBounds Bounds of the bird
+	 * \return True if the bird hits any of the pipes
 	 */
-	void checkCollision(Bird& bird) const;
+	bool collides(const sf::FloatRect& birdBounds) const;
 
 	/**
 	 * \brief Restarts the generator, starting generation again
@@ -77,29 +92,49 @@ public :
 	 */
 	void restart();
 
-private:
 	/**
-	 * \brief Calculates random pipe offset using random number generator. 
-	 * \return x and y offset values.
+	 * \brief Makes the generator follow the given course
+	 * \param course Course shared with other generators
+	 *
+	 * Pipe sets already placed stay as they are, the following ones come from the given course.
 	 */
-	[[nodiscard]] inline sf::Vector2f randomPipeOffset() const;
+	void useCourse(std::shared_ptr<const PipeCourse> course);
 
 	/**
-	 * \brief Retrieves the position of the last pipe added to the deque.
-	 * \return Position (x, y) of the pipe.
+	 * \brief Returns the course followed by the generator
+	 * \return Course that can be shared with other generators
 	 */
-	[[nodiscard]] inline sf::Vector2f lastPipeSetPosition() const;
+	const std::shared_ptr<const PipeCourse>& course() const;
 
 	/**
-	 * \brief Creates another pipe that is offset from the last pipe in the deque by the given offset.
-	 * \param offset Offset from the last pipe in the deque
-	 * \param pipeTextureId Pipe texture id
-	 * \return Newly created pipe
+	 * \brief Returns the current state of the generator
+	 * \return State from which the generator can be restored
 	 */
-	[[nodiscard]] std::unique_ptr<Pipe> createNextPipeWithOffset(const sf::Vector2f& offset, Textures_ID pipeTextureId = Textures_ID::Pipe_Green) const;
+	State state() const;
 
 	/**
-	 * \brief It generates both bottom and upper pipe.
+	 * \brief Brings the generator and all its pipes back to the given state
+	 * \param state State previously taken from the generator
+	 */
+	void restoreState(const State& state);
+
+private:
+	/**
+	 * \brief Generates the course again using the current settings.
+	 *
+	 * The course is never modified in place, as it might be read by others at the same time.
+	 */
+	void regenerateCourse();
+
+	/**
+	 * \brief Calculates how many pipe sets may be present at the same time.
+	 * \param screenSize Holds width and height of the game screen
+	 * \return Maximum number of pipe sets present at the same time
+	 */
+	[[nodiscard]] std::size_t maximumNumberOfPipeSets(const sf::Vector2u& screenSize) const;
+
+	/**
+	 * \brief It places both bottom and upper pipe of the next pipe set.
 	 */
 	void generatePipe();
 
@@ -109,10 +144,9 @@ private:
 	void deleteFrontPipe();
 
 	/**
-	 * \brief Updates pipes' position on the screen.
-	 * \param deltaTime the time that has passed since the game was last updated
+	 * \brief Places all the pipes where they are at the current moment of the course.
 	 */
-	void updatePipesPosition(const sf::Time& deltaTime);
+	void updatePipesPosition();
 
 	/**
 	 * \brief Determines if the pipe is outside the window area.
@@ -121,10 +155,10 @@ private:
 	bool isFrontPipeSetOutOfSight() const;
 
 	/**
-	 * \brief Determines whether a pipe should be generated at a given time.
-	 * \return Tru if the pipe is in window frame. False otherwise.
+	 * \brief Determines whether the next pipe set of the course should be placed at a given time.
+	 * \return True if the last placed pipe set is in window frame. False otherwise.
 	 */
-	bool isLastPipeSetInsideWindowFrame() const;
+	bool isNextPipeSetDue() const;
 
 	/**
 	 * \brief Updates the slider that sets the distance value between the upper and bottom pipes.
@@ -146,40 +180,40 @@ private:
 	 */
 	void updateImGuiMovePatternSpeed();
 
+	/**
+	 * \brief Updates the seed of the course
+	 */
+	void updateImGuiCourseSeed();
+
 private:
 	/** A manager that stores references to textures in the game */
 	const TextureManager& mTextures;
 
-	/** A manager that stores references to fonts in the game */
-	const FontManager& mFonts;
-
 	/**
-	 * Specifies the minimum and maximum distance being an additional offset
-	 * separating successive generated pipes in horizontal distance
+	 * Settings of the course generated by this generator: the distance separating
+	 * successive pipes, the vertical range of the gap, distance between bottom and
+	 * top pipe and the additional movement of newly created pipes.
 	 */
-	PipeOffset xCoordinate{ 85.f, 110.f };
+	PipeCourse::Settings mCourseSettings{ 0, 85.f, 110.f, 30.f, 0.f, 55.f, MovePattern() };
 
-	/**
-	 * Specifies the additional vertical offset by which
-	 * the pipe can move (up/down).
-	 */
-	PipeOffset yCoordinate{ 30.f, 0.f };
-
-	/** Used to determine pipe clipping point */
-	float mClippingPoint;
+	/** The course from which the pipe sets are taken. Read-only, so it can be shared. */
+	std::shared_ptr<const PipeCourse> mCourse;
 
-	/**	Distance between bottom and top pipe */
-	float mOffsetBetweenPipes{55};
+	/** Index of the next pipe set of the course to place */
+	std::size_t mNextCoursePipeSet;
 
-	/** An additional movement of newly created pipes. **/
-	MovePattern mMovePattern;
+	/** Horizontal distance of the last placed pipe set from the start of the course */
+	float mLastPipeSetDistance;
 
-	/** Produces high quality unsigned integer random numbers */
-	static std::mt19937 engine;
+	/** Used to determine pipe clipping point */
+	float mClippingPoint;
 
-	/** Random number generator, used in order to seed engine */
-	static std::random_device rndDevice;
+	/** Time that has passed since the course (generation of pipes) started */
+	sf::Time mCourseTime;
 
-	/** Hold pipes that are currently being rendered on the screen */
-	std::deque<PipeSet> mPipeSets;
+	/**
+	 * Hold pipes that are currently being rendered on the screen.
+	 * Pipes that left the screen are reused for the next ones.
+	 */
+	PipeSetPool mPipeSets;
 };
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "Optimizer.h"
+
+#include <algorithm>
+
+#include "CmaEsOptimizer.h"
+#include "GeneticOptimizer.h"
+#include "MirroredEsOptimizer.h"
+
+namespace
+{
+	/** Standard deviation of the genes of the first candidates of CMA-ES */
+	constexpr float CMA_ES_INITIAL_STEP_SIZE = 0.5f;
+}
+
+std::unique_ptr<Optimizer> Optimizer::create(Backend backend, const std::vector<unsigned>& layers, int topEvolvingUnits)
+{
+	switch (backend)
+	{
+	case Backend::Genetic:
+		return std::make_unique<GeneticOptimizer>(topEvolvingUnits, layers);
+	case Backend::CmaEs:
+		return std::make_unique<CmaEsOptimizer>(randomGenome(layers), CMA_ES_INITIAL_STEP_SIZE);
+	case Backend::MirroredEs:
+		return std::make_unique<MirroredEsOptimizer>(randomGenome(layers));
+	}
+	assert(false);
+	return nullptr;
+}
+
+std::pair<fann_neuron*, fann_neuron*> Optimizer::neuronsOf(const fann* ann)
+{
+	return { ann->first_layer->first_neuron, (ann->last_layer - 1)->last_neuron };
+}
+
+Optimizer::Genome Optimizer::genomeOf(const fann* ann)
+{
+	Genome genome(ann->weights, ann->weights + ann->total_connections);
+	const auto [firstNeuron, lastNeuron] = neuronsOf(ann);
+	for (const auto* neuron = firstNeuron; neuron != lastNeuron; ++neuron)
+	{
+		genome.push_back(neuron->activation_steepness);
+	}
+	return genome;
+}
+
+void Optimizer::applyGenome(const Genome& genome, fann* ann)
+{
+	assert(genome.size() >= ann->total_connections);
+	std::copy_n(genome.cbegin(), ann->total_connections, ann->weights);
+
+	auto steepness = genome.cbegin() + ann->total_connections;
+	const auto [firstNeuron, lastNeuron] = neuronsOf(ann);
+	for (auto* neuron = firstNeuron; neuron != lastNeuron; ++neuron)
+	{
+		assert(steepness != genome.cend());
+		neuron->activation_steepness = *steepness++;
+	}
+}
+
+Optimizer::Genome Optimizer::randomGenome(const std::vector<unsigned>& layers)
+{
+	auto* ann = fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data());
+	fann_randomize_weights(ann, -1.f, 1.f);
+	auto genome = genomeOf(ann);
+	fann_destroy(ann);
+	return genome;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "fann/fann.h"
+
+/**
+ * \brief Backend searching for the genes of the networks, driven by asking for candidates and telling their fitness.
+ *
+ * The genome of a network is the list of its weights followed by the steepness of every neuron.
+ * The optimizer never plays the game itself. It is asked for the candidates, somebody else
+ * scores them, and then it is told how good they were. The candidates told do not have to be
+ * the ones that were asked for, which happens for example when the population is seeded from
+ * the hall of fame, so every backend learns from the genomes it is given.
+ */
+class Optimizer
+{
+public:
+	using Genome = std::vector<fann_type>;
+
+	/**
+	 * \brief Available backends
+	 */
+	enum class Backend
+	{
+		Genetic,
+		CmaEs,
+		MirroredEs,
+	};
+
+	virtual ~Optimizer() = default;
+
+	/**
+	 * \brief Creates the backend starting from random networks
+	 * \param backend Kind of the backend
+	 * \param layers Number of neurons in every layer of the networks
+	 * \param topEvolvingUnits How many of the best units the genetic algorithm breeds from
+	 * \return New optimizer
+	 */
+	static std::unique_ptr<Optimizer> create(Backend backend, const std::vector<unsigned>& layers, int topEvolvingUnits);
+
+	/**
+	 * \brief Returns the genomes to be scored next
+	 * \param numberOfCandidates Number of the genomes
+	 * \return New candidates
+	 */
+	virtual std::vector<Genome> ask(std::size_t numberOfCandidates) = 0;
+
+	/**
+	 * \brief Learns from the scored genomes
+	 * \param candidates Scored genomes
+	 * \param fitness Fitness of every genome, the higher the better
+	 */
+	virtual void tell(const std::vector<Genome>& candidates, const std::vector<float>& fitness) = 0;
+
+	/**
+	 * \brief Returns the name displayed to the user
+	 * \return Name of the backend
+	 */
+	virtual const char* name() const = 0;
+
+	/**
+	 * \brief Returns the neurons of all the layers of the network, which lie in a single array
+	 * \param ann Network to read
+	 * \return The first neuron and the one past the last neuron of the network
+	 */
+	static std::pair<fann_neuron*, fann_neuron*> neuronsOf(const fann* ann);
+
+	/**
+	 * \brief Reads the genome of the network
+	 * \param ann Network to read
+	 * \return Weights followed by the steepness of every neuron
+	 */
+	static Genome genomeOf(const fann* ann);
+
+	/**
+	 * \brief Writes the genome into the network of the same layout
+	 * \param genome Genome to write
+	 * \param ann Network to overwrite
+	 */
+	static void applyGenome(const Genome& genome, fann* ann);
+
+	/**
+	 * \brief Creates the genome of the network with random weights ranging from -1 to 1
+	 * \param layers Number of neurons in every layer
+	 * \return Genome of the random network
+	 */
+	static Genome randomGenome(const std::vector<unsigned>& layers);
+};
+
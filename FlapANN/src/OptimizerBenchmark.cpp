@@ -0,0 +1,145 @@
+#include "pch.h"
+#include "OptimizerBenchmark.h"
+
+#include <algorithm>
+#include <imgui/imgui.h>
+
+OptimizerBenchmark::OptimizerBenchmark() :
+	mIsCancelled(false)
+{
+}
+
+OptimizerBenchmark::~OptimizerBenchmark()
+{
+	mIsCancelled = true;
+	if (mRunningBenchmark.valid())
+	{
+		mRunningBenchmark.wait();
+	}
+}
+
+void OptimizerBenchmark::start(const HeadlessGeometry& geometry, const PipeCourse::Settings& courseSettings,
+                               const std::vector<unsigned>& layers, int topEvolvingUnits)
+{
+	if (isRunning())
+	{
+		return;
+	}
+
+	mIsCancelled = false;
+	mResults.clear();
+
+	// Backends running side by side would slow each other down, which skews the measured times
+	mRunningBenchmark = std::async(std::launch::async, [=, evaluator = FitnessEvaluator(geometry), settings = mSettings, &isCancelled = mIsCancelled]()
+	{
+		constexpr Optimizer::Backend backends[] = { Optimizer::Backend::Genetic, Optimizer::Backend::CmaEs, Optimizer::Backend::MirroredEs };
+		std::vector<Result> results;
+		for (const auto backend : backends)
+		{
+			if (isCancelled)
+			{
+				break;
+			}
+			auto optimizer = Optimizer::create(backend, layers, topEvolvingUnits);
+			results.push_back(run(*optimizer, evaluator, courseSettings, layers, settings, isCancelled));
+		}
+		return results;
+	});
+}
+
+bool OptimizerBenchmark::isRunning() const
+{
+	return mRunningBenchmark.valid() && mRunningBenchmark.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+void OptimizerBenchmark::updateImGui()
+{
+	if (mRunningBenchmark.valid() && !isRunning())
+	{
+		mResults = mRunningBenchmark.get();
+	}
+
+	if (!ImGui::TreeNode("Benchmark"))
+	{
+		return;
+	}
+
+	if (isRunning())
+	{
+		ImGui::TextUnformatted("Running the backends one after another, the training is paused...");
+	}
+	else
+	{
+		ImGui::SliderInt("Candidates", &mSettings.populationSize, 10, 300);
+		ImGui::SliderInt("Evaluation budget", &mSettings.evaluationBudget, 1000, 100000);
+		ImGui::SliderFloat("Target fitness", &mSettings.targetFitness, 1.f, 120.f, "%.1f");
+		ImGui::SliderInt("Courses", &mSettings.evaluation.numberOfSeeds, 1, 8);
+		mSettings.evaluation.maximumTicks = static_cast<std::uint32_t>((mSettings.targetFitness + 10.f) * 60.f);
+	}
+
+	constexpr auto tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+	if (!mResults.empty() && ImGui::BeginTable("Results", 5, tableFlags))
+	{
+		ImGui::TableSetupColumn("Backend");
+		ImGui::TableSetupColumn("Evaluations");
+		ImGui::TableSetupColumn("Solved");
+		ImGui::TableSetupColumn("Best fitness");
+		ImGui::TableSetupColumn("Time [s]");
+		ImGui::TableHeadersRow();
+		for (const auto& result : mResults)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(result.name);
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", result.evaluations);
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(result.isSolved ? "Yes" : "No");
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", result.bestFitness);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", result.seconds);
+		}
+		ImGui::EndTable();
+	}
+	ImGui::TreePop();
+}
+
+OptimizerBenchmark::Result OptimizerBenchmark::run(Optimizer& optimizer, const FitnessEvaluator& evaluator,
+                                                   const PipeCourse::Settings& courseSettings,
+                                                   const std::vector<unsigned>& layers, const Settings& settings,
+                                                   const std::atomic<bool>& isCancelled)
+{
+	sf::Clock clock;
+	Result result{ optimizer.name(), 0, false, 0.f, 0.f };
+	std::vector<GeneticAlgorithm::Unit> units;
+	std::vector<float> fitness;
+	while (!result.isSolved && result.evaluations < settings.evaluationBudget && !isCancelled)
+	{
+		const auto candidates = optimizer.ask(static_cast<std::size_t>(settings.populationSize));
+		units.clear();
+		for (const auto& genome : candidates)
+		{
+			auto ann = fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data());
+			Optimizer::applyGenome(genome, ann);
+			units.emplace_back(ann, static_cast<int>(units.size()), 0);
+		}
+
+		// Nothing is cached, so every backend pays for each of its candidates
+		evaluator.evaluate(units, courseSettings, settings.evaluation);
+		fitness.clear();
+		for (const auto& unit : units)
+		{
+			fitness.push_back(unit.fitness);
+			result.bestFitness = std::max(result.bestFitness, unit.fitness);
+			++result.evaluations;
+			if (unit.fitness >= settings.targetFitness)
+			{
+				result.isSolved = true;
+			}
+		}
+		optimizer.tell(candidates, fitness);
+	}
+	result.seconds = clock.getElapsedTime().asSeconds();
+	return result;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "FitnessEvaluator.h"
+#include "Optimizer.h"
+
+/**
+ * \brief Compares the optimizer backends on the same headless task.
+ *
+ * Every backend is asked for candidates, which play the seeded courses without any graphics,
+ * and is told their fitness, until one of them reaches the target fitness or the budget of
+ * evaluations runs out. The backends run one after another on a background thread, and the
+ * training is paused in the meantime, so none of them competes with anything else for the
+ * processor and their times can be compared. The number of evaluations needed to solve the
+ * task still tells the backends apart best, as it does not depend on the machine.
+ */
+class OptimizerBenchmark
+{
+public:
+	/**
+	 * \brief Task every backend has to solve
+	 */
+	struct Settings
+	{
+		/** Number of candidates asked for at once */
+		int populationSize = 50;
+
+		/** Number of evaluations after which the backend gives up */
+		int evaluationBudget = 20000;
+
+		/** Fitness at which the task is solved */
+		float targetFitness = 60.f;
+
+		/** Courses the candidates play */
+		FitnessEvaluator::Settings evaluation{ 3, FitnessEvaluator::Aggregation::Minimum, 0.25f, 70 * 60 };
+	};
+
+	/**
+	 * \brief Outcome of a single backend
+	 */
+	struct Result
+	{
+		const char* name;
+		int evaluations;
+		bool isSolved;
+		float bestFitness;
+		float seconds;
+	};
+
+	OptimizerBenchmark();
+
+	/**
+	 * \brief Stops the running backend after its current candidates are scored
+	 */
+	~OptimizerBenchmark();
+
+	/**
+	 * \brief Starts the benchmark of all the backends, unless it is running already
+	 * \param geometry Sizes and forces of the game
+	 * \param courseSettings Settings of the first course played
+	 * \param layers Number of neurons in every layer of the networks
+	 * \param topEvolvingUnits How many of the best units the genetic algorithm breeds from
+	 */
+	void start(const HeadlessGeometry& geometry, const PipeCourse::Settings& courseSettings,
+	           const std::vector<unsigned>& layers, int topEvolvingUnits);
+
+	/**
+	 * \brief Checks if any backend is still being benchmarked
+	 * \return True if the benchmark was started and has not finished yet
+	 */
+	bool isRunning() const;
+
+	/**
+	 * \brief Updates the settings of the task and the table of the results
+	 */
+	void updateImGui();
+
+private:
+	/**
+	 * \brief Solves the task with the backend, on the calling thread
+	 * \param optimizer Backend to benchmark
+	 * \param evaluator Evaluator playing the courses
+	 * \param courseSettings Settings of the first course played
+	 * \param layers Number of neurons in every layer of the networks
+	 * \param settings Task to solve
+	 * \param isCancelled Set when the benchmark has to stop early
+	 * \return Outcome of the backend
+	 */
+	static Result run(Optimizer& optimizer, const FitnessEvaluator& evaluator, const PipeCourse::Settings& courseSettings,
+	                  const std::vector<unsigned>& layers, const Settings& settings, const std::atomic<bool>& isCancelled);
+
+private:
+	/** Task every backend has to solve */
+	Settings mSettings;
+
+	/** Benchmark running all the backends in turn */
+	std::future<std::vector<Result>> mRunningBenchmark;
+
+	/** Set when the running backend has to stop early */
+	std::atomic<bool> mIsCancelled;
+
+	/** Outcomes of the last finished benchmark, in the order of the backends */
+	std::vector<Result> mResults;
+};
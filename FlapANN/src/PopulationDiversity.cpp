@@ -0,0 +1,360 @@
+#include "pch.h"
+#include "PopulationDiversity.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <imgui/imgui.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define FLAPANN_DIVERSITY_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// Every kernel goes through whole blocks of eight floats. With SSE each block is two
+	// registers, accumulated separately so the additions do not wait for each other.
+
+#ifdef FLAPANN_DIVERSITY_SSE
+	float horizontalSum(__m128 values)
+	{
+		const auto high = _mm_movehl_ps(values, values);
+		const auto pairs = _mm_add_ps(values, high);
+		const auto sum = _mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1));
+		return _mm_cvtss_f32(sum);
+	}
+#endif
+
+	/**
+	 * \brief Adds the row to the accumulated sums
+	 */
+	void addRow(float* sums, const float* row, std::size_t stride)
+	{
+#ifdef FLAPANN_DIVERSITY_SSE
+		for (std::size_t i = 0; i < stride; i += 8)
+		{
+			_mm_storeu_ps(sums + i, _mm_add_ps(_mm_loadu_ps(sums + i), _mm_loadu_ps(row + i)));
+			_mm_storeu_ps(sums + i + 4, _mm_add_ps(_mm_loadu_ps(sums + i + 4), _mm_loadu_ps(row + i + 4)));
+		}
+#else
+		for (std::size_t i = 0; i < stride; ++i)
+		{
+			sums[i] += row[i];
+		}
+#endif
+	}
+
+	/**
+	 * \brief Computes the squared Euclidean distance between two rows
+	 */
+	float squaredDistance(const float* a, const float* b, std::size_t stride)
+	{
+#ifdef FLAPANN_DIVERSITY_SSE
+		auto low = _mm_setzero_ps();
+		auto high = _mm_setzero_ps();
+		for (std::size_t i = 0; i < stride; i += 8)
+		{
+			const auto lowDelta = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+			const auto highDelta = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+			low = _mm_add_ps(low, _mm_mul_ps(lowDelta, lowDelta));
+			high = _mm_add_ps(high, _mm_mul_ps(highDelta, highDelta));
+		}
+		return horizontalSum(_mm_add_ps(low, high));
+#else
+		float lanes[8] = {};
+		for (std::size_t i = 0; i < stride; i += 8)
+		{
+			for (std::size_t lane = 0; lane < 8; ++lane)
+			{
+				const auto delta = a[i + lane] - b[i + lane];
+				lanes[lane] += delta * delta;
+			}
+		}
+		return std::accumulate(std::begin(lanes), std::end(lanes), 0.f);
+#endif
+	}
+
+	/**
+	 * \brief Adds the squared deviations of the row from the centroid to the sums of every weight
+	 * \return Squared Euclidean distance between the row and the centroid
+	 */
+	float addSquaredDeviations(float* squaredDeviations, const float* row, const float* centroid, std::size_t stride)
+	{
+#ifdef FLAPANN_DIVERSITY_SSE
+		auto low = _mm_setzero_ps();
+		auto high = _mm_setzero_ps();
+		for (std::size_t i = 0; i < stride; i += 8)
+		{
+			const auto lowDelta = _mm_sub_ps(_mm_loadu_ps(row + i), _mm_loadu_ps(centroid + i));
+			const auto highDelta = _mm_sub_ps(_mm_loadu_ps(row + i + 4), _mm_loadu_ps(centroid + i + 4));
+			const auto lowSquared = _mm_mul_ps(lowDelta, lowDelta);
+			const auto highSquared = _mm_mul_ps(highDelta, highDelta);
+			_mm_storeu_ps(squaredDeviations + i, _mm_add_ps(_mm_loadu_ps(squaredDeviations + i), lowSquared));
+			_mm_storeu_ps(squaredDeviations + i + 4, _mm_add_ps(_mm_loadu_ps(squaredDeviations + i + 4), highSquared));
+			low = _mm_add_ps(low, lowSquared);
+			high = _mm_add_ps(high, highSquared);
+		}
+		return horizontalSum(_mm_add_ps(low, high));
+#else
+		auto distance = 0.f;
+		for (std::size_t i = 0; i < stride; ++i)
+		{
+			const auto delta = row[i] - centroid[i];
+			squaredDeviations[i] += delta * delta;
+			distance += delta * delta;
+		}
+		return distance;
+#endif
+	}
+
+	/**
+	 * \brief Computes the difference between the value and its reference, relative to the reference
+	 */
+	float relativeDifference(double value, double reference)
+	{
+		return static_cast<float>(std::abs(value - reference) / std::max(std::abs(reference), 1e-6));
+	}
+
+	/**
+	 * \brief Computes the squared Euclidean distance between two networks, one weight after the other
+	 */
+	double referenceSquaredDistance(const fann* a, const fann* b)
+	{
+		auto distance = 0.;
+		for (unsigned int weight = 0; weight < a->total_connections; ++weight)
+		{
+			const auto delta = static_cast<double>(a->weights[weight]) - static_cast<double>(b->weights[weight]);
+			distance += delta * delta;
+		}
+		return distance;
+	}
+}
+
+bool DiversityCheck::isMatching() const
+{
+	return centroidSpread <= TOLERANCE && weightVariance <= TOLERANCE && squaredDistance <= TOLERANCE
+	       && meanPairwiseDistance.value_or(0.f) <= TOLERANCE;
+}
+
+PopulationDiversity::PopulationDiversity(std::size_t maximumExactUnits, std::size_t sampledPairs) :
+	mMaximumExactUnits(maximumExactUnits),
+	mSampledPairs(sampledPairs),
+	mNumberOfUnits(0),
+	mNumberOfWeights(0),
+	mStride(0),
+	mRandomGenerator(std::random_device{}()),
+	mIsCheckRequested(false)
+{
+}
+
+const DiversityReport& PopulationDiversity::measure(const std::vector<GeneticAlgorithm::Unit>& population)
+{
+	mReport = {};
+	if (population.size() < 2)
+	{
+		return mReport;
+	}
+
+	gatherWeights(population);
+	measureSpread();
+	measurePairwiseDistance();
+	if (mIsCheckRequested)
+	{
+		mCheck = checkAgainstReference(population);
+		mIsCheckRequested = false;
+	}
+	return mReport;
+}
+
+const DiversityReport& PopulationDiversity::report() const
+{
+	return mReport;
+}
+
+void PopulationDiversity::updateImGui()
+{
+	if (!ImGui::CollapsingHeader("Diversity"))
+	{
+		return;
+	}
+
+	ImGui::Text("Mean pairwise distance: %.3f (%zu pairs%s)", mReport.meanPairwiseDistance, mReport.measuredPairs,
+	            mReport.isSampled ? ", sampled" : "");
+	ImGui::Text("Centroid spread: %.3f", mReport.centroidSpread);
+	ImGui::Text("Mean weight deviation: %.3f", mReport.meanWeightDeviation);
+	ImGui::PlotHistogram("Weight variance", mReport.weightVariance.data(), static_cast<int>(mReport.weightVariance.size()),
+	                     0, nullptr, 0.f, FLT_MAX, ImVec2(0.f, 60.f));
+
+	if (mIsCheckRequested)
+	{
+		ImGui::TextUnformatted("Checking the next generation against the scalar reference...");
+	}
+	else if (ImGui::Button("Check against the scalar reference"))
+	{
+		mIsCheckRequested = true;
+	}
+	if (mCheck)
+	{
+		ImGui::Text("Kernels %s the reference (tolerance %.0e)", mCheck->isMatching() ? "match" : "differ from",
+		            DiversityCheck::TOLERANCE);
+		ImGui::Text("Centroid spread: %.2e, weight variance: %.2e", mCheck->centroidSpread, mCheck->weightVariance);
+		ImGui::Text("Squared distance: %.2e", mCheck->squaredDistance);
+		if (mCheck->meanPairwiseDistance)
+		{
+			ImGui::Text("Mean pairwise distance: %.2e", *mCheck->meanPairwiseDistance);
+		}
+	}
+}
+
+void PopulationDiversity::gatherWeights(const std::vector<GeneticAlgorithm::Unit>& population)
+{
+	mNumberOfUnits = population.size();
+	mNumberOfWeights = population.front().ann->total_connections;
+	mStride = (mNumberOfWeights + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+	// The buffer only grows, so measuring the population of the same size allocates nothing
+	mWeights.resize(mNumberOfUnits * mStride);
+	for (std::size_t unit = 0; unit < mNumberOfUnits; ++unit)
+	{
+		assert(population[unit].ann->total_connections == mNumberOfWeights);
+		auto* row = mWeights.data() + unit * mStride;
+		std::copy_n(population[unit].ann->weights, mNumberOfWeights, row);
+		std::fill(row + mNumberOfWeights, row + mStride, 0.f);
+	}
+}
+
+void PopulationDiversity::measureSpread()
+{
+	mCentroid.assign(mStride, 0.f);
+	for (std::size_t unit = 0; unit < mNumberOfUnits; ++unit)
+	{
+		addRow(mCentroid.data(), rowOf(unit), mStride);
+	}
+	for (auto& weight : mCentroid)
+	{
+		weight /= static_cast<float>(mNumberOfUnits);
+	}
+
+	// The deviations are taken from the centroid of the first pass, which keeps them accurate
+	mSquaredDeviations.assign(mStride, 0.f);
+	auto sumOfSpreads = 0.f;
+	for (std::size_t unit = 0; unit < mNumberOfUnits; ++unit)
+	{
+		sumOfSpreads += std::sqrt(addSquaredDeviations(mSquaredDeviations.data(), rowOf(unit), mCentroid.data(), mStride));
+	}
+	mReport.centroidSpread = sumOfSpreads / static_cast<float>(mNumberOfUnits);
+
+	mReport.weightVariance.resize(mNumberOfWeights);
+	auto sumOfDeviations = 0.f;
+	for (std::size_t weight = 0; weight < mNumberOfWeights; ++weight)
+	{
+		mReport.weightVariance[weight] = mSquaredDeviations[weight] / static_cast<float>(mNumberOfUnits);
+		sumOfDeviations += std::sqrt(mReport.weightVariance[weight]);
+	}
+	mReport.meanWeightDeviation = sumOfDeviations / static_cast<float>(mNumberOfWeights);
+}
+
+void PopulationDiversity::measurePairwiseDistance()
+{
+	auto sumOfDistances = 0.;
+	if (mNumberOfUnits <= mMaximumExactUnits)
+	{
+		for (std::size_t first = 0; first < mNumberOfUnits; ++first)
+		{
+			for (std::size_t second = first + 1; second < mNumberOfUnits; ++second)
+			{
+				sumOfDistances += std::sqrt(squaredDistance(rowOf(first), rowOf(second), mStride));
+			}
+		}
+		mReport.measuredPairs = mNumberOfUnits * (mNumberOfUnits - 1) / 2;
+	}
+	else
+	{
+		// Two different units per pair, drawn independently from the others
+		std::uniform_int_distribution<std::size_t> firstUnit(0, mNumberOfUnits - 1);
+		std::uniform_int_distribution<std::size_t> secondUnit(0, mNumberOfUnits - 2);
+		for (std::size_t pair = 0; pair < mSampledPairs; ++pair)
+		{
+			const auto first = firstUnit(mRandomGenerator);
+			auto second = secondUnit(mRandomGenerator);
+			if (second >= first)
+			{
+				++second;
+			}
+			sumOfDistances += std::sqrt(squaredDistance(rowOf(first), rowOf(second), mStride));
+		}
+		mReport.measuredPairs = mSampledPairs;
+		mReport.isSampled = true;
+	}
+	mReport.meanPairwiseDistance = static_cast<float>(sumOfDistances / static_cast<double>(mReport.measuredPairs));
+}
+
+const float* PopulationDiversity::rowOf(std::size_t unit) const
+{
+	return mWeights.data() + unit * mStride;
+}
+
+DiversityCheck PopulationDiversity::checkAgainstReference(const std::vector<GeneticAlgorithm::Unit>& population) const
+{
+	// The reference reads the networks directly, so the gathering and the padding are checked too
+	const auto numberOfUnits = static_cast<double>(population.size());
+	std::vector<double> centroid(mNumberOfWeights, 0.);
+	for (const auto& unit : population)
+	{
+		for (std::size_t weight = 0; weight < mNumberOfWeights; ++weight)
+		{
+			centroid[weight] += unit.ann->weights[weight];
+		}
+	}
+	for (auto& weight : centroid)
+	{
+		weight /= numberOfUnits;
+	}
+
+	std::vector<double> squaredDeviations(mNumberOfWeights, 0.);
+	auto sumOfSpreads = 0.;
+	for (const auto& unit : population)
+	{
+		auto spread = 0.;
+		for (std::size_t weight = 0; weight < mNumberOfWeights; ++weight)
+		{
+			const auto delta = unit.ann->weights[weight] - centroid[weight];
+			squaredDeviations[weight] += delta * delta;
+			spread += delta * delta;
+		}
+		sumOfSpreads += std::sqrt(spread);
+	}
+
+	DiversityCheck check;
+	check.centroidSpread = relativeDifference(mReport.centroidSpread, sumOfSpreads / numberOfUnits);
+	for (std::size_t weight = 0; weight < mNumberOfWeights; ++weight)
+	{
+		const auto variance = relativeDifference(mReport.weightVariance[weight], squaredDeviations[weight] / numberOfUnits);
+		check.weightVariance = std::max(check.weightVariance, variance);
+	}
+
+	// The sampled pairs are random, so the kernel is compared pair by pair on the successive units instead
+	for (std::size_t unit = 0; unit + 1 < mNumberOfUnits; ++unit)
+	{
+		const auto distance = relativeDifference(squaredDistance(rowOf(unit), rowOf(unit + 1), mStride),
+		                                         referenceSquaredDistance(population[unit].ann, population[unit + 1].ann));
+		check.squaredDistance = std::max(check.squaredDistance, distance);
+	}
+
+	if (!mReport.isSampled)
+	{
+		auto sumOfDistances = 0.;
+		for (std::size_t first = 0; first < mNumberOfUnits; ++first)
+		{
+			for (std::size_t second = first + 1; second < mNumberOfUnits; ++second)
+			{
+				sumOfDistances += std::sqrt(referenceSquaredDistance(population[first].ann, population[second].ann));
+			}
+		}
+		check.meanPairwiseDistance = relativeDifference(mReport.meanPairwiseDistance,
+		                                                sumOfDistances / static_cast<double>(mReport.measuredPairs));
+	}
+	return check;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "GeneticAlgorithm.h"
+
+/**
+ * \brief Measures of how different the units of the population are
+ */
+struct DiversityReport
+{
+	/** Mean Euclidean distance between the weights of two units */
+	float meanPairwiseDistance = 0.f;
+
+	/** Mean Euclidean distance between the weights of a unit and the mean weights of the population */
+	float centroidSpread = 0.f;
+
+	/** Standard deviation of every weight across the population, averaged over all the weights */
+	float meanWeightDeviation = 0.f;
+
+	/** Variance of every weight across the population */
+	std::vector<float> weightVariance;
+
+	/** Number of pairs the mean pairwise distance was measured on */
+	std::size_t measuredPairs = 0;
+
+	/** Set if the pairs were drawn at random instead of measuring all of them */
+	bool isSampled = false;
+};
+
+/**
+ * \brief Largest relative differences between the kernels and the scalar reference
+ */
+struct DiversityCheck
+{
+	/** Difference of the spread around the mean weights */
+	float centroidSpread = 0.f;
+
+	/** Largest difference of the variance of a single weight */
+	float weightVariance = 0.f;
+
+	/** Largest difference of the squared distance of two successive units */
+	float squaredDistance = 0.f;
+
+	/** Difference of the mean pairwise distance, only measured when all the pairs are */
+	std::optional<float> meanPairwiseDistance;
+
+	/** Largest relative difference tolerated from the single precision of the kernels */
+	static constexpr float TOLERANCE = 1e-4f;
+
+	/**
+	 * \brief Tells if the kernels agree with the reference
+	 * \return True if all the differences are within the tolerance
+	 */
+	bool isMatching() const;
+};
+
+/**
+ * \brief Measures the diversity of the population cheaply enough to do it every generation.
+ *
+ * The weights of all the units are first gathered into a single buffer, one row per unit,
+ * each row padded with zeros to the whole number of blocks. The kernels then go through the
+ * rows block by block with SIMD instructions where they are available, and the padding does
+ * not change any of the distances. The mean pairwise distance is exact for small populations,
+ * and for the large ones it is estimated from the random sample of pairs.
+ *
+ * On request, the next measurement is compared with a plain scalar reference computed in
+ * double precision straight from the weights of the networks, so the kernels can be checked
+ * on the build and the machine they actually run on.
+ */
+class PopulationDiversity
+{
+public:
+	/**
+	 * \brief Creates the measure
+	 * \param maximumExactUnits Largest population for which every pair is measured
+	 * \param sampledPairs Number of random pairs measured in larger populations
+	 */
+	explicit PopulationDiversity(std::size_t maximumExactUnits = 256, std::size_t sampledPairs = 4096);
+
+	/**
+	 * \brief Measures the diversity of the population
+	 * \param population Population to measure, all of its networks have the same layout
+	 * \return Measured diversity, valid until the next measurement
+	 */
+	const DiversityReport& measure(const std::vector<GeneticAlgorithm::Unit>& population);
+
+	/**
+	 * \brief Returns the last measured diversity
+	 * \return Diversity of the last measured population
+	 */
+	const DiversityReport& report() const;
+
+	/**
+	 * \brief Shows the last measured diversity, and lets check the next measurement against the scalar reference
+	 */
+	void updateImGui();
+
+private:
+	/**
+	 * \brief Copies the weights of every unit into its padded row of the buffer
+	 * \param population Population whose weights are copied
+	 */
+	void gatherWeights(const std::vector<GeneticAlgorithm::Unit>& population);
+
+	/**
+	 * \brief Measures the spread around the mean weights, and the variance of every weight
+	 */
+	void measureSpread();
+
+	/**
+	 * \brief Measures the mean distance between the units, or estimates it from the random pairs
+	 */
+	void measurePairwiseDistance();
+
+	/**
+	 * \brief Returns the row of the buffer with the weights of the given unit
+	 * \param unit Index of the unit
+	 * \return First weight of the row
+	 */
+	const float* rowOf(std::size_t unit) const;
+
+	/**
+	 * \brief Compares the last measurement with the scalar reference
+	 * \param population Population that was just measured
+	 * \return Differences between the kernels and the reference
+	 */
+	DiversityCheck checkAgainstReference(const std::vector<GeneticAlgorithm::Unit>& population) const;
+
+private:
+	/** Number of floats processed by the kernels at once. Rows are padded to the multiple of it. */
+	static constexpr std::size_t BLOCK_SIZE = 8;
+
+	/** Largest population for which every pair is measured */
+	std::size_t mMaximumExactUnits;
+
+	/** Number of random pairs measured in larger populations */
+	std::size_t mSampledPairs;
+
+	/** Weights of all the units, one padded row per unit */
+	std::vector<float> mWeights;
+
+	/** Number of units in the buffer */
+	std::size_t mNumberOfUnits;
+
+	/** Number of weights of a single unit */
+	std::size_t mNumberOfWeights;
+
+	/** Distance between the starts of the successive rows */
+	std::size_t mStride;
+
+	/** Mean weights of the population, padded like the rows */
+	std::vector<float> mCentroid;
+
+	/** Sums of the squared deviations of every weight, padded like the rows */
+	std::vector<float> mSquaredDeviations;
+
+	/** Draws the pairs in large populations */
+	std::mt19937 mRandomGenerator;
+
+	/** Result of the last measurement */
+	DiversityReport mReport;
+
+	/** Set if the next measurement is checked against the scalar reference */
+	bool mIsCheckRequested;
+
+	/** Outcome of the last check against the scalar reference */
+	std::optional<DiversityCheck> mCheck;
+};
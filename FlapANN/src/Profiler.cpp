@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "Profiler.h"
+
+#include <cmath>
+#include <fstream>
+#include <imgui/imgui.h>
+
+const std::string Profiler::TRACE_PATH = "profile_trace.json";
+
+void LatencyHistogram::add(std::uint64_t nanoseconds)
+{
+	++mBuckets[bucketOf(nanoseconds)];
+	++mCount;
+	mTotal += nanoseconds;
+	mMaximum = std::max(mMaximum, nanoseconds);
+}
+
+std::uint64_t LatencyHistogram::percentile(float percentile) const
+{
+	if (mCount == 0)
+	{
+		return 0;
+	}
+
+	const auto wantedCount = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percentile * mCount)));
+	std::uint64_t countSoFar = 0;
+	for (std::size_t bucket = 0; bucket < mBuckets.size(); ++bucket)
+	{
+		countSoFar += mBuckets[bucket];
+		if (countSoFar >= wantedCount)
+		{
+			// The middle of the bucket is the best guess, but it can not be longer than anything measured
+			const auto lowerBound = lowerBoundOf(bucket);
+			const auto upperBound = bucket + 1 < mBuckets.size() ? lowerBoundOf(bucket + 1) : mMaximum;
+			return std::min(lowerBound + (upperBound - lowerBound) / 2, mMaximum);
+		}
+	}
+	return mMaximum;
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+	return mCount;
+}
+
+std::uint64_t LatencyHistogram::maximum() const
+{
+	return mMaximum;
+}
+
+std::uint64_t LatencyHistogram::mean() const
+{
+	return mCount == 0 ? 0 : mTotal / mCount;
+}
+
+void LatencyHistogram::clear()
+{
+	mBuckets.fill(0);
+	mCount = 0;
+	mTotal = 0;
+	mMaximum = 0;
+}
+
+std::size_t LatencyHistogram::bucketOf(std::uint64_t nanoseconds)
+{
+	if (nanoseconds < BUCKETS_PER_POWER)
+	{
+		return static_cast<std::size_t>(nanoseconds);
+	}
+
+	// Index of the highest set bit, found in six steps instead of checking bit after bit
+	std::size_t power = 0;
+	for (std::size_t shift = 32; shift > 0; shift /= 2)
+	{
+		if (nanoseconds >> (power + shift))
+		{
+			power += shift;
+		}
+	}
+
+	// The two bits following the highest one choose the bucket inside the power of two
+	const auto subBucket = (nanoseconds >> (power - 2)) & (BUCKETS_PER_POWER - 1);
+	return power * BUCKETS_PER_POWER + static_cast<std::size_t>(subBucket);
+}
+
+std::uint64_t LatencyHistogram::lowerBoundOf(std::size_t bucket)
+{
+	if (bucket < BUCKETS_PER_POWER)
+	{
+		return bucket;
+	}
+
+	const auto power = bucket / BUCKETS_PER_POWER;
+	const auto subBucket = bucket % BUCKETS_PER_POWER;
+	return static_cast<std::uint64_t>(BUCKETS_PER_POWER + subBucket) << (power - 2);
+}
+
+Profiler::Profiler() :
+	mEpoch(Clock::now()),
+	mTraceEvents(),
+	mNumberOfTraceEvents(0)
+{
+}
+
+Profiler& Profiler::instance()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+void Profiler::record(ProfilePhase phase, Clock::time_point start, Clock::time_point end, const AllocationCounters& allocated)
+{
+	const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	mHistograms[static_cast<std::size_t>(phase)].add(static_cast<std::uint64_t>(duration));
+	mAllocations[static_cast<std::size_t>(phase)] += allocated;
+
+	auto& event = mTraceEvents[mNumberOfTraceEvents % TRACED_EVENTS];
+	event.startNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(start - mEpoch).count();
+	event.durationNanoseconds = duration;
+	event.phase = phase;
+	++mNumberOfTraceEvents;
+}
+
+const LatencyHistogram& Profiler::histogram(ProfilePhase phase) const
+{
+	return mHistograms[static_cast<std::size_t>(phase)];
+}
+
+const AllocationCounters& Profiler::allocations(ProfilePhase phase) const
+{
+	return mAllocations[static_cast<std::size_t>(phase)];
+}
+
+void Profiler::reset()
+{
+	for (auto& histogram : mHistograms)
+	{
+		histogram.clear();
+	}
+	mAllocations.fill({});
+	mNumberOfTraceEvents = 0;
+}
+
+bool Profiler::exportChromeTrace(const std::string& path_to_trace) const
+{
+	std::ofstream trace(path_to_trace, std::ios::trunc);
+	if (!trace)
+	{
+		return false;
+	}
+
+	// Complete ("X") events, the timestamps are in microseconds
+	trace << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	const auto numberOfEvents = std::min(mNumberOfTraceEvents, TRACED_EVENTS);
+	const auto firstEvent = mNumberOfTraceEvents - numberOfEvents;
+	for (auto eventNumber = firstEvent; eventNumber < mNumberOfTraceEvents; ++eventNumber)
+	{
+		const auto& event = mTraceEvents[eventNumber % TRACED_EVENTS];
+		trace << (eventNumber == firstEvent ? "\n" : ",\n")
+		      << "{\"name\":\"" << nameOf(event.phase) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+		      << ",\"ts\":" << event.startNanoseconds / 1000 << '.' << event.startNanoseconds % 1000 / 100
+		      << ",\"dur\":" << event.durationNanoseconds / 1000 << '.' << event.durationNanoseconds % 1000 / 100 << '}';
+	}
+
+	// Histograms of the whole session, as the events cover only the most recent frames
+	trace << "\n],\"otherData\":{";
+	for (std::size_t phase = 0; phase < mHistograms.size(); ++phase)
+	{
+		const auto& histogram = mHistograms[phase];
+		trace << (phase == 0 ? "\n" : ",\n")
+		      << '"' << nameOf(static_cast<ProfilePhase>(phase)) << "\":\"count " << histogram.count()
+		      << ", p50 " << histogram.percentile(0.5f) << " ns, p99 " << histogram.percentile(0.99f)
+		      << " ns, max " << histogram.maximum() << " ns\"";
+	}
+	trace << "\n}}\n";
+	return static_cast<bool>(trace);
+}
+
+void Profiler::updateImGui()
+{
+	if (!ImGui::CollapsingHeader("Profiler"))
+	{
+		return;
+	}
+
+	constexpr auto tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+	constexpr auto numberOfColumns = AllocationTracker::isEnabled() ? 7 : 5;
+	if (ImGui::BeginTable("Phases", numberOfColumns, tableFlags))
+	{
+		ImGui::TableSetupColumn("Phase");
+		ImGui::TableSetupColumn("Count");
+		ImGui::TableSetupColumn("p50 [us]");
+		ImGui::TableSetupColumn("p99 [us]");
+		ImGui::TableSetupColumn("Max [us]");
+		if (AllocationTracker::isEnabled())
+		{
+			ImGui::TableSetupColumn("Allocs/call");
+			ImGui::TableSetupColumn("Bytes/call");
+		}
+		ImGui::TableHeadersRow();
+		for (std::size_t phase = 0; phase < mHistograms.size(); ++phase)
+		{
+			const auto& histogram = mHistograms[phase];
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(nameOf(static_cast<ProfilePhase>(phase)));
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(histogram.count()));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", histogram.percentile(0.5f) / 1000.f);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", histogram.percentile(0.99f) / 1000.f);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", histogram.maximum() / 1000.f);
+			if (AllocationTracker::isEnabled())
+			{
+				const auto& allocations = mAllocations[phase];
+				const auto calls = static_cast<float>(std::max<std::uint64_t>(histogram.count(), 1));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f", allocations.allocations / calls);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.0f", allocations.bytes / calls);
+			}
+		}
+		ImGui::EndTable();
+	}
+
+	if (AllocationTracker::isEnabled())
+	{
+		auto isStrict = AllocationTracker::isStrict();
+		if (ImGui::Checkbox("Assert zero-allocation ticks", &isStrict))
+		{
+			AllocationTracker::setStrict(isStrict);
+		}
+		ImGui::Text("Ticks that allocated: %llu", static_cast<unsigned long long>(AllocationTracker::violations()));
+	}
+
+	if (ImGui::Button("Reset"))
+	{
+		reset();
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export trace"))
+	{
+		mExportStatus = exportChromeTrace(TRACE_PATH) ? "Saved to " + TRACE_PATH : "Could not write " + TRACE_PATH;
+	}
+	if (!mExportStatus.empty())
+	{
+		ImGui::TextUnformatted(mExportStatus.c_str());
+	}
+}
+
+const char* Profiler::nameOf(ProfilePhase phase)
+{
+	switch (phase)
+	{
+		case ProfilePhase::Frame: return "Frame";
+		case ProfilePhase::ProcessEvents: return "ProcessEvents";
+		case ProfilePhase::Update: return "Update";
+		case ProfilePhase::UpdateWorld: return "UpdateWorld";
+		case ProfilePhase::UpdateBirds: return "UpdateBirds";
+		case ProfilePhase::UpdatePipes: return "UpdatePipes";
+		case ProfilePhase::UpdateANN: return "UpdateANN";
+		case ProfilePhase::HandleCollision: return "HandleCollision";
+		case ProfilePhase::Evolve: return "Evolve";
+		case ProfilePhase::UpdateImGui: return "UpdateImGui";
+		case ProfilePhase::Render: return "Render";
+		case ProfilePhase::Count: break;
+	}
+	return "Unknown";
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "AllocationTracker.h"
+
+/**
+ * \brief Parts of the frame whose duration is measured by the profiler
+ */
+enum class ProfilePhase : std::uint8_t
+{
+	Frame,
+	ProcessEvents,
+	Update,
+	UpdateWorld,
+	UpdateBirds,
+	UpdatePipes,
+	UpdateANN,
+	HandleCollision,
+	Evolve,
+	UpdateImGui,
+	Render,
+
+	Count
+};
+
+/**
+ * \brief Distribution of the durations, kept in logarithmic buckets.
+ *
+ * Every power of two is split into four buckets, so any percentile is known
+ * with the error below 25%, and adding a duration costs only a few instructions.
+ */
+class LatencyHistogram
+{
+public:
+	/**
+	 * \brief Adds the next measured duration
+	 * \param nanoseconds Measured duration
+	 */
+	void add(std::uint64_t nanoseconds);
+
+	/**
+	 * \brief Returns the duration below which the given part of all the measurements lie
+	 * \param percentile Value from 0 to 1, for example 0.99 for the p99
+	 * \return Approximated duration in nanoseconds, or zero if nothing was measured
+	 */
+	std::uint64_t percentile(float percentile) const;
+
+	/**
+	 * \brief Returns the number of measured durations
+	 * \return Number of measurements
+	 */
+	std::uint64_t count() const;
+
+	/**
+	 * \brief Returns the longest measured duration
+	 * \return Duration in nanoseconds
+	 */
+	std::uint64_t maximum() const;
+
+	/**
+	 * \brief Returns the average of the measured durations
+	 * \return Duration in nanoseconds, or zero if nothing was measured
+	 */
+	std::uint64_t mean() const;
+
+	/**
+	 * \brief Forgets all the measured durations
+	 */
+	void clear();
+
+private:
+	/**
+	 * \brief Returns the bucket to which the duration belongs
+	 * \param nanoseconds Measured duration
+	 * \return Index of the bucket
+	 */
+	static std::size_t bucketOf(std::uint64_t nanoseconds);
+
+	/**
+	 * \brief Returns the shortest duration belonging to the bucket
+	 * \param bucket Index of the bucket
+	 * \return Duration in nanoseconds
+	 */
+	static std::uint64_t lowerBoundOf(std::size_t bucket);
+
+private:
+	/** Number of buckets every power of two is split into */
+	static constexpr std::size_t BUCKETS_PER_POWER = 4;
+
+	/** Number of measurements in each of the buckets */
+	std::array<std::uint32_t, 64 * BUCKETS_PER_POWER> mBuckets{};
+
+	std::uint64_t mCount = 0;
+	std::uint64_t mTotal = 0;
+	std::uint64_t mMaximum = 0;
+};
+
+/**
+ * \brief Collects the durations of the phases of every frame.
+ *
+ * The phases are measured by the scopes created with PROFILE_SCOPE. They exist only when
+ * the game is built with FLAPANN_PROFILING defined (premake5 --profiling), otherwise the
+ * macro expands to nothing and the profiler costs nothing at all.
+ *
+ * Besides the histograms, the most recent measurements are kept in a ring, so they can be
+ * saved as the trace, which can be opened in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * The profiler is meant to be used only by the main thread.
+ */
+class Profiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * \brief Returns the profiler shared by the whole game
+	 * \return The only instance of the profiler
+	 */
+	static Profiler& instance();
+
+	/**
+	 * \brief Checks if the game was built with the profiling enabled
+	 * \return True if the phases are measured, false otherwise
+	 */
+	static constexpr bool isEnabled();
+
+	/**
+	 * \brief Records the single measurement of the phase
+	 * \param phase Measured phase
+	 * \param start Time at which the phase started
+	 * \param end Time at which the phase ended
+	 * \param allocated Heap allocations made during the phase
+	 */
+	void record(ProfilePhase phase, Clock::time_point start, Clock::time_point end, const AllocationCounters& allocated);
+
+	/**
+	 * \brief Returns the durations measured for the phase
+	 * \param phase Measured phase
+	 * \return Histogram of the durations
+	 */
+	const LatencyHistogram& histogram(ProfilePhase phase) const;
+
+	/**
+	 * \brief Returns the heap allocations made during all the measurements of the phase
+	 * \param phase Measured phase
+	 * \return Allocations counted only if the allocation tracking is enabled
+	 */
+	const AllocationCounters& allocations(ProfilePhase phase) const;
+
+	/**
+	 * \brief Forgets all the measurements
+	 */
+	void reset();
+
+	/**
+	 * \brief Saves the most recent measurements as the Chrome trace_event JSON file
+	 * \param path_to_trace Path of the file to write
+	 * \return True if the file was written, false otherwise
+	 */
+	bool exportChromeTrace(const std::string& path_to_trace) const;
+
+	/**
+	 * \brief Updates the ImGui panel showing the histograms of the phases. Only shown when the profiling is enabled.
+	 */
+	void updateImGui();
+
+	/**
+	 * \brief Returns the name of the phase
+	 * \param phase Phase of the frame
+	 * \return Name used in the panel and in the trace
+	 */
+	static const char* nameOf(ProfilePhase phase);
+
+private:
+	Profiler();
+
+	/**
+	 * \brief Single measurement of the phase kept for the trace
+	 */
+	struct TraceEvent
+	{
+		std::int64_t startNanoseconds;
+		std::int64_t durationNanoseconds;
+		ProfilePhase phase;
+	};
+
+private:
+	/** Number of the most recent measurements kept for the trace */
+	static constexpr std::size_t TRACED_EVENTS = 1 << 15;
+
+	/** File to which the trace is saved from the panel */
+	static const std::string TRACE_PATH;
+
+	/** Time from which the trace is counted */
+	Clock::time_point mEpoch;
+
+	/** Durations of every phase, indexed by the phase */
+	std::array<LatencyHistogram, static_cast<std::size_t>(ProfilePhase::Count)> mHistograms;
+
+	/** Heap allocations made during every phase, indexed by the phase */
+	std::array<AllocationCounters, static_cast<std::size_t>(ProfilePhase::Count)> mAllocations;
+
+	/** The most recent measurements, overwritten once the ring is full */
+	std::array<TraceEvent, TRACED_EVENTS> mTraceEvents;
+
+	/** Number of measurements ever put into the ring */
+	std::size_t mNumberOfTraceEvents;
+
+	/** Outcome of the last export, shown in the panel */
+	std::string mExportStatus;
+};
+
+/**
+ * \brief Measures the time from its creation to its destruction as the phase
+ */
+class ProfileScope
+{
+public:
+	/**
+	 * \brief Starts measuring the phase
+	 * \param phase Measured phase
+	 */
+	explicit ProfileScope(ProfilePhase phase);
+
+	/**
+	 * \brief Records the measured phase
+	 */
+	~ProfileScope();
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	/** Taken before the start of the phase, so the profiler always exists before anything it measures */
+	Profiler& mProfiler;
+	ProfilePhase mPhase;
+	Profiler::Clock::time_point mStart;
+	AllocationCounters mAllocationsAtStart;
+};
+
+#define FLAPANN_PROFILE_CONCAT_IMPL(a, b) a##b
+#define FLAPANN_PROFILE_CONCAT(a, b) FLAPANN_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef FLAPANN_PROFILING
+	/** Measures the rest of the enclosing scope as the given ProfilePhase */
+	#define PROFILE_SCOPE(phase) const ProfileScope FLAPANN_PROFILE_CONCAT(profileScope, __LINE__)(ProfilePhase::phase)
+#else
+	#define PROFILE_SCOPE(phase) ((void)0)
+#endif
+
+
+// ---------- Inline ------------ //
+
+constexpr bool Profiler::isEnabled()
+{
+#ifdef FLAPANN_PROFILING
+	return true;
+#else
+	return false;
+#endif
+}
+
+inline ProfileScope::ProfileScope(ProfilePhase phase) :
+	mProfiler(Profiler::instance()),
+	mPhase(phase),
+	mStart(Profiler::Clock::now()),
+	mAllocationsAtStart(AllocationTracker::counters())
+{
+}
+
+inline ProfileScope::~ProfileScope()
+{
+	mProfiler.record(mPhase, mStart, Profiler::Clock::now(), AllocationTracker::counters() - mAllocationsAtStart);
+}
@@ -0,0 +1,337 @@
+#include "pch.h"
+#include "RewindBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace
+{
+	std::uint32_t floatBits(float value)
+	{
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float bitsFloat(std::uint32_t bits)
+	{
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	void writeVarint(std::vector<std::uint8_t>& bytes, std::uint32_t value)
+	{
+		// Seven bits per byte, the highest bit tells if there is another byte
+		while (value >= 0x80)
+		{
+			bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+		bytes.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	std::uint32_t readVarint(const std::uint8_t*& cursor)
+	{
+		std::uint32_t value = 0;
+		for (auto shift = 0; ; shift += 7)
+		{
+			const auto byte = *cursor++;
+			value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+	}
+
+	/**
+	 * \brief Maps the signed remainder to the unsigned one, so small remainders of both signs stay small
+	 */
+	std::uint32_t zigzag(std::uint32_t remainder)
+	{
+		const auto signedRemainder = static_cast<std::int32_t>(remainder);
+		return (remainder << 1) ^ static_cast<std::uint32_t>(signedRemainder >> 31);
+	}
+
+	std::uint32_t unzigzag(std::uint32_t value)
+	{
+		return (value >> 1) ^ (0u - (value & 1u));
+	}
+
+	/** Columns of the birds state that are encoded, in the order they are written */
+	constexpr std::vector<float> BirdsState::* FLOAT_COLUMNS[] = {
+		&BirdsState::positionX, &BirdsState::positionY,
+		&BirdsState::velocityX, &BirdsState::velocityY,
+		&BirdsState::rotation, &BirdsState::score
+	};
+
+	/**
+	 * \brief Predicts the value of the bird from the previous keyframes. The decoder gets the very
+	 * same bits, as it calculates the prediction from the same decoded values in the same way.
+	 */
+	float predictedValue(std::vector<float> BirdsState::* column, std::size_t index,
+	                     const BirdsState& previous, const BirdsState* beforePrevious)
+	{
+		const auto last = (previous.*column)[index];
+		return beforePrevious ? last + (last - (beforePrevious->*column)[index]) : last;
+	}
+}
+
+void BirdsState::push(const Birds::State& state)
+{
+	positionX.push_back(state.position.x);
+	positionY.push_back(state.position.y);
+	velocityX.push_back(state.velocity.x);
+	velocityY.push_back(state.velocity.y);
+	rotation.push_back(state.rotation);
+	score.push_back(state.score);
+	isDead.push_back(state.isDead);
+}
+
+Birds::State BirdsState::at(std::size_t index) const
+{
+	return { { positionX[index], positionY[index] }, { velocityX[index], velocityY[index] },
+	         rotation[index], score[index], isDead[index] != 0 };
+}
+
+std::size_t BirdsState::size() const
+{
+	return positionX.size();
+}
+
+RewindBuffer::RewindBuffer(std::size_t memoryBudget, std::uint32_t ticksPerKeyframe, std::size_t keyframesPerGroup) :
+	mMemoryBudget(memoryBudget),
+	mTicksPerKeyframe(ticksPerKeyframe),
+	mKeyframesPerGroup(keyframesPerGroup),
+	mMemoryUsage(0),
+	mRawBirdBytes(0),
+	mEncodedBirdBytes(0)
+{
+	assert(ticksPerKeyframe > 0 && keyframesPerGroup > 0);
+}
+
+bool RewindBuffer::isKeyframeDue(std::uint32_t tick, const sf::Time& deltaTime) const
+{
+	return mKeyframes.empty() || mKeyframes.back().deltaTime != deltaTime ||
+	       tick >= mKeyframes.back().tick + mTicksPerKeyframe;
+}
+
+void RewindBuffer::storeKeyframe(const WorldState& state)
+{
+	assert(mKeyframes.empty() || mKeyframes.back().tick < state.tick);
+
+	// A new group is started when the previous one is complete, or when the number of birds changed
+	std::size_t keyframesInGroup = 0;
+	for (auto keyframe = mKeyframes.crbegin(); keyframe != mKeyframes.crend(); ++keyframe)
+	{
+		++keyframesInGroup;
+		if (keyframe->isFull)
+			break;
+	}
+	const auto isFull = mKeyframes.empty() || keyframesInGroup >= mKeyframesPerGroup ||
+	                    mNewestBirds.size() != state.birds.size();
+
+	const auto* beforePrevious = !isFull && mSecondNewestBirds ? &*mSecondNewestBirds : nullptr;
+	Keyframe keyframe{ state.tick, state.deltaTime, static_cast<std::uint32_t>(state.birds.size()),
+	                   encode(state.birds, isFull ? nullptr : &mNewestBirds, beforePrevious),
+	                   state.pipes, state.backgroundPosition, state.groundPosition, isFull };
+	mMemoryUsage += memoryUsage(keyframe);
+	countBirdBytes(keyframe, 1);
+	mKeyframes.push_back(std::move(keyframe));
+	mSecondNewestBirds = isFull ? std::nullopt : std::optional<BirdsState>(std::move(mNewestBirds));
+	mNewestBirds = state.birds;
+
+	dropOldestGroups();
+}
+
+std::optional<WorldState> RewindBuffer::keyframeBefore(std::uint32_t tick) const
+{
+	auto foundKeyframe = std::upper_bound(mKeyframes.cbegin(), mKeyframes.cend(), tick,
+		[](std::uint32_t tick, const Keyframe& keyframe) { return tick < keyframe.tick; });
+	if (foundKeyframe == mKeyframes.cbegin())
+		return std::nullopt;
+
+	return decodeKeyframe(std::distance(mKeyframes.cbegin(), foundKeyframe) - 1);
+}
+
+void RewindBuffer::discardAfter(std::uint32_t tick)
+{
+	while (!mKeyframes.empty() && mKeyframes.back().tick > tick)
+	{
+		mMemoryUsage -= memoryUsage(mKeyframes.back());
+		countBirdBytes(mKeyframes.back(), -1);
+		mKeyframes.pop_back();
+	}
+
+	if (mKeyframes.empty())
+	{
+		mNewestBirds = BirdsState();
+		mSecondNewestBirds.reset();
+		return;
+	}
+	std::tie(mNewestBirds, mSecondNewestBirds) = decodeBirds(mKeyframes.size() - 1);
+}
+
+void RewindBuffer::clear()
+{
+	mKeyframes.clear();
+	mNewestBirds = BirdsState();
+	mSecondNewestBirds.reset();
+	mMemoryUsage = 0;
+	mRawBirdBytes = 0;
+	mEncodedBirdBytes = 0;
+}
+
+bool RewindBuffer::empty() const
+{
+	return mKeyframes.empty();
+}
+
+std::uint32_t RewindBuffer::oldestTick() const
+{
+	assert(!mKeyframes.empty());
+	return mKeyframes.front().tick;
+}
+
+std::size_t RewindBuffer::memoryUsage() const
+{
+	return mMemoryUsage;
+}
+
+float RewindBuffer::compressionRatio() const
+{
+	return mEncodedBirdBytes == 0 ? 1.f : static_cast<float>(mRawBirdBytes) / static_cast<float>(mEncodedBirdBytes);
+}
+
+std::vector<std::uint8_t> RewindBuffer::encode(const BirdsState& birds, const BirdsState* previous, const BirdsState* beforePrevious)
+{
+	std::vector<std::uint8_t> bytes;
+	bytes.reserve(birds.size() * (previous ? 8 : sizeof(float) * std::size(FLOAT_COLUMNS)) + birds.size() / 8 + 1);
+
+	for (const auto column : FLOAT_COLUMNS)
+	{
+		const auto& values = birds.*column;
+		for (std::size_t index = 0; index < values.size(); ++index)
+		{
+			if (!previous)
+			{
+				const auto bits = floatBits(values[index]);
+				const auto* valueBytes = reinterpret_cast<const std::uint8_t*>(&bits);
+				bytes.insert(bytes.end(), valueBytes, valueBytes + sizeof(bits));
+				continue;
+			}
+
+			// Floats of the same sign are ordered like their bits, so a good prediction leaves
+			// a small remainder, and the values that did not change leave zero
+			const auto prediction = predictedValue(column, index, *previous, beforePrevious);
+			writeVarint(bytes, zigzag(floatBits(values[index]) - floatBits(prediction)));
+		}
+	}
+
+	// Flags are packed by eight, they barely take any space anyway
+	for (std::size_t index = 0; index < birds.isDead.size(); index += 8)
+	{
+		std::uint8_t packed = 0;
+		for (std::size_t bit = 0; bit < 8 && index + bit < birds.isDead.size(); ++bit)
+			packed |= static_cast<std::uint8_t>((birds.isDead[index + bit] != 0) << bit);
+		bytes.push_back(packed);
+	}
+	return bytes;
+}
+
+BirdsState RewindBuffer::decode(const Keyframe& keyframe, const BirdsState* previous, const BirdsState* beforePrevious)
+{
+	const auto numberOfBirds = keyframe.numberOfBirds;
+	const auto* cursor = keyframe.birds.data();
+
+	BirdsState birds;
+	for (const auto column : FLOAT_COLUMNS)
+	{
+		auto& values = birds.*column;
+		values.resize(numberOfBirds);
+		for (std::size_t index = 0; index < numberOfBirds; ++index)
+		{
+			if (!previous)
+			{
+				std::uint32_t bits;
+				std::memcpy(&bits, cursor, sizeof(bits));
+				cursor += sizeof(bits);
+				values[index] = bitsFloat(bits);
+				continue;
+			}
+
+			const auto prediction = predictedValue(column, index, *previous, beforePrevious);
+			values[index] = bitsFloat(floatBits(prediction) + unzigzag(readVarint(cursor)));
+		}
+	}
+
+	birds.isDead.resize(numberOfBirds);
+	for (std::size_t index = 0; index < numberOfBirds; ++index)
+		birds.isDead[index] = (cursor[index / 8] >> (index % 8)) & 1u;
+	return birds;
+}
+
+std::pair<BirdsState, std::optional<BirdsState>> RewindBuffer::decodeBirds(std::size_t index) const
+{
+	// The birds are decoded starting from the full keyframe of the group
+	auto groupStart = index;
+	while (!mKeyframes[groupStart].isFull)
+		--groupStart;
+
+	auto birds = decode(mKeyframes[groupStart], nullptr, nullptr);
+	std::optional<BirdsState> previousBirds;
+	for (auto deltaIndex = groupStart + 1; deltaIndex <= index; ++deltaIndex)
+	{
+		auto nextBirds = decode(mKeyframes[deltaIndex], &birds, previousBirds ? &*previousBirds : nullptr);
+		previousBirds = std::move(birds);
+		birds = std::move(nextBirds);
+	}
+	return { std::move(birds), std::move(previousBirds) };
+}
+
+WorldState RewindBuffer::decodeKeyframe(std::size_t index) const
+{
+	const auto& keyframe = mKeyframes[index];
+	return { keyframe.tick, keyframe.deltaTime, decodeBirds(index).first,
+	         keyframe.pipes, keyframe.backgroundPosition, keyframe.groundPosition };
+}
+
+void RewindBuffer::dropOldestGroups()
+{
+	// The newest group is always kept, even if it alone exceeds the budget
+	while (mMemoryUsage > mMemoryBudget)
+	{
+		auto groupEnd = std::find_if(std::next(mKeyframes.cbegin()), mKeyframes.cend(),
+			[](const Keyframe& keyframe) { return keyframe.isFull; });
+		if (groupEnd == mKeyframes.cend())
+			return;
+
+		for (auto keyframe = mKeyframes.cbegin(); keyframe != groupEnd; ++keyframe)
+		{
+			mMemoryUsage -= memoryUsage(*keyframe);
+			countBirdBytes(*keyframe, -1);
+		}
+		mKeyframes.erase(mKeyframes.cbegin(), groupEnd);
+	}
+}
+
+std::size_t RewindBuffer::memoryUsage(const Keyframe& keyframe)
+{
+	return sizeof(Keyframe) + keyframe.birds.capacity() +
+	       keyframe.pipes.pipeSets.capacity() * sizeof(PipesGenerator::PlacedPipeSet);
+}
+
+void RewindBuffer::countBirdBytes(const Keyframe& keyframe, int sign)
+{
+	const auto rawBytes = keyframe.numberOfBirds * sizeof(float) * std::size(FLOAT_COLUMNS) + (keyframe.numberOfBirds + 7) / 8;
+	if (sign > 0)
+	{
+		mRawBirdBytes += rawBytes;
+		mEncodedBirdBytes += keyframe.birds.size();
+	}
+	else
+	{
+		mRawBirdBytes -= rawBytes;
+		mEncodedBirdBytes -= keyframe.birds.size();
+	}
+}
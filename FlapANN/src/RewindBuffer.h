@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <utility>
+
+#include "nodes/objects/bird/Birds.h"
+#include "nodes/objects/pipe/PipesGenerator.h"
+
+/**
+ * \brief State of all the birds, with each of their fields kept in a separate array
+ */
+struct BirdsState
+{
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> rotation;
+	std::vector<float> score;
+	std::vector<std::uint8_t> isDead;
+
+	/**
+	 * \brief Appends the state of the next bird
+	 * \param state State of the bird
+	 */
+	void push(const Birds::State& state);
+
+	/**
+	 * \brief Returns the state of the bird
+	 * \param index Index of the bird
+	 * \return State of the bird with the given index
+	 */
+	Birds::State at(std::size_t index) const;
+
+	/**
+	 * \brief Returns the number of birds
+	 * \return Number of birds
+	 */
+	std::size_t size() const;
+};
+
+/**
+ * \brief Everything needed to continue the game from the given tick
+ */
+struct WorldState
+{
+	/** Number of ticks that have passed since the generation started */
+	std::uint32_t tick;
+
+	/** Length of the ticks that follow the state */
+	sf::Time deltaTime;
+
+	/** State of all the birds */
+	BirdsState birds;
+
+	/** State of the pipes generator */
+	PipesGenerator::State pipes;
+
+	/** Position of the scrolled background */
+	sf::Vector2f backgroundPosition;
+
+	/** Position of the scrolled ground */
+	sf::Vector2f groundPosition;
+};
+
+/**
+ * \brief Keeps the recent states of the world, so the game can be rewound to any of the recent ticks.
+ *
+ * Not every tick is stored, only the keyframes taken every few ticks. Any other tick is reached
+ * by restoring the nearest keyframe before it and simulating the game forward, which gives exactly
+ * the same result, as the game is deterministic.
+ *
+ * Keyframes are grouped. The first keyframe of the group stores the birds as they are, and each
+ * following one stores only how far every value is from its prediction. The prediction continues
+ * the change between the two previous keyframes of the group (or repeats the previous value for the
+ * second keyframe), as the birds keep moving at nearly the same speed. The bits of the value and
+ * of the prediction are subtracted as integers and the remainder is written as a variable length
+ * number. The floats keep their order as integers, so close values leave small remainders. Nothing
+ * is quantized, as the rewound game has to continue exactly as it did. Once the memory budget is
+ * exceeded, the oldest group is dropped as a whole, so the memory used by the buffer stays bounded.
+ *
+ *   group:  [ full | delta | delta | delta ] [ full | delta | ...
+ */
+class RewindBuffer
+{
+public:
+	/**
+	 * \brief Creates an empty buffer
+	 * \param memoryBudget Number of bytes the keyframes may take
+	 * \param ticksPerKeyframe Number of ticks between successive keyframes
+	 * \param keyframesPerGroup Number of keyframes in each group (including the full one)
+	 */
+	RewindBuffer(std::size_t memoryBudget, std::uint32_t ticksPerKeyframe, std::size_t keyframesPerGroup);
+
+	/**
+	 * \brief Checks if the state of the given tick should be stored
+	 * \param tick Number of ticks that have passed since the generation started
+	 * \param deltaTime Length of the following tick
+	 * \return True if the keyframe should be stored, false otherwise
+	 *
+	 * The keyframe is due also when the length of the tick changes, so
+	 * all the ticks between two keyframes have always the same length.
+	 */
+	bool isKeyframeDue(std::uint32_t tick, const sf::Time& deltaTime) const;
+
+	/**
+	 * \brief Stores the state of the world
+	 * \param state State of the world, newer than all the stored ones
+	 */
+	void storeKeyframe(const WorldState& state);
+
+	/**
+	 * \brief Returns the newest keyframe that is not newer than the given tick
+	 * \param tick Tick to which the game should be rewound
+	 * \return State of the world, or nothing if there is no such keyframe
+	 */
+	std::optional<WorldState> keyframeBefore(std::uint32_t tick) const;
+
+	/**
+	 * \brief Removes all keyframes newer than the given tick
+	 * \param tick The last tick that should stay in the buffer
+	 */
+	void discardAfter(std::uint32_t tick);
+
+	/**
+	 * \brief Removes all the keyframes
+	 */
+	void clear();
+
+	/**
+	 * \brief Checks if there are no keyframes
+	 * \return True if there are no keyframes, false otherwise
+	 */
+	bool empty() const;
+
+	/**
+	 * \brief Returns the oldest tick to which the game can be rewound
+	 * \return Tick of the oldest keyframe
+	 */
+	std::uint32_t oldestTick() const;
+
+	/**
+	 * \brief Returns the number of bytes taken by the keyframes
+	 * \return Memory used by the keyframes
+	 */
+	std::size_t memoryUsage() const;
+
+	/**
+	 * \brief Returns how many times smaller the encoded birds are than the birds stored as they are
+	 * \return Size of the birds stored as they are divided by their encoded size, or 1 if there are no keyframes
+	 */
+	float compressionRatio() const;
+
+private:
+	/**
+	 * \brief Stored state of the world
+	 */
+	struct Keyframe
+	{
+		std::uint32_t tick;
+		sf::Time deltaTime;
+		std::uint32_t numberOfBirds;
+
+		/** Birds encoded as they are, or as the difference to the previous keyframe */
+		std::vector<std::uint8_t> birds;
+
+		/** Pipes take very little space, so they are always stored as they are */
+		PipesGenerator::State pipes;
+		sf::Vector2f backgroundPosition;
+		sf::Vector2f groundPosition;
+
+		/** Flag determining if the keyframe starts a group */
+		bool isFull;
+	};
+
+	/**
+	 * \brief Encodes the birds
+	 * \param birds State of the birds to encode
+	 * \param previous State of the birds in the previous keyframe, nullptr for the full keyframe
+	 * \param beforePrevious State of the birds in the keyframe before the previous one, nullptr if it is not in the group
+	 * \return Encoded birds
+	 */
+	static std::vector<std::uint8_t> encode(const BirdsState& birds, const BirdsState* previous, const BirdsState* beforePrevious);
+
+	/**
+	 * \brief Decodes the birds
+	 * \param keyframe Keyframe to decode
+	 * \param previous State of the birds in the previous keyframe, nullptr for the full keyframe
+	 * \param beforePrevious State of the birds in the keyframe before the previous one, nullptr if it is not in the group
+	 * \return Decoded birds
+	 */
+	static BirdsState decode(const Keyframe& keyframe, const BirdsState* previous, const BirdsState* beforePrevious);
+
+	/**
+	 * \brief Decodes the birds of the keyframe and of the one before it, if it belongs to the same group
+	 * \param index Index of the keyframe
+	 * \return Birds of the keyframe, followed by the birds of the one before it
+	 */
+	std::pair<BirdsState, std::optional<BirdsState>> decodeBirds(std::size_t index) const;
+
+	/**
+	 * \brief Decodes the whole state stored in the keyframe
+	 * \param index Index of the keyframe
+	 * \return State of the world
+	 */
+	WorldState decodeKeyframe(std::size_t index) const;
+
+	/**
+	 * \brief Drops the oldest groups until the memory budget is kept
+	 */
+	void dropOldestGroups();
+
+	/**
+	 * \brief Returns the memory taken by the single keyframe
+	 * \param keyframe Keyframe to measure
+	 * \return Number of bytes taken by the keyframe
+	 */
+	static std::size_t memoryUsage(const Keyframe& keyframe);
+
+	/**
+	 * \brief Adds the sizes of the birds of the keyframe to the totals, or subtracts them
+	 * \param keyframe Keyframe that is stored or removed
+	 * \param sign One if the keyframe is stored, minus one if it is removed
+	 */
+	void countBirdBytes(const Keyframe& keyframe, int sign);
+
+private:
+	/** Number of bytes the keyframes may take */
+	std::size_t mMemoryBudget;
+
+	/** Number of ticks between successive keyframes */
+	std::uint32_t mTicksPerKeyframe;
+
+	/** Number of keyframes in each group (including the full one) */
+	std::size_t mKeyframesPerGroup;
+
+	/** Stored keyframes ordered by their tick */
+	std::deque<Keyframe> mKeyframes;
+
+	/** Birds of the newest keyframe, from which the difference of the next one is calculated */
+	BirdsState mNewestBirds;
+
+	/** Birds of the keyframe before the newest one, if both are in the same group */
+	std::optional<BirdsState> mSecondNewestBirds;
+
+	/** Number of bytes taken by the keyframes */
+	std::size_t mMemoryUsage;
+
+	/** Size of the birds of all the keyframes stored as they are, and encoded */
+	std::size_t mRawBirdBytes;
+	std::size_t mEncodedBirdBytes;
+};
@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "SparseNetwork.h"
+
+#include <cmath>
+
+#include "Optimizer.h"
+
+SparseNetwork::SparseNetwork(const fann* ann, fann_type pruningThreshold) :
+	mFirstInput(0),
+	mFirstOutput(0),
+	mNumberOfInputs(ann->num_input),
+	mNumberOfOutputs(ann->num_output),
+	mNumberOfDenseConnections(ann->total_connections)
+{
+	const auto neurons = Optimizer::neuronsOf(ann);
+	const fann_neuron* firstNeuron = neurons.first;
+	const fann_neuron* lastNeuron = neurons.second;
+	const auto indexOf = [firstNeuron](const fann_neuron* neuron) { return static_cast<std::uint32_t>(neuron - firstNeuron); };
+	mValues.assign(static_cast<std::size_t>(lastNeuron - firstNeuron), 0);
+	mFirstOutput = indexOf((ann->last_layer - 1)->first_neuron);
+
+	// Only the neurons the outputs depend on through the kept connections are alive,
+	// so the layers are walked from the output one back to the first hidden one
+	auto isKept = [pruningThreshold](fann_type weight) { return std::abs(weight) >= pruningThreshold; };
+	std::vector<bool> isAlive(mValues.size(), false);
+	for (auto output = 0u; output < mNumberOfOutputs; ++output)
+	{
+		isAlive[mFirstOutput + output] = true;
+	}
+	for (auto* layer = ann->last_layer - 1; layer != ann->first_layer; --layer)
+	{
+		for (auto* neuron = layer->first_neuron; neuron != layer->last_neuron; ++neuron)
+		{
+			if (!isAlive[indexOf(neuron)])
+			{
+				continue;
+			}
+			for (auto connection = neuron->first_con; connection != neuron->last_con; ++connection)
+			{
+				if (isKept(ann->weights[connection]))
+				{
+					isAlive[indexOf(ann->connections[connection])] = true;
+				}
+			}
+		}
+	}
+
+	for (auto* layer = ann->first_layer; layer != ann->last_layer; ++layer)
+	{
+		for (auto* neuron = layer->first_neuron; neuron != layer->last_neuron; ++neuron)
+		{
+			// Neurons without any connections are the bias ones, except for the inputs
+			const auto isInput = layer == ann->first_layer && neuron != layer->last_neuron - 1;
+			if (neuron->first_con == neuron->last_con)
+			{
+				mValues[indexOf(neuron)] = isInput ? 0 : 1;
+				continue;
+			}
+			if (!isAlive[indexOf(neuron)])
+			{
+				continue;
+			}
+
+			const auto firstConnection = static_cast<std::uint32_t>(mWeights.size());
+			for (auto connection = neuron->first_con; connection != neuron->last_con; ++connection)
+			{
+				if (isKept(ann->weights[connection]))
+				{
+					mSources.push_back(indexOf(ann->connections[connection]));
+					mWeights.push_back(ann->weights[connection]);
+				}
+			}
+			mComputedNeurons.push_back({ indexOf(neuron), firstConnection, static_cast<std::uint32_t>(mWeights.size()),
+			                             neuron->activation_steepness, neuron->activation_function });
+		}
+	}
+}
+
+const fann_type* SparseNetwork::run(const fann_type* input)
+{
+	std::copy_n(input, mNumberOfInputs, mValues.begin() + mFirstInput);
+
+	for (const auto& neuron : mComputedNeurons)
+	{
+		const auto* weights = mWeights.data() + neuron.firstConnection;
+		const auto* sources = mSources.data() + neuron.firstConnection;
+		const auto numberOfConnections = neuron.lastConnection - neuron.firstConnection;
+
+		// The same order as in fann_run: the remainder of the connections from the last one of them
+		// back, then the rest in groups of four, so the rounding is the same as well
+		fann_type sum = 0;
+		const auto remainder = numberOfConnections & 3;
+		if (remainder == 3)
+		{
+			sum += weights[2] * mValues[sources[2]];
+		}
+		if (remainder >= 2)
+		{
+			sum += weights[1] * mValues[sources[1]];
+		}
+		if (remainder >= 1)
+		{
+			sum += weights[0] * mValues[sources[0]];
+		}
+		for (auto connection = remainder; connection != numberOfConnections; connection += 4)
+		{
+			sum += weights[connection] * mValues[sources[connection]] + weights[connection + 1] * mValues[sources[connection + 1]]
+			     + weights[connection + 2] * mValues[sources[connection + 2]] + weights[connection + 3] * mValues[sources[connection + 3]];
+		}
+
+		// The same limit as in fann_run, which keeps the exponential functions from overflowing
+		sum *= neuron.steepness;
+		const auto maximumSum = 150 / neuron.steepness;
+		if (sum > maximumSum)
+		{
+			sum = maximumSum;
+		}
+		else if (sum < -maximumSum)
+		{
+			sum = -maximumSum;
+		}
+
+		auto& value = mValues[neuron.neuron];
+		fann_activation_switch(neuron.activationFunction, sum, value);
+	}
+	return mValues.data() + mFirstOutput;
+}
+
+std::size_t SparseNetwork::numberOfConnections() const
+{
+	return mWeights.size();
+}
+
+std::size_t SparseNetwork::numberOfDenseConnections() const
+{
+	return mNumberOfDenseConnections;
+}
+
+std::size_t SparseNetwork::numberOfComputedNeurons() const
+{
+	return mComputedNeurons.size();
+}
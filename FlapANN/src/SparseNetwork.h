@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include "fann/fann.h"
+
+/**
+ * \brief Copy of a FANN network without its near-zero weights, run by a sparse forward kernel.
+ *
+ * Every computed neuron keeps only the list of the connections whose weights were not pruned.
+ * Neurons left without any connection to the neurons that are computed later are not computed
+ * at all, as nothing depends on them. Everything else follows fann_run exactly: the order in
+ * which the connections are summed, the steepness, the limit of the sum and the activation
+ * functions, so with nothing pruned the outputs match the ones of the dense network.
+ */
+class SparseNetwork
+{
+public:
+	/**
+	 * \brief Copies the network, dropping the connections with small weights
+	 * \param ann Network to copy
+	 * \param pruningThreshold Connections whose absolute weight is smaller are dropped
+	 */
+	SparseNetwork(const fann* ann, fann_type pruningThreshold);
+
+	/**
+	 * \brief Runs the network. Just like fann_run, it writes into the network, so a single
+	 * network may be run only by a single thread at a time.
+	 *
+	 * \param input Values of the input neurons
+	 * \return Values of the output neurons, valid until the next run
+	 */
+	const fann_type* run(const fann_type* input);
+
+	/**
+	 * \brief Returns the number of the connections left
+	 * \return Number of the connections of the computed neurons
+	 */
+	std::size_t numberOfConnections() const;
+
+	/**
+	 * \brief Returns the number of the connections of the dense network
+	 * \return Number of the connections before pruning
+	 */
+	std::size_t numberOfDenseConnections() const;
+
+	/**
+	 * \brief Returns the number of the computed neurons
+	 * \return Number of the hidden and the output neurons that are computed
+	 */
+	std::size_t numberOfComputedNeurons() const;
+
+private:
+	/**
+	 * \brief Neuron that is computed, with its connections lying in the common arrays
+	 */
+	struct ComputedNeuron
+	{
+		std::uint32_t neuron;
+		std::uint32_t firstConnection;
+		std::uint32_t lastConnection;
+		fann_type steepness;
+		fann_activationfunc_enum activationFunction;
+	};
+
+private:
+	/** Computed neurons in the order of the layers */
+	std::vector<ComputedNeuron> mComputedNeurons;
+
+	/** Index of the source neuron of every kept connection */
+	std::vector<std::uint32_t> mSources;
+
+	/** Weight of every kept connection */
+	std::vector<fann_type> mWeights;
+
+	/** Value of every neuron. The bias neurons always hold one. */
+	std::vector<fann_type> mValues;
+
+	/** Index of the first input neuron and of the first output neuron */
+	std::uint32_t mFirstInput;
+	std::uint32_t mFirstOutput;
+
+	/** Number of the input and of the output neurons */
+	std::uint32_t mNumberOfInputs;
+	std::uint32_t mNumberOfOutputs;
+
+	/** Number of the connections of the dense network */
+	std::size_t mNumberOfDenseConnections;
+};
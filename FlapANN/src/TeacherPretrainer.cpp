@@ -0,0 +1,201 @@
+#include "pch.h"
+#include "TeacherPretrainer.h"
+
+#include <numeric>
+#include <thread>
+
+#include <imgui/imgui.h>
+
+#include "fann/parallel_fann.h"
+
+namespace
+{
+	/** The teacher flies courses far from the ones the population is scored on */
+	constexpr std::uint32_t TEACHER_SEED_OFFSET = 1000;
+
+	/**
+	 * \brief Decisions of the teacher recorded on a single course
+	 */
+	struct Samples
+	{
+		std::vector<fann_type> inputs;
+		std::vector<fann_type> outputs;
+		float teacherFitness = 0.f;
+	};
+}
+
+TeacherPretrainer::TeacherPretrainer() :
+	mIsCancelled(false)
+{
+}
+
+TeacherPretrainer::~TeacherPretrainer()
+{
+	mIsCancelled = true;
+	if (mRunningPretraining.valid())
+	{
+		mRunningPretraining.wait();
+	}
+}
+
+void TeacherPretrainer::start(const HeadlessGeometry& geometry, const PipeCourse::Settings& courseSettings, const std::vector<unsigned>& layers)
+{
+	if (isRunning())
+	{
+		return;
+	}
+
+	mIsCancelled = false;
+	mRunningPretraining = std::async(std::launch::async, [=, evaluator = FitnessEvaluator(geometry), settings = mSettings, &isCancelled = mIsCancelled]()
+	{
+		return run(evaluator, courseSettings, layers, settings, isCancelled);
+	});
+}
+
+bool TeacherPretrainer::isRunning() const
+{
+	return mRunningPretraining.valid();
+}
+
+std::optional<std::vector<GeneticAlgorithm::Unit>> TeacherPretrainer::takeNetworks()
+{
+	if (!isRunning() || mRunningPretraining.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return std::nullopt;
+	}
+
+	auto result = mRunningPretraining.get();
+	mReport = result.report;
+	return std::move(result.units);
+}
+
+void TeacherPretrainer::updateImGui()
+{
+	if (!isRunning())
+	{
+		ImGui::SliderInt("Teacher courses", &mSettings.numberOfCourses, 1, 16);
+		ImGui::SliderInt("Birds per course", &mSettings.birdsPerCourse, 1, 128);
+		ImGui::SliderFloat("Exploration rate", &mSettings.explorationRate, 0.f, 0.5f, "%.2f");
+		ImGui::SliderFloat("Flap margin", &mSettings.flapMargin, -0.1f, 0.1f, "%.3f");
+		ImGui::SliderInt("Trained networks", &mSettings.numberOfNetworks, 1, 32);
+		ImGui::SliderInt("Maximum epochs", &mSettings.maximumEpochs, 10, 2000);
+	}
+	else
+	{
+		ImGui::TextUnformatted("Training the networks, the birds wait for them...");
+	}
+
+	if (mReport)
+	{
+		ImGui::Text("Samples: %zu, flaps: %.1f%%", mReport->samples, mReport->flapShare * 100.f);
+		ImGui::Text("Teacher fitness: %.2f", mReport->teacherFitness);
+		ImGui::Text("Mean squared error: %.4f", mReport->meanSquaredError);
+		ImGui::Text("Best student fitness: %.2f", mReport->bestStudentFitness);
+		ImGui::Text("Time: %.1f s", mReport->seconds);
+	}
+}
+
+TeacherPretrainer::Result TeacherPretrainer::run(const FitnessEvaluator& evaluator, const PipeCourse::Settings& courseSettings,
+                                                 const std::vector<unsigned>& layers, const Settings& settings,
+                                                 const std::atomic<bool>& isCancelled)
+{
+	assert(layers.front() == FitnessEvaluator::NUMBER_OF_INPUTS && layers.back() == 1);
+
+	sf::Clock clock;
+	Result result{ {}, {} };
+
+	// Every course is flown on its own thread, exactly as in the evaluation
+	std::vector<std::future<Samples>> courseSamples;
+	for (auto course = 0; course < settings.numberOfCourses; ++course)
+	{
+		courseSamples.push_back(std::async(std::launch::async, [&, course]()
+		{
+			auto teacherCourseSettings = courseSettings;
+			teacherCourseSettings.seed += TEACHER_SEED_OFFSET + static_cast<std::uint32_t>(course);
+			std::mt19937 generator(teacherCourseSettings.seed);
+			std::bernoulli_distribution explores(settings.explorationRate);
+
+			Samples samples;
+			const auto fitness = evaluator.play(static_cast<std::size_t>(settings.birdsPerCourse), PipeCourse(teacherCourseSettings),
+			                                    settings.evaluation, [&](std::size_t bird, const fann_type* input)
+			{
+				// The second input is positive when the bird is above the center of the gap
+				const auto teacherFlaps = input[1] < -settings.flapMargin;
+				samples.inputs.insert(samples.inputs.end(), input, input + FitnessEvaluator::NUMBER_OF_INPUTS);
+				samples.outputs.push_back(teacherFlaps ? 1.f : 0.f);
+
+				// The first bird always does what the teacher says, so it shows how good the teacher is
+				return bird != 0 && explores(generator) ? !teacherFlaps : teacherFlaps;
+			});
+			samples.teacherFitness = fitness.empty() ? 0.f : fitness.front();
+			return samples;
+		}));
+	}
+
+	Samples allSamples;
+	for (auto& course : courseSamples)
+	{
+		auto samples = course.get();
+		allSamples.inputs.insert(allSamples.inputs.end(), samples.inputs.cbegin(), samples.inputs.cend());
+		allSamples.outputs.insert(allSamples.outputs.end(), samples.outputs.cbegin(), samples.outputs.cend());
+		allSamples.teacherFitness += samples.teacherFitness / static_cast<float>(settings.numberOfCourses);
+	}
+
+	// Long runs give far more samples than needed, so a random part of them is kept
+	std::vector<std::size_t> order(allSamples.outputs.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), std::mt19937(courseSettings.seed));
+	order.resize(std::min(order.size(), static_cast<std::size_t>(std::max(settings.maximumSamples, 0))));
+
+	std::vector<fann_type> inputs;
+	std::vector<fann_type> outputs;
+	inputs.reserve(order.size() * FitnessEvaluator::NUMBER_OF_INPUTS);
+	outputs.reserve(order.size());
+	for (const auto sample : order)
+	{
+		inputs.insert(inputs.end(), allSamples.inputs.cbegin() + sample * FitnessEvaluator::NUMBER_OF_INPUTS,
+		              allSamples.inputs.cbegin() + (sample + 1) * FitnessEvaluator::NUMBER_OF_INPUTS);
+		outputs.push_back(allSamples.outputs[sample]);
+	}
+	result.report.samples = outputs.size();
+	result.report.flapShare = outputs.empty() ? 0.f : std::accumulate(outputs.cbegin(), outputs.cend(), 0.f) / outputs.size();
+	result.report.teacherFitness = allSamples.teacherFitness;
+	if (outputs.empty())
+	{
+		return result;
+	}
+
+	auto* data = fann_create_train_array(static_cast<unsigned>(outputs.size()), FitnessEvaluator::NUMBER_OF_INPUTS, inputs.data(), 1, outputs.data());
+	const auto numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (auto network = 0; network < settings.numberOfNetworks && !isCancelled; ++network)
+	{
+		// Every network starts from its own random weights, so the seeded population is not uniform
+		auto* ann = fann_create_standard_array(static_cast<unsigned>(layers.size()), layers.data());
+		fann_randomize_weights(ann, -1.f, 1.f);
+		auto error = 1.f;
+		for (auto epoch = 0; epoch < settings.maximumEpochs && error > settings.desiredError && !isCancelled; ++epoch)
+		{
+			error = fann_train_epoch_irpropm_parallel(ann, data, numberOfThreads);
+		}
+		result.units.emplace_back(ann, network, 0);
+		result.report.meanSquaredError += error / static_cast<float>(settings.numberOfNetworks);
+	}
+	fann_destroy_train(data);
+
+	if (isCancelled)
+	{
+		result.units.clear();
+		return result;
+	}
+
+	// The students are scored on the courses the population is going to be scored on
+	auto evaluation = settings.evaluation;
+	evaluation.numberOfSeeds = settings.numberOfCourses;
+	evaluator.evaluate(result.units, courseSettings, evaluation);
+	for (const auto& unit : result.units)
+	{
+		result.report.bestStudentFitness = std::max(result.report.bestStudentFitness, unit.fitness);
+	}
+	result.report.seconds = clock.getElapsedTime().asSeconds();
+	return result;
+}
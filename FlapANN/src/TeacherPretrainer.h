@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <optional>
+
+#include "FitnessEvaluator.h"
+#include "GeneticAlgorithm.h"
+
+/**
+ * \brief Trains the first networks to imitate a simple analytic controller before the evolution starts.
+ *
+ * The teacher flaps whenever the bird is below the center of the gap it flies towards. It flies
+ * a few seeded courses in the headless game, and every decision it makes is recorded together
+ * with the inputs the network would get. Some birds do the opposite of what the teacher says
+ * from time to time, so the samples also show how to recover from mistakes, but they are
+ * always labelled with the decision of the teacher. Several networks are then trained on the
+ * samples with the multithreaded RPROP trainer of FANN, each from its own random weights, and
+ * they seed the population, which starts the evolution from birds that already fly.
+ */
+class TeacherPretrainer
+{
+public:
+	/**
+	 * \brief Options of the sampling and of the training
+	 */
+	struct Settings
+	{
+		/** Number of courses the teacher flies to collect the samples */
+		int numberOfCourses = 4;
+
+		/** Number of birds flying every course at once */
+		int birdsPerCourse = 32;
+
+		/** Chance that a bird does the opposite of what the teacher says */
+		float explorationRate = 0.1f;
+
+		/** How far below the center of the gap the teacher flaps, relative to the height of the screen */
+		float flapMargin = 0.02f;
+
+		/** Largest number of samples the networks are trained on */
+		int maximumSamples = 100000;
+
+		/** Number of networks trained */
+		int numberOfNetworks = 8;
+
+		/** Largest number of training epochs of a single network */
+		int maximumEpochs = 300;
+
+		/** Mean squared error at which the training of a network stops */
+		float desiredError = 0.02f;
+
+		/** Options of the runs in which the samples are collected and the trained networks are scored */
+		FitnessEvaluator::Settings evaluation{ 1, FitnessEvaluator::Aggregation::Mean, 0.25f, 60 * 60 };
+	};
+
+	/**
+	 * \brief Outcome of the last pretraining
+	 */
+	struct Report
+	{
+		std::size_t samples;
+		float flapShare;
+		float teacherFitness;
+		float meanSquaredError;
+		float bestStudentFitness;
+		float seconds;
+	};
+
+	TeacherPretrainer();
+
+	/**
+	 * \brief Stops the pretraining after the current epoch
+	 */
+	~TeacherPretrainer();
+
+	/**
+	 * \brief Starts the pretraining on a background thread, unless it is running already
+	 * \param geometry Sizes and forces of the game
+	 * \param courseSettings Settings of the course trained on. The teacher flies courses with other seeds.
+	 * \param layers Number of neurons in every layer of the networks
+	 */
+	void start(const HeadlessGeometry& geometry, const PipeCourse::Settings& courseSettings, const std::vector<unsigned>& layers);
+
+	/**
+	 * \brief Checks if the networks are still being trained
+	 * \return True if the pretraining was started and its networks were not taken yet
+	 */
+	bool isRunning() const;
+
+	/**
+	 * \brief Takes the trained networks if they are ready
+	 * \return Trained networks, or nothing if the pretraining is still running or was not started
+	 */
+	std::optional<std::vector<GeneticAlgorithm::Unit>> takeNetworks();
+
+	/**
+	 * \brief Updates the options of the pretraining and the report of the last one
+	 */
+	void updateImGui();
+
+private:
+	/**
+	 * \brief Networks trained together with the report of the training
+	 */
+	struct Result
+	{
+		std::vector<GeneticAlgorithm::Unit> units;
+		Report report;
+	};
+
+	/**
+	 * \brief Collects the samples and trains the networks, on the calling thread
+	 * \param evaluator Evaluator playing the courses
+	 * \param courseSettings Settings of the course trained on
+	 * \param layers Number of neurons in every layer of the networks
+	 * \param settings Options of the sampling and of the training
+	 * \param isCancelled Set when the pretraining has to stop early
+	 * \return Trained networks, none if the pretraining was cancelled
+	 */
+	static Result run(const FitnessEvaluator& evaluator, const PipeCourse::Settings& courseSettings,
+	                  const std::vector<unsigned>& layers, const Settings& settings, const std::atomic<bool>& isCancelled);
+
+private:
+	/** Options of the sampling and of the training */
+	Settings mSettings;
+
+	/** Pretraining running in the background. Not valid if nothing is running. */
+	std::future<Result> mRunningPretraining;
+
+	/** Set when the running pretraining has to stop early */
+	std::atomic<bool> mIsCancelled;
+
+	/** Outcome of the last finished pretraining */
+	std::optional<Report> mReport;
+};
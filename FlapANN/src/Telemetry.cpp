@@ -0,0 +1,208 @@
+#include "pch.h"
+#include "Telemetry.h"
+
+#include <filesystem>
+
+namespace
+{
+	/** Columns of the CSV file, written as its first line */
+	constexpr const char* CSV_HEADER = "generation,ticks,best_fitness,mean_fitness,median_fitness,evolve_ms,cache_hit_rate,diversity,"
+	                                   "mean_pairwise_distance,centroid_spread,surrogate_rank_correlation,surrogate_rejected_offspring,"
+	                                   "surrogate_saved_simulations";
+
+	/**
+	 * \brief Moves the existing file aside if it has other columns than the current ones,
+	 * so the rows of different layouts never end up in the same file
+	 * \param path_to_csv File to which the statistics are appended
+	 * \return Mode in which the file should be opened
+	 */
+	std::ios::openmode csvOpenMode(const std::string& path_to_csv)
+	{
+		std::string firstLine;
+		{
+			std::ifstream csv(path_to_csv);
+			if (!std::getline(csv, firstLine) || firstLine == CSV_HEADER)
+				return std::ios::app | std::ios::ate;
+		}
+
+		// The file that can not be moved aside is started again, as mixing the layouts is worse than losing it
+		std::error_code error;
+		std::filesystem::rename(path_to_csv, path_to_csv + ".old", error);
+		return error ? std::ios::trunc : std::ios::app | std::ios::ate;
+	}
+}
+
+DownsampledSeries::DownsampledSeries(std::size_t maximumPoints) :
+	mMaximumPoints(maximumPoints),
+	mValuesPerPoint(1),
+	mPendingSum(0.f),
+	mPendingValues(0)
+{
+	assert(maximumPoints >= 2 && maximumPoints % 2 == 0);
+	mPoints.reserve(maximumPoints);
+}
+
+void DownsampledSeries::push(float value)
+{
+	mPendingSum += value;
+	if (++mPendingValues < mValuesPerPoint)
+		return;
+
+	if (mPoints.size() == mMaximumPoints)
+	{
+		for (std::size_t index = 0; index < mMaximumPoints / 2; ++index)
+			mPoints[index] = (mPoints[2 * index] + mPoints[2 * index + 1]) / 2.f;
+		mPoints.resize(mMaximumPoints / 2);
+		mValuesPerPoint *= 2;
+	}
+	mPoints.push_back(mPendingSum / static_cast<float>(mPendingValues));
+	mPendingSum = 0.f;
+	mPendingValues = 0;
+}
+
+void DownsampledSeries::clear()
+{
+	mValuesPerPoint = 1;
+	mPendingSum = 0.f;
+	mPendingValues = 0;
+	mPoints.clear();
+}
+
+void DownsampledSeries::truncate(std::size_t numberOfValues)
+{
+	if (numberOfValues >= this->numberOfValues())
+		return;
+
+	mPoints.resize(numberOfValues / mValuesPerPoint);
+	mPendingSum = 0.f;
+	mPendingValues = 0;
+}
+
+std::size_t DownsampledSeries::numberOfValues() const
+{
+	return mPoints.size() * mValuesPerPoint + mPendingValues;
+}
+
+const std::vector<float>& DownsampledSeries::points() const
+{
+	return mPoints;
+}
+
+Telemetry::Telemetry(const std::string& path_to_csv) :
+	mDroppedRecords(0),
+	mBestFitness(PLOTTED_POINTS),
+	mMeanFitness(PLOTTED_POINTS),
+	mMedianFitness(PLOTTED_POINTS),
+	mEvolveMilliseconds(PLOTTED_POINTS),
+	mCacheHitRate(PLOTTED_POINTS),
+	mDiversity(PLOTTED_POINTS),
+	mMeanPairwiseDistance(PLOTTED_POINTS),
+	mSurrogateRankCorrelation(PLOTTED_POINTS),
+	mAliveBirds(PLOTTED_POINTS),
+	mCsv(path_to_csv, csvOpenMode(path_to_csv)),
+	mIsStopping(false),
+	mConsumer(&Telemetry::consumeRecords, this)
+{
+}
+
+Telemetry::~Telemetry()
+{
+	mIsStopping = true;
+	mConsumer.join();
+}
+
+void Telemetry::recordTick(std::uint32_t tick, std::uint32_t aliveBirds)
+{
+	push({ Record::Type::Tick, tick, aliveBirds, {} });
+}
+
+void Telemetry::recordGeneration(const GenerationStatistics& statistics)
+{
+	push({ Record::Type::Generation, 0, 0, statistics });
+}
+
+Telemetry::Plots Telemetry::plots() const
+{
+	std::lock_guard lock(mPlotsMutex);
+	return { mBestFitness.points(), mMeanFitness.points(), mMedianFitness.points(),
+	         mEvolveMilliseconds.points(), mCacheHitRate.points(), mDiversity.points(), mMeanPairwiseDistance.points(),
+	         mSurrogateRankCorrelation.points(), mAliveBirds.points() };
+}
+
+std::size_t Telemetry::droppedRecords() const
+{
+	return mDroppedRecords.load(std::memory_order_relaxed);
+}
+
+void Telemetry::push(const Record& record)
+{
+	if (!mRecords.tryPush(record))
+		mDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Telemetry::consumeRecords()
+{
+	if (mCsv && mCsv.tellp() == 0)
+		mCsv << CSV_HEADER << '\n';
+
+	while (true)
+	{
+		// The flag is read before draining, so the records pushed before stopping are never lost
+		const auto isStopping = mIsStopping.load();
+		auto hasConsumed = false;
+		while (auto record = mRecords.tryPop())
+		{
+			consume(*record);
+			hasConsumed = true;
+		}
+
+		if (isStopping)
+			break;
+		if (!hasConsumed)
+			std::this_thread::sleep_for(CONSUMER_IDLE_TIME);
+	}
+	mCsv.flush();
+}
+
+void Telemetry::consume(const Record& record)
+{
+	switch (record.type)
+	{
+		case Record::Type::Tick:
+		{
+			// The tick goes back when a new generation starts, or when the generation is rewound
+			std::lock_guard lock(mPlotsMutex);
+			if (record.tick == 0)
+				mAliveBirds.clear();
+			mAliveBirds.truncate(record.tick);
+			mAliveBirds.push(static_cast<float>(record.aliveBirds));
+			break;
+		}
+		case Record::Type::Generation:
+		{
+			const auto& statistics = record.generation;
+			{
+				std::lock_guard lock(mPlotsMutex);
+				mBestFitness.push(statistics.bestFitness);
+				mMeanFitness.push(statistics.meanFitness);
+				mMedianFitness.push(statistics.medianFitness);
+				mEvolveMilliseconds.push(statistics.evolveMilliseconds);
+				mCacheHitRate.push(statistics.cacheHitRate);
+				mDiversity.push(statistics.diversity);
+				mMeanPairwiseDistance.push(statistics.meanPairwiseDistance);
+				mSurrogateRankCorrelation.push(statistics.surrogateRankCorrelation);
+			}
+
+			// Written outside of the lock, so the game drawing the plots never waits for the disk
+			mCsv << statistics.generation << ',' << statistics.ticks << ','
+			     << statistics.bestFitness << ',' << statistics.meanFitness << ','
+			     << statistics.medianFitness << ',' << statistics.evolveMilliseconds << ','
+			     << statistics.cacheHitRate << ',' << statistics.diversity << ','
+			     << statistics.meanPairwiseDistance << ',' << statistics.centroidSpread << ','
+			     << statistics.surrogateRankCorrelation << ',' << statistics.surrogateRejectedOffspring << ','
+			     << statistics.surrogateSavedSimulations << '\n';
+			mCsv.flush();
+			break;
+		}
+	}
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LockFreeRing.h"
+
+/**
+ * \brief Summary of a single finished generation
+ */
+struct GenerationStatistics
+{
+	std::uint32_t generation;
+	std::uint32_t ticks;
+	float bestFitness;
+	float meanFitness;
+	float medianFitness;
+	float evolveMilliseconds;
+	float cacheHitRate;
+	float diversity;
+	float meanPairwiseDistance;
+	float centroidSpread;
+	float surrogateRankCorrelation;
+	std::uint32_t surrogateRejectedOffspring;
+	std::uint32_t surrogateSavedSimulations;
+};
+
+/**
+ * \brief Series of values that never grows past the given number of points.
+ *
+ * Once the series is full, each two neighbouring points are merged into their average,
+ * and from then on every point is the average of twice as many values as before.
+ * Thanks to this even very long training fits into a plot of the same size.
+ */
+class DownsampledSeries
+{
+public:
+	/**
+	 * \brief Creates an empty series
+	 * \param maximumPoints Maximum number of points, has to be even
+	 */
+	explicit DownsampledSeries(std::size_t maximumPoints);
+
+	/**
+	 * \brief Adds the next value to the series
+	 * \param value Value to add
+	 */
+	void push(float value);
+
+	/**
+	 * \brief Removes all the values
+	 */
+	void clear();
+
+	/**
+	 * \brief Forgets the newest values, keeping only the given number of the oldest ones
+	 * \param numberOfValues Number of values to keep
+	 *
+	 * Only whole points are kept, so up to a single point more might be forgotten.
+	 */
+	void truncate(std::size_t numberOfValues);
+
+	/**
+	 * \brief Returns the number of values pushed to the series
+	 * \return Number of values
+	 */
+	std::size_t numberOfValues() const;
+
+	/**
+	 * \brief Returns the points of the series
+	 * \return Points to be plotted
+	 */
+	const std::vector<float>& points() const;
+
+private:
+	/** Maximum number of points */
+	std::size_t mMaximumPoints;
+
+	/** Number of values averaged into a single point */
+	std::size_t mValuesPerPoint;
+
+	/** Sum of the values of the point that is not complete yet */
+	float mPendingSum;
+
+	/** Number of values of the point that is not complete yet */
+	std::size_t mPendingValues;
+
+	/** Complete points */
+	std::vector<float> mPoints;
+};
+
+/**
+ * \brief Collects statistics of the training without ever slowing the game down.
+ *
+ * The game only puts small records into the lock-free ring. Everything else -- building
+ * the plotted series and appending the statistics to the CSV file -- is done by the
+ * separate consumer thread. If the consumer can not keep up, the records are dropped
+ * rather than making the game wait.
+ */
+class Telemetry
+{
+public:
+	/**
+	 * \brief Series ready to be plotted
+	 */
+	struct Plots
+	{
+		std::vector<float> bestFitness;
+		std::vector<float> meanFitness;
+		std::vector<float> medianFitness;
+		std::vector<float> evolveMilliseconds;
+		std::vector<float> cacheHitRate;
+		std::vector<float> diversity;
+		std::vector<float> meanPairwiseDistance;
+		std::vector<float> surrogateRankCorrelation;
+		std::vector<float> aliveBirds;
+	};
+
+	/**
+	 * \brief Starts the consumer thread
+	 * \param path_to_csv File to which the statistics of every generation are appended. A file
+	 * with other columns is moved aside to the same path ending with ".old", and a new one is started.
+	 */
+	explicit Telemetry(const std::string& path_to_csv);
+
+	/**
+	 * \brief Handles all the remaining records and stops the consumer thread
+	 */
+	~Telemetry();
+
+	Telemetry(const Telemetry&) = delete;
+	Telemetry& operator=(const Telemetry&) = delete;
+
+	/**
+	 * \brief Records the number of birds alive at the given tick
+	 * \param tick Tick counting from the start of the generation
+	 * \param aliveBirds Number of birds still alive
+	 */
+	void recordTick(std::uint32_t tick, std::uint32_t aliveBirds);
+
+	/**
+	 * \brief Records the summary of the finished generation
+	 * \param statistics Summary of the generation
+	 */
+	void recordGeneration(const GenerationStatistics& statistics);
+
+	/**
+	 * \brief Returns a copy of the plotted series
+	 * \return Series ready to be plotted
+	 */
+	Plots plots() const;
+
+	/**
+	 * \brief Returns the number of records dropped, because the consumer could not keep up
+	 * \return Number of dropped records
+	 */
+	std::size_t droppedRecords() const;
+
+private:
+	/**
+	 * \brief Single record passed from the game to the consumer thread
+	 */
+	struct Record
+	{
+		enum class Type : std::uint8_t
+		{
+			Tick,
+			Generation,
+		};
+
+		Type type;
+		std::uint32_t tick;
+		std::uint32_t aliveBirds;
+		GenerationStatistics generation;
+	};
+
+	/**
+	 * \brief Puts the record into the ring, or drops it if the ring is full
+	 * \param record Record to put
+	 */
+	void push(const Record& record);
+
+	/**
+	 * \brief Takes the records from the ring until the telemetry is destroyed
+	 */
+	void consumeRecords();
+
+	/**
+	 * \brief Handles the single record
+	 * \param record Record taken from the ring
+	 */
+	void consume(const Record& record);
+
+private:
+	/** Number of points of each plotted series */
+	static constexpr std::size_t PLOTTED_POINTS = 512;
+
+	/** Time the consumer sleeps for when there is nothing to do */
+	static constexpr std::chrono::milliseconds CONSUMER_IDLE_TIME{ 20 };
+
+	/** Records waiting for the consumer */
+	LockFreeRing<Record, 4096> mRecords;
+
+	/** Number of records dropped, because the ring was full */
+	std::atomic<std::size_t> mDroppedRecords;
+
+	/** Guards the plotted series, which are read by the game and written by the consumer */
+	mutable std::mutex mPlotsMutex;
+
+	DownsampledSeries mBestFitness;
+	DownsampledSeries mMeanFitness;
+	DownsampledSeries mMedianFitness;
+	DownsampledSeries mEvolveMilliseconds;
+	DownsampledSeries mCacheHitRate;
+	DownsampledSeries mDiversity;
+	DownsampledSeries mMeanPairwiseDistance;
+	DownsampledSeries mSurrogateRankCorrelation;
+
+	/** Number of birds alive at each tick of the current generation */
+	DownsampledSeries mAliveBirds;
+
+	/** File to which the statistics of every generation are appended, used only by the consumer */
+	std::ofstream mCsv;
+
+	/** Flag telling the consumer thread to finish */
+	std::atomic<bool> mIsStopping;
+
+	/** Thread taking the records from the ring */
+	std::thread mConsumer;
+};
@@ -0,0 +1,272 @@
+#include "pch.h"
+#include "ResourceArchive.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr char ARCHIVE_MAGIC[8] = { 'F', 'L', 'A', 'P', 'A', 'K', '0', '1' };
+
+	template <typename T>
+	bool readValue(const char*& cursor, const char* end, T& value)
+	{
+		if (static_cast<std::size_t>(end - cursor) < sizeof(T))
+			return false;
+		std::memcpy(&value, cursor, sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+
+	template <typename T>
+	void writeValue(std::ofstream& file, const T& value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	std::vector<std::filesystem::path> filesInDirectory(const std::string& directory, std::error_code& error)
+	{
+		std::vector<std::filesystem::path> files;
+		for (auto entry = std::filesystem::recursive_directory_iterator(directory, error);
+			!error && entry != std::filesystem::recursive_directory_iterator(); entry.increment(error))
+		{
+			if (entry->is_regular_file(error))
+				files.push_back(entry->path());
+		}
+		return files;
+	}
+}
+
+ResourceArchive::ResourceArchive() :
+	mMappedData(nullptr),
+	mMappedSize(0),
+	mFileHandle(nullptr),
+	mMappingHandle(nullptr)
+{
+}
+
+ResourceArchive::~ResourceArchive()
+{
+	close();
+}
+
+bool ResourceArchive::open(const std::string& path_to_archive)
+{
+	close();
+
+#ifdef _WIN32
+	auto file = CreateFileA(path_to_archive.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	mFileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+	mMappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+
+	mMappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mMappingHandle)
+	{
+		close();
+		return false;
+	}
+	mMappedData = static_cast<const char*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+	auto file = ::open(path_to_archive.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	mFileHandle = reinterpret_cast<void*>(static_cast<std::intptr_t>(file) + 1);
+
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0 || fileStatus.st_size == 0)
+	{
+		close();
+		return false;
+	}
+	mMappedSize = static_cast<std::size_t>(fileStatus.st_size);
+
+	auto mapped = mmap(nullptr, mMappedSize, PROT_READ, MAP_PRIVATE, file, 0);
+	mMappedData = (mapped == MAP_FAILED) ? nullptr : static_cast<const char*>(mapped);
+#endif
+
+	if (!mMappedData || !readEntries())
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void ResourceArchive::close()
+{
+	mEntries.clear();
+
+#ifdef _WIN32
+	if (mMappedData)
+		UnmapViewOfFile(mMappedData);
+	if (mMappingHandle)
+		CloseHandle(mMappingHandle);
+	if (mFileHandle)
+		CloseHandle(mFileHandle);
+#else
+	if (mMappedData)
+		munmap(const_cast<char*>(mMappedData), mMappedSize);
+	if (mFileHandle)
+		::close(static_cast<int>(reinterpret_cast<std::intptr_t>(mFileHandle) - 1));
+#endif
+
+	mMappedData = nullptr;
+	mMappedSize = 0;
+	mFileHandle = nullptr;
+	mMappingHandle = nullptr;
+}
+
+bool ResourceArchive::isOpen() const
+{
+	return mMappedData != nullptr;
+}
+
+const ResourceArchive::Entry* ResourceArchive::find(const std::string& path_to_file) const
+{
+	auto foundEntry = mEntries.find(path_to_file);
+	return (foundEntry == mEntries.cend()) ? nullptr : &foundEntry->second;
+}
+
+bool ResourceArchive::readEntries()
+{
+	const char* cursor = mMappedData;
+	const char* end = mMappedData + mMappedSize;
+
+	char magic[sizeof(ARCHIVE_MAGIC)];
+	if (!readValue(cursor, end, magic) || std::memcmp(magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0)
+		return false;
+
+	std::uint32_t numberOfEntries;
+	if (!readValue(cursor, end, numberOfEntries))
+		return false;
+
+	for (std::uint32_t entryIndex = 0; entryIndex < numberOfEntries; ++entryIndex)
+	{
+		std::uint32_t pathLength;
+		if (!readValue(cursor, end, pathLength) || static_cast<std::size_t>(end - cursor) < pathLength)
+			return false;
+		std::string path(cursor, pathLength);
+		cursor += pathLength;
+
+		std::uint64_t offset, size;
+		if (!readValue(cursor, end, offset) || !readValue(cursor, end, size) || offset + size > mMappedSize)
+			return false;
+
+		mEntries[path] = { mMappedData + offset, static_cast<std::size_t>(size) };
+	}
+	return true;
+}
+
+bool ResourceArchive::create(const std::string& path_to_archive, const std::string& resourcesDirectory)
+{
+	std::error_code error;
+	if (!std::filesystem::is_directory(resourcesDirectory, error))
+		return false;
+
+	const auto files = filesInDirectory(resourcesDirectory, error);
+	if (error)
+		return false;
+
+	// Paths are kept in the same form as the game asks for them,
+	// so the archive can be used instead of loose files transparently
+	std::vector<std::string> paths;
+	std::uint64_t headerSize = sizeof(ARCHIVE_MAGIC) + sizeof(std::uint32_t);
+	for (const auto& file : files)
+	{
+		paths.push_back(file.generic_string());
+		headerSize += sizeof(std::uint32_t) + paths.back().size() + 2 * sizeof(std::uint64_t);
+	}
+
+	// Written to the temporary file first, so the running game never sees a half-written archive
+	const auto temporaryPath = path_to_archive + ".tmp";
+	{
+		std::ofstream archive(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!archive)
+			return false;
+
+		archive.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+		writeValue(archive, static_cast<std::uint32_t>(files.size()));
+
+		std::uint64_t offset = headerSize;
+		for (std::size_t fileIndex = 0; fileIndex < files.size(); ++fileIndex)
+		{
+			const auto size = static_cast<std::uint64_t>(std::filesystem::file_size(files[fileIndex], error));
+			if (error)
+				return false;
+			writeValue(archive, static_cast<std::uint32_t>(paths[fileIndex].size()));
+			archive.write(paths[fileIndex].data(), paths[fileIndex].size());
+			writeValue(archive, offset);
+			writeValue(archive, size);
+			offset += size;
+		}
+
+		for (const auto& file : files)
+		{
+			// Streaming an empty buffer sets the failbit of the archive, so the empty files are skipped
+			if (std::filesystem::file_size(file, error) == 0 || error)
+				continue;
+			std::ifstream input(file, std::ios::binary);
+			archive << input.rdbuf();
+		}
+
+		if (!archive)
+			return false;
+	}
+
+	std::filesystem::rename(temporaryPath, path_to_archive, error);
+	return !error;
+}
+
+bool ResourceArchive::isOutdated(const std::string& path_to_archive, const std::string& resourcesDirectory)
+{
+	std::error_code error;
+	const auto archiveWriteTime = std::filesystem::last_write_time(path_to_archive, error);
+	if (error)
+		return true;
+
+	// There is nothing the archive could be created from, so it is as fresh as it can be
+	if (!std::filesystem::is_directory(resourcesDirectory, error))
+		return false;
+
+	// Added and removed files leave the modification times of the others untouched,
+	// so the stored list of the files is compared as well
+	ResourceArchive archive;
+	if (!archive.open(path_to_archive))
+		return true;
+
+	const auto files = filesInDirectory(resourcesDirectory, error);
+	if (error || files.size() != archive.mEntries.size())
+		return true;
+
+	for (const auto& file : files)
+	{
+		const auto* entry = archive.find(file.generic_string());
+		if (!entry || entry->size != std::filesystem::file_size(file, error) ||
+			std::filesystem::last_write_time(file, error) > archiveWriteTime)
+			return true;
+	}
+	return static_cast<bool>(error);
+}
@@ -0,0 +1,104 @@
+#ifndef RESOURCEARCHIVE_H
+#define RESOURCEARCHIVE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SFML/System/NonCopyable.hpp>
+
+/**
+ * \brief A single file containing all the resources of the game, mapped directly into the memory.
+ *
+ * Instead of opening and reading dozens of loose files on start, the whole archive is
+ * mapped into the memory at once and the resources are decoded straight from it.
+ * The operating system loads only the pages that are really touched.
+ *
+ * The archive consists of a small header, the table of entries (path, offset, size)
+ * and the raw contents of the files one after another:
+ *
+ *  +-------+-------+-------------------------------+------------------------+
+ *  | magic | count | entries (path, offset, size)  | contents of the files  |
+ *  +-------+-------+-------------------------------+------------------------+
+ *
+ * Memory returned by the archive stays valid as long as the archive is open. This is
+ * important for the resources like sf::Font which do not copy the data they are loaded from.
+ */
+class ResourceArchive : private sf::NonCopyable
+{
+public:
+	/**
+	 * \brief Contents of the single file stored in the archive
+	 */
+	struct Entry
+	{
+		const void* data;
+		std::size_t size;
+	};
+
+	ResourceArchive();
+	~ResourceArchive();
+
+	/**
+	 * \brief Maps the archive with the given path into the memory
+	 * \param path_to_archive File path specifying the archive
+	 * \return True if the archive was opened, false otherwise
+	 */
+	bool open(const std::string& path_to_archive);
+
+	/**
+	 * \brief Unmaps the archive. All the entries returned before become invalid.
+	 */
+	void close();
+
+	/**
+	 * \brief Checks if the archive is opened
+	 * \return True if the archive is opened, false otherwise
+	 */
+	bool isOpen() const;
+
+	/**
+	 * \brief Looks for the file stored in the archive under the given path
+	 * \param path_to_file Path of the file the same as it was before packing (e.g. "resources/fonts/arial.ttf")
+	 * \return Pointer to the entry of the file, or nullptr if there is no such file in the archive
+	 */
+	const Entry* find(const std::string& path_to_file) const;
+
+	/**
+	 * \brief Packs all the files from the given directory (recursively) into a single archive
+	 * \param path_to_archive File path under which the archive is saved
+	 * \param resourcesDirectory Directory containing all the resources
+	 * \return True if the archive was created, false otherwise
+	 */
+	static bool create(const std::string& path_to_archive, const std::string& resourcesDirectory);
+
+	/**
+	 * \brief Checks if the archive is missing, any of the resources was modified after it was created,
+	 * or the resources were added or removed since then
+	 * \param path_to_archive File path specifying the archive
+	 * \param resourcesDirectory Directory containing all the resources
+	 * \return True if the archive should be created again, false otherwise
+	 */
+	static bool isOutdated(const std::string& path_to_archive, const std::string& resourcesDirectory);
+
+private:
+	/**
+	 * \brief Reads the table of entries from the mapped memory
+	 * \return True if the archive has a valid format, false otherwise
+	 */
+	bool readEntries();
+
+	/** Beginning of the archive mapped into the memory */
+	const char* mMappedData;
+
+	/** Size of the archive in bytes */
+	std::size_t mMappedSize;
+
+	/** Handles of the opened archive that are specific to the operating system */
+	void* mFileHandle;
+	void* mMappingHandle;
+
+	/** Path of each stored file to its contents inside the mapped memory */
+	std::unordered_map<std::string, Entry> mEntries;
+};
+
+#endif
@@ -1,12 +1,50 @@
 #ifndef RESOURCEMANAGER_H
 #define RESOURCEMANAGER_H
 
-#include <map>
+#include <array>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "Resources/ResourceArchive.h"
 
 // It may not hold sf::Music as it is different starting with openFromFile()
 // most because this type is rather streamed than stored
 
+/**
+ * \brief Describes how the resource is made from the data decoded on the worker thread
+ * \tparam Resource Type of the resource
+ *
+ * By default the resource is decoded in its entirety on the worker thread.
+ * Resources that need the OpenGL context (like sf::Texture) should specialize it,
+ * so only the decoding happens on the worker thread, and finish() is done on the
+ * thread that loads the resources.
+ */
+template <typename Resource>
+struct ResourceDecoder
+{
+	/** Type that is decoded from the file on the worker thread */
+	using Decoded = Resource;
+
+	/**
+	 * \brief Turns the decoded data into the resource
+	 * \param decoded Data decoded from the file
+	 * \return Ready to use resource, or nullptr if it can not be made
+	 */
+	static std::unique_ptr<Resource> finish(std::unique_ptr<Decoded> decoded)
+	{
+		return decoded;
+	}
+};
+
+
+/**
+ * \brief Stores resources of the game under the identifiers of the given enum.
+ *
+ * Resources are kept in an array indexed directly by the identifier,
+ * so the identifier enum has to end with the "Last" value.
+ */
 template <typename Resource, typename Identifier>
 class ResourceManager
 {
@@ -17,7 +55,7 @@ public:
 	 * \param id Identifier identifying a previously saved resource
 	 * \return the resource stored for the given identifier.
 	 *
-	 * Returns reference to Resource inside ResourceMap corresponding to given Identifier
+	 * Returns reference to Resource inside ResourceArray corresponding to given Identifier
 	 */
 	Resource& getResourceReference(Identifier id);
 
@@ -26,7 +64,7 @@ public:
      * \param id Identifier identifying a previously saved resource
      * \return the resource stored for the given identifier.
      *
-     * Returns reference to Resource inside ResourceMap corresponding to given Identifier
+     * Returns reference to Resource inside ResourceArray corresponding to given Identifier
      */
 	const Resource& getResourceReference(Identifier id) const;
 
@@ -35,7 +73,7 @@ public:
 	 * \param id Identifier to which the resource is to be assigned
 	 * \param path_to_file File path specifying the resource
 	 *
-	 * Stores the given texture resource inside the ResourceMap
+	 * Stores the given texture resource inside the ResourceArray
 	 */
 	void storeResource(Identifier id, const std::string& path_to_file);
 
@@ -46,7 +84,7 @@ public:
      * \param path_to_file File path specifying the resource
      * \param parameter Additional argument (fragment shader file path, or sf::IntRect)
      *
-     * Stores the given texture resource inside the ResourceMap
+     * Stores the given texture resource inside the ResourceArray
      *
      * Specialized version of this function to carry one of the methods that sf::Shader
      * define -- which is loadFromFile() containing additional Fragment Shader File Path
@@ -56,16 +94,72 @@ public:
     template <typename Additional_Parameter>
     void storeResource(Identifier id, const std::string& path_to_file, const Additional_Parameter& parameter);
 
+	/**
+	 * \brief Assigns a given identifier to a resource that will be loaded later by loadQueuedResources()
+	 * \param id Identifier to which the resource is to be assigned
+	 * \param path_to_file File path specifying the resource
+	 * \param onLoad Optional function called on the resource right after it is loaded
+	 */
+	void queueResource(Identifier id, const std::string& path_to_file, std::function<void(Resource&)> onLoad = {});
+
+	/**
+	 * \brief Loads all queued resources at once.
+	 *
+	 * Every resource is decoded on its own worker thread, so the
+	 * time of loading is close to the time of loading the biggest one.
+	 */
+	void loadQueuedResources();
+
+	/**
+	 * \brief Makes the manager read resources from the archive instead of loose files
+	 * \param archive Opened archive. It has to outlive all the resources loaded from it.
+	 *
+	 * Files that are not present inside the archive are still read from the disk.
+	 */
+	void useArchive(const ResourceArchive& archive);
+
+protected:
+	/**
+	 * \brief Loads the object from the archive, or from the file if it is not in the archive
+	 * \tparam Loadable Any type having loadFromFile() and loadFromMemory() (sf::Image, sf::Font...)
+	 * \param loadable Object to load
+	 * \param path_to_file File path specifying the object
+	 * \return True if the object was loaded, false otherwise
+	 */
+	template <typename Loadable>
+	bool loadFromSource(Loadable& loadable, const std::string& path_to_file) const;
 
 private:
+	/**
+	 * \brief Resource waiting in the queue to be loaded
+	 */
+	struct QueuedResource
+	{
+		Identifier id;
+		std::string path;
+		std::function<void(Resource&)> onLoad;
+	};
+
+	/**
+	 * \brief Puts the resource under the given identifier
+	 * \param id Identifier to which the resource is to be assigned
+	 * \param resource Resource to store
+	 */
+	void insertResource(Identifier id, std::unique_ptr<Resource> resource);
 
 	/**
-	 * \brief Map of identifier to given resource.
+	 * \brief Array of resources indexed by their identifier.
 	 *
 	 * Some object are really heavy, so it is better to store them just once
 	 * and to not load it multiple times.
 	 */
-	std::map<Identifier, std::unique_ptr<Resource>> ResourceMap;
+	std::array<std::unique_ptr<Resource>, static_cast<std::size_t>(Identifier::Last)> mResources;
+
+	/** Resources waiting to be loaded by loadQueuedResources() */
+	std::vector<QueuedResource> mQueuedResources;
+
+	/** Archive from which the resources are read. Nullptr if loose files are used. */
+	const ResourceArchive* mArchive = nullptr;
 };
 
 
@@ -73,6 +167,7 @@ private:
 
 #include <stdexcept>
 #include <cassert>
+#include <future>
 
 template <typename Resource, typename Identifier>
 Resource& ResourceManager<Resource, Identifier>::getResourceReference(Identifier id)
@@ -86,70 +181,125 @@ Resource& ResourceManager<Resource, Identifier>::getResourceReference(Identifier
 template <typename Resource, typename Identifier>
 const Resource& ResourceManager<Resource, Identifier>::getResourceReference(Identifier id) const
 {
-    // Tries to find a given Identifier, but throws an runtime_error
-    // if there is no such one in a map. Ignoring it may lead to
+    // The identifier is directly an index of the resource, so there is
+    // nothing to search for. Ignoring a missing resource may lead to
     // errors as programmer probably does not know that it is valid
-    auto found_texture = ResourceMap.find(id);
-
-    //if (found_texture == ResourceMap.cend())
-    //    throw std::runtime_error("Resource with given ID does not exist: " + std::to_string(static_cast<int>(id)));
+    const auto& found_resource = mResources[static_cast<std::size_t>(id)];
 
-    assert(found_texture != ResourceMap.cend()); // Resource with given ID does not exist
+    assert(found_resource); // Resource with given ID does not exist
     // I found this way better as probably end-user should not see such an errors that are
     // meant for the programmer. This error as it is assert occurs only in _DEBUG, and
     // for Release version of the program is optimized as it ignores this line.
 
-    return *found_texture->second;
+    return *found_resource;
 }
 
 template <typename Resource, typename Identifier>
 void ResourceManager<Resource, Identifier>::storeResource(Identifier id, const std::string& path_to_file)
 {
-    // Stores a unique_pointer to new resource. 
-    std::unique_ptr<Resource> resource = std::make_unique<Resource>();
+    auto decoded = std::make_unique<typename ResourceDecoder<Resource>::Decoded>();
 
-    // Loads the resource from the given filename
-    if (!resource->loadFromFile(path_to_file))
+    // Loads the resource from the given filename (or the archive)
+    if (!loadFromSource(*decoded, path_to_file))
         throw std::runtime_error("This file does not exist: " + path_to_file);
 
-    // Inserts the resource to the map of Identifier to std::string by passing
-    // the unique pointer by its rvalue (so the map takes the ownership from
-    // the variable "resource" in it's value part of the pair transfered to it).
-    auto inserted_resource = ResourceMap.insert(std::make_pair(id, std::move(resource)));
-
-    //if (!inserted_resource.second)
-    //    throw std::logic_error("Tried to insert resource multiple times: " + path_to_file);
+    auto resource = ResourceDecoder<Resource>::finish(std::move(decoded));
+    if (!resource)
+        throw std::runtime_error("Unable to create resource from file: " + path_to_file);
 
-    assert(inserted_resource.second); // Tried to insert resource multiple times
-    // I found this way better as probably end-user should not see such an errors that are
-    // meant for the programmer. This error as it is assert occurs only in _DEBUG, and
-    // for Release version of the program is optimized as it ignores this line.
+    insertResource(id, std::move(resource));
 }
 
 template<typename Resource, typename Identifier>
 template<typename Additional_Parameter>
 void ResourceManager<Resource, Identifier>::storeResource(Identifier id, const std::string& path_to_file, const Additional_Parameter& parameter)
 {
-    // Stores a unique_pointer to new resource. 
+    // Stores a unique_pointer to new resource.
     std::unique_ptr<Resource> resource = std::make_unique<Resource>();
 
     // Loads the resource from the given filename
     if (!resource->loadFromFile(path_to_file, parameter))
         throw std::runtime_error("This file does not exist: " + path_to_file);
 
-    // Inserts the resource to the map of Identifier to std::string by passing
-    // the unique pointer by its rvalue (so the map takes the ownership from
-    // the variable "resource" in it's value part of the pair transfered to it).
-    auto inserted_resource = ResourceMap.insert(std::make_pair(id, std::move(resource)));
+    insertResource(id, std::move(resource));
+}
+
+template <typename Resource, typename Identifier>
+void ResourceManager<Resource, Identifier>::queueResource(Identifier id, const std::string& path_to_file,
+                                                          std::function<void(Resource&)> onLoad)
+{
+    mQueuedResources.push_back({ id, path_to_file, std::move(onLoad) });
+}
+
+template <typename Resource, typename Identifier>
+void ResourceManager<Resource, Identifier>::loadQueuedResources()
+{
+    using Decoded = typename ResourceDecoder<Resource>::Decoded;
+
+    // Reading and decoding the files is the heaviest part, and it does not need
+    // the OpenGL context, so each of the resources is decoded on a separate thread
+    std::vector<std::future<std::unique_ptr<Decoded>>> decodedResources;
+    for (const auto& queued : mQueuedResources)
+    {
+        decodedResources.push_back(std::async(std::launch::async, [this, &queued]()
+        {
+            auto decoded = std::make_unique<Decoded>();
+            if (!loadFromSource(*decoded, queued.path))
+                throw std::runtime_error("This file does not exist: " + queued.path);
+            return decoded;
+        }));
+    }
 
-    //if (!inserted_resource.second)
+    // While the rest of the work is done on this thread. If the decoding failed
+    // then get() throws the same exception that was thrown on the worker thread
+    for (std::size_t index = 0; index < mQueuedResources.size(); ++index)
+    {
+        const auto& queued = mQueuedResources[index];
+        auto resource = ResourceDecoder<Resource>::finish(decodedResources[index].get());
+        if (!resource)
+            throw std::runtime_error("Unable to create resource from file: " + queued.path);
+
+        if (queued.onLoad)
+            queued.onLoad(*resource);
+
+        insertResource(queued.id, std::move(resource));
+    }
+    mQueuedResources.clear();
+}
+
+template <typename Resource, typename Identifier>
+void ResourceManager<Resource, Identifier>::useArchive(const ResourceArchive& archive)
+{
+    mArchive = &archive;
+}
+
+template <typename Resource, typename Identifier>
+template <typename Loadable>
+bool ResourceManager<Resource, Identifier>::loadFromSource(Loadable& loadable, const std::string& path_to_file) const
+{
+    if (mArchive)
+    {
+        if (const auto* entry = mArchive->find(path_to_file))
+            return loadable.loadFromMemory(entry->data, entry->size);
+    }
+    return loadable.loadFromFile(path_to_file);
+}
+
+template <typename Resource, typename Identifier>
+void ResourceManager<Resource, Identifier>::insertResource(Identifier id, std::unique_ptr<Resource> resource)
+{
+    auto& inserted_resource = mResources[static_cast<std::size_t>(id)];
+
+    //if (inserted_resource)
     //    throw std::logic_error("Tried to insert resource multiple times: " + path_to_file);
 
-    assert(inserted_resource.second); // Tried to insert resource multiple times
+    assert(!inserted_resource); // Tried to insert resource multiple times
     // I found this way better as probably end-user should not see such an errors that are
     // meant for the programmer. This error as it is assert occurs only in _DEBUG, and
     // for Release version of the program is optimized as it ignores this line.
+
+    inserted_resource = std::move(resource);
 }
 
 
-#endif
\ No newline at end of file
+#endif
@@ -2,9 +2,11 @@
 #define RESOURCES_H
 
 #include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Texture.hpp>
 
 #include "Resources/ResourceManager.h"
+#include "Resources/TextureAtlas.h"
 
 // ====== Textures ======= //
 
@@ -19,12 +21,88 @@ enum class Textures_ID
 	Pipe_Green,
 	Background_Day,
 	Ground,
+
+	Last,
+};
+
+/**
+ * \brief Textures need the OpenGL context to be created, so only the image is
+ * decoded on the worker thread. It is uploaded to the graphics card later.
+ */
+template <>
+struct ResourceDecoder<sf::Texture>
+{
+	using Decoded = sf::Image;
+
+	static std::unique_ptr<sf::Texture> finish(std::unique_ptr<sf::Image> image)
+	{
+		auto texture = std::make_unique<sf::Texture>();
+		return texture->loadFromImage(*image) ? std::move(texture) : nullptr;
+	}
 };
 
 /**
  * \brief Object storing textures of the game
+ *
+ * Small textures that are never repeated can be packed into a single atlas.
+ * Regardless of whether the texture was packed or not, it is read the same way
+ * -- as a texture and the rectangle that the resource occupies inside it.
+ * The easiest way is to simply ask for the sprite that already has both set.
  */
-using TextureManager = ResourceManager<sf::Texture, Textures_ID>;
+class TextureManager : public ResourceManager<sf::Texture, Textures_ID>
+{
+public:
+	/**
+	 * \brief Assigns a given identifier to an image that will be packed into the texture atlas
+	 * \param id Identifier to which the resource is to be assigned
+	 * \param path_to_file File path specifying the resource
+	 *
+	 * The resource is not available until loadQueuedResources() is called.
+	 */
+	void queueResourceInAtlas(Textures_ID id, const std::string& path_to_file);
+
+	/**
+	 * \brief Loads all queued textures at once and packs the ones queued for the atlas into it
+	 *
+	 * Images of the atlas are decoded on worker threads together with the standalone textures.
+	 */
+	void loadQueuedResources();
+
+	/**
+	 * \brief Checks an individual identifier and returns the texture containing it
+	 * \param id Identifier identifying a previously saved resource
+	 * \return The standalone texture, or the atlas texture if resource was packed
+	 */
+	sf::Texture& getResourceReference(Textures_ID id);
+
+	/**
+	 * \brief Checks an individual identifier and returns the texture containing it
+	 * \param id Identifier identifying a previously saved resource
+	 * \return The standalone texture, or the atlas texture if resource was packed
+	 */
+	const sf::Texture& getResourceReference(Textures_ID id) const;
+
+	/**
+	 * \brief Returns the area the resource takes inside the texture
+	 * \param id Identifier identifying a previously saved resource
+	 * \return Rectangle of the resource inside the texture returned by getResourceReference()
+	 */
+	sf::IntRect getResourceRect(Textures_ID id) const;
+
+	/**
+	 * \brief Creates a sprite that displays the resource with the given identifier
+	 * \param id Identifier identifying a previously saved resource
+	 * \return Sprite with the texture and its rectangle already set
+	 */
+	sf::Sprite sprite(Textures_ID id) const;
+
+private:
+	/** Atlas containing all the small, non-repeated textures */
+	TextureAtlas<Textures_ID> mAtlas;
+
+	/** Identifiers and paths of images waiting to be packed into the atlas */
+	std::vector<std::pair<Textures_ID, std::string>> mQueuedAtlasImages;
+};
 
 // ====== Fonts ======= //
 
@@ -34,6 +112,8 @@ using TextureManager = ResourceManager<sf::Texture, Textures_ID>;
 enum class Fonts_ID
 {
 	ArialNarrow,
+
+	Last,
 };
 
 /**
@@ -41,4 +121,62 @@ enum class Fonts_ID
  */
 using FontManager = ResourceManager<sf::Font, Fonts_ID>;
 
+
+// ---------- Inline ------------ //
+
+inline void TextureManager::queueResourceInAtlas(Textures_ID id, const std::string& path_to_file)
+{
+	mQueuedAtlasImages.emplace_back(id, path_to_file);
+}
+
+inline void TextureManager::loadQueuedResources()
+{
+	std::vector<std::future<sf::Image>> decodedImages;
+	for (const auto& [id, path] : mQueuedAtlasImages)
+	{
+		decodedImages.push_back(std::async(std::launch::async, [this, &path = path]()
+		{
+			sf::Image image;
+			if (!loadFromSource(image, path))
+				throw std::runtime_error("This file does not exist: " + path);
+			return image;
+		}));
+	}
+
+	ResourceManager::loadQueuedResources();
+
+	for (std::size_t index = 0; index < mQueuedAtlasImages.size(); ++index)
+		mAtlas.storeImage(mQueuedAtlasImages[index].first, decodedImages[index].get());
+	mQueuedAtlasImages.clear();
+
+	mAtlas.pack();
+}
+
+inline sf::Texture& TextureManager::getResourceReference(Textures_ID id)
+{
+	return const_cast<sf::Texture&>(static_cast<const TextureManager&>(*this).getResourceReference(id));
+}
+
+inline const sf::Texture& TextureManager::getResourceReference(Textures_ID id) const
+{
+	if (mAtlas.contains(id))
+		return mAtlas.texture();
+
+	return ResourceManager::getResourceReference(id);
+}
+
+inline sf::IntRect TextureManager::getResourceRect(Textures_ID id) const
+{
+	if (mAtlas.contains(id))
+		return mAtlas.textureRect(id);
+
+	const auto& textureSize = ResourceManager::getResourceReference(id).getSize();
+	return { 0, 0, static_cast<int>(textureSize.x), static_cast<int>(textureSize.y) };
+}
+
+inline sf::Sprite TextureManager::sprite(Textures_ID id) const
+{
+	return sf::Sprite(getResourceReference(id), getResourceRect(id));
+}
+
 #endif
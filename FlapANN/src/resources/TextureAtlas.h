@@ -0,0 +1,177 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <array>
+#include <map>
+#include <optional>
+#include <vector>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+/**
+ * \brief A single texture into which many smaller images are packed.
+ *
+ * Images are first collected with storeImage(), and then they are all
+ * packed at once with pack(). Each of the packed images is addressed by
+ * its identifier and is described by a rectangle inside the shared texture.
+ * Thanks to this, all objects using images from the atlas can be drawn
+ * one after another without rebinding the texture between them.
+ *
+ * Textures that rely on being repeated (setRepeated()) can not be put here,
+ * as the repetition always applies to the whole texture, not its fragment.
+ */
+template <typename Identifier>
+class TextureAtlas
+{
+public:
+	/**
+	 * \brief Prepares the image to be packed into the atlas
+	 * \param id Identifier to which the image is to be assigned
+	 * \param image Image to be packed
+	 */
+	void storeImage(Identifier id, sf::Image image);
+
+	/**
+	 * \brief Packs all stored images into one texture.
+	 *
+	 * Images are placed on shelves sorted by their height, which for a small amount
+	 * of similarly sized sprites gives almost no wasted space. Stored images are
+	 * released after packing, only the texture remains in the memory.
+	 */
+	void pack();
+
+	/**
+	 * \brief Checks whether the image with the given identifier is packed into the atlas
+	 * \param id Identifier of the image
+	 * \return True if the image is part of the atlas, false otherwise
+	 */
+	bool contains(Identifier id) const;
+
+	/**
+	 * \brief Returns the texture containing all the packed images
+	 * \return Texture of the atlas
+	 */
+	const sf::Texture& texture() const;
+
+	/**
+	 * \brief Returns the area occupied by the image inside the atlas texture
+	 * \param id Identifier of the image
+	 * \return Rectangle of the image inside the atlas texture
+	 */
+	sf::IntRect textureRect(Identifier id) const;
+
+private:
+	/**
+	 * Number of empty pixels left around each image, so that the
+	 * rotated or scaled sprites do not sample their neighbours.
+	 */
+	static constexpr unsigned PADDING = 2;
+
+	/** Images waiting to be packed into the atlas */
+	std::map<Identifier, sf::Image> mImages;
+
+	/** Area of each packed image inside the atlas texture indexed by its identifier */
+	std::array<std::optional<sf::IntRect>, static_cast<std::size_t>(Identifier::Last)> mTextureRects;
+
+	/** Texture holding all the packed images */
+	sf::Texture mTexture;
+};
+
+
+// ---------- Inline ------------ //
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+template <typename Identifier>
+void TextureAtlas<Identifier>::storeImage(Identifier id, sf::Image image)
+{
+	auto inserted_image = mImages.insert(std::make_pair(id, std::move(image)));
+	assert(inserted_image.second); // Tried to insert image multiple times
+}
+
+template <typename Identifier>
+void TextureAtlas<Identifier>::pack()
+{
+	if (mImages.empty())
+		return;
+
+	// The tallest images go first, so every shelf is filled
+	// with images of similar height and little space is wasted
+	std::vector<Identifier> packingOrder;
+	unsigned totalArea = 0;
+	unsigned widestImage = 0;
+	for (const auto& [id, image] : mImages)
+	{
+		packingOrder.push_back(id);
+		totalArea += (image.getSize().x + PADDING) * (image.getSize().y + PADDING);
+		widestImage = std::max(widestImage, image.getSize().x + PADDING);
+	}
+	std::sort(packingOrder.begin(), packingOrder.end(), [this](Identifier a, Identifier b)
+	{
+		return mImages.at(a).getSize().y > mImages.at(b).getSize().y;
+	});
+
+	// Square-ish atlas is the safest choice regarding maximum texture size
+	unsigned atlasWidth = 1;
+	while (atlasWidth * atlasWidth < totalArea || atlasWidth < widestImage)
+		atlasWidth *= 2;
+
+	unsigned shelfX = 0;
+	unsigned shelfY = 0;
+	unsigned shelfHeight = 0;
+	for (const auto& id : packingOrder)
+	{
+		const auto& imageSize = mImages.at(id).getSize();
+		if (shelfX + imageSize.x + PADDING > atlasWidth)
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+		mTextureRects[static_cast<std::size_t>(id)] = sf::IntRect(shelfX, shelfY, imageSize.x, imageSize.y);
+		shelfX += imageSize.x + PADDING;
+		shelfHeight = std::max(shelfHeight, imageSize.y + PADDING);
+	}
+
+	sf::Image atlasImage;
+	atlasImage.create(atlasWidth, shelfY + shelfHeight, sf::Color::Transparent);
+	for (const auto& [id, image] : mImages)
+	{
+		const auto& rect = textureRect(id);
+		atlasImage.copy(image, rect.left, rect.top);
+	}
+
+	if (!mTexture.loadFromImage(atlasImage))
+		throw std::runtime_error("Unable to create texture atlas of size: " +
+			std::to_string(atlasImage.getSize().x) + "x" + std::to_string(atlasImage.getSize().y));
+
+	mImages.clear();
+}
+
+template <typename Identifier>
+bool TextureAtlas<Identifier>::contains(Identifier id) const
+{
+	return mTextureRects[static_cast<std::size_t>(id)].has_value();
+}
+
+template <typename Identifier>
+const sf::Texture& TextureAtlas<Identifier>::texture() const
+{
+	return mTexture;
+}
+
+template <typename Identifier>
+sf::IntRect TextureAtlas<Identifier>::textureRect(Identifier id) const
+{
+	const auto& found_rect = mTextureRects[static_cast<std::size_t>(id)];
+	assert(found_rect); // Image with given ID is not packed into the atlas
+	return *found_rect;
+}
+
+
+#endif
@@ -1,3 +1,15 @@
+newoption
+{
+    trigger = "profiling",
+    description = "Measure the phases of every frame with the built-in profiler"
+}
+
+newoption
+{
+    trigger = "track-allocations",
+    description = "Count heap allocations of every profiled phase and check that ticks do not allocate"
+}
+
 workspace "FlapANN"
     architecture "x64"
 
@@ -16,6 +28,12 @@ workspace "FlapANN"
         defines "_RELEASE"
         runtime "Release"
         optimize "On"
+
+    filter "options:profiling"
+        defines "FLAPANN_PROFILING"
+
+    filter "options:track-allocations"
+        defines { "FLAPANN_PROFILING", "FLAPANN_ALLOCATION_TRACKING" }
         
     
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"